@@ -0,0 +1,83 @@
+/*** Breakpoints.hpp ****************************
+ *    ____                 _                _       _         _
+ *   |  _ \               | |              (_)     | |       | |
+ *   | |_) |_ __ ___  __ _| | ___ __   ___  _ _ __ | |_ ___  | |__  _ __  _ __
+ *   |  _ <| '__/ _ \/ _` | |/ / '_ \ / _ \| | '_ \| __/ __| | '_ \| '_ \| '_ \
+ *   | |_) | | |  __/ (_| |   <| |_) | (_) | | | | | |_\__ \_| | | | |_) | |_) |
+ *   |____/|_|  \___|\__,_|_|\_\ .__/ \___/|_|_| |_|\__|___(_)_| |_| .__/| .__/
+ *                             | |                                 | |   | |
+ *                             |_|                                 |_|   |_|
+ *
+ * Debugger breakpoint table. Every address has one bit in a 64k bitset,
+ * so the CPU thread pays a single bit test per instruction. Conditions,
+ * hit counts and ignore counts live in a side table that is only looked
+ * at when the bit for the current PC is set.
+ *
+ * Conditions are compiled once into a small stack bytecode. They compare
+ * registers (A B D X Y U S PC DP CC), numbers ($FF, 0xFF or 255) and
+ * memory ([addr] peeks a byte, {addr} a word) with == != < <= > >= and
+ * & (bitwise and), joined by && and || and grouped with ( ). Any other
+ * name is looked up in the debugger's symbol table as a constant.
+ *
+ *      X == $2000 && [$00F0] != 0
+ *      X == EDT_BUFFER && [FIO_ERROR] != FE_NOERROR
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+class Symbols;
+
+class Breakpoints
+{
+public:
+    struct BREAKPOINT {
+        std::string condition;              // source text ("": always break)
+        std::vector<Byte> code;             // compiled condition
+        Uint32 hits = 0;                    // times reached with the condition true
+        Uint32 ignore = 0;                  // hits still to pass over
+    };
+
+    // the per instruction check (any thread)
+    inline bool Test(Word address) const {
+        return (_bits[address >> 6].load(std::memory_order_relaxed) >> (address & 63)) & 1;
+    }
+
+    // Called when Test() passed for the PC about to run. Counts the hit and
+    // applies the condition and ignore count; true when the CPU should stop.
+    bool Hit(Word address);
+
+    void Set(Word address, bool enable);
+    void Toggle(Word address) { Set(address, !Test(address)); }
+    void Clear();
+    bool SetCondition(Word address, const std::string& condition, std::string& error);
+    void SetIgnore(Word address, Uint32 count);
+    std::vector<Word> Addresses();                  // sorted
+    bool Info(Word address, BREAKPOINT& info);      // false if there is no breakpoint
+    void SetSymbols(const Symbols* symbols) { _symbols = symbols; }
+
+    // condition compiler; Evaluate() reads the CPU registers and memory
+    static bool Compile(const std::string& source, std::vector<Byte>& code, std::string& error,
+                        const Symbols* symbols = nullptr);
+    static Word Evaluate(const std::vector<Byte>& code);
+
+private:
+    std::array<std::atomic<uint64_t>, 0x10000 / 64> _bits{};
+    std::map<Word, BREAKPOINT> _info;               // one entry per set bit
+    std::mutex _mutex;                              // guards _info
+    const Symbols* _symbols = nullptr;              // names usable in conditions
+};
+
+// END: Breakpoints.hpp
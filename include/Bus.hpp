@@ -40,6 +40,9 @@
 
 class C6809;
 class Debug;
+class GdbStub;
+class GPU_EXT;
+class SYS_EXT;
 
 class Bus
 {
@@ -73,6 +76,7 @@ public: // PUBLIC METHODS
     static void IsRunning(bool b);
     static bool IsDirty();
     static void IsDirty(bool b);
+    static bool IsCpuThread() { return std::this_thread::get_id() == s_cpuThread.get_id(); }
     // inline static float GetAvgCpuCycleTime() { return s_avg_cpu_cycle_time; }
     // inline static void SetAvgCpuCycleTime(float f) { s_avg_cpu_cycle_time = f; }
     
@@ -96,6 +100,8 @@ public: // PUBLIC METHODS
 
     static Debug* GetDebug() { return _pDebug; }
     static GPU* GetGPU() { return _pGPU; }
+    static GPU_EXT* GetGPU_EXT() { return _pGPU_EXT; }
+    static SYS_EXT* GetSYS_EXT() { return _pSYS_EXT; }
     static C6809* GetC6809() { return s_c6809; }
 
 private: // INTERNAL PRIVATES
@@ -114,7 +120,10 @@ private: // INTERNAL PRIVATES
     // quick and dirty reference to the Gfx object:
     inline static GPU*   _pGPU   = nullptr;   // singlular but not necessarily a singleton
     inline static Debug* _pDebug = nullptr;
+    inline static GPU_EXT* _pGPU_EXT = nullptr;
+    inline static SYS_EXT* _pSYS_EXT = nullptr;
     inline static C6809* s_c6809 = nullptr;
+    inline static GdbStub* s_gdb = nullptr;        // remote debugger (GDB_STUB)
 
     // static Memory Management Device:
     Memory& _memory = Memory::GetInstance();   
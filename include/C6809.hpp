@@ -25,6 +25,8 @@
 #include <string>
 #include <list>
 #include <unordered_map>
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstring>
 
@@ -90,7 +92,7 @@ public:
         return opMap[((opcode>>8)&0xFF)].size; 
     }
 
-	void clock_input(); // this one doesnt need to inherit from device
+	bool clock_input(); // false while the debugger holds the CPU
 
 	// pin states
 	void nmi(); // true to false transition triggers NMI
@@ -98,46 +100,20 @@ public:
 	void firq(); // true to false transition triggers FIRQ
 	void reset();
 
+	// Register snapshot for other threads. The CPU thread publishes it every
+	// STATE_SLICE clocks, and on every clock while the debugger holds it, under
+	// a sequence lock: readers retry rather than ever block the CPU.
+	struct CPU_STATE {
+		Word pc = 0, op_pc = 0;
+		Word x = 0, y = 0, u = 0, s = 0;
+		Byte a = 0, b = 0, dp = 0, cc = 0;
+		Word d() const { return (Word)((a << 8) | b); }
+	};
+	static constexpr int STATE_SLICE = 256;
+	void PublishState();						// CPU thread
+	CPU_STATE GetState() const;					// any thread
+
 	// getters
-	// inline Word getPC()      const { std::lock_guard<std::mutex> lock(_mutex_PC); return PC; }
-	// inline Word getU()       const { std::lock_guard<std::mutex> lock(_mutex_U); return U; }
-	// inline Word getS()       const { std::lock_guard<std::mutex> lock(_mutex_S); return S; }
-	// inline Word getX()       const { std::lock_guard<std::mutex> lock(_mutex_X); return X; }
-	// inline Word getY()       const { std::lock_guard<std::mutex> lock(_mutex_Y); return Y; }
-	// inline Byte getDP()      const { std::lock_guard<std::mutex> lock(_mutex_DP); return DP; }
-	// inline Byte getA()       const { std::lock_guard<std::mutex> lock(_mutex_D); return A; }
-	// inline Byte getB()       const { std::lock_guard<std::mutex> lock(_mutex_D); return B; }
-	// inline Word getD()       const { std::lock_guard<std::mutex> lock(_mutex_D); return D; }
-	// inline Byte getCC()      const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.all; }
-	// inline bool getCC_E()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.E != 0; }
-	// inline bool getCC_F()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.F != 0; }
-	// inline bool getCC_H()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.H != 0; }
-	// inline bool getCC_I()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.I != 0; }
-	// inline bool getCC_N()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.N != 0; }
-	// inline bool getCC_Z()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.Z != 0; }
-	// inline bool getCC_V()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.V != 0; }
-	// inline bool getCC_C()    const { std::lock_guard<std::mutex> lock(_mutex_CC); return CC.bit.C != 0; }
-	// inline Byte getCycles()  const { std::lock_guard<std::mutex> lock(_register_mutex); return cycles; }
-    // // setters
-	// inline void setPC(Word pPc)    { std::lock_guard<std::mutex> lock(_mutex_PC); PC = pPc; }
-	// inline void setU(Word pU)      { std::lock_guard<std::mutex> lock(_mutex_U); U = pU; }
-	// inline void setS(Word pS)      { std::lock_guard<std::mutex> lock(_mutex_S); S = pS; }
-	// inline void setX(Word pX)      { std::lock_guard<std::mutex> lock(_mutex_X); X = pX; }
-	// inline void setY(Word pY)      { std::lock_guard<std::mutex> lock(_mutex_Y); Y = pY; }
-	// inline void setD(Word pD)      { std::lock_guard<std::mutex> lock(_mutex_D); D = pD; }
-	// inline void setA(Byte pA)      { std::lock_guard<std::mutex> lock(_mutex_D); A = pA; }
-	// inline void setB(Byte pB)      { std::lock_guard<std::mutex> lock(_mutex_D); B = pB; }
-	// inline void setCC(Byte pCC)    { std::lock_guard<std::mutex> lock(_mutex_CC); CC.all = pCC; }
-	// inline void setCC_E(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.E = bSet; }
-	// inline void setCC_F(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.F = bSet; }
-	// inline void setCC_H(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.H = bSet; }
-	// inline void setCC_I(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.I = bSet; }
-	// inline void setCC_N(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.N = bSet; }
-	// inline void setCC_Z(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.Z = bSet; }
-	// inline void setCC_V(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.V = bSet; }
-	// inline void setCC_C(bool bSet) { std::lock_guard<std::mutex> lock(_mutex_CC); CC.bit.C = bSet; }
-	// inline void setDP(Byte pDP)    { std::lock_guard<std::mutex> lock(_mutex_DP); DP = pDP; }
-    
 	inline Word getPC()      const { return PC; }
 	inline Word getU()       const { return U; }
 	inline Word getS()       const { return S; }
@@ -157,6 +133,7 @@ public:
 	inline bool getCC_V()    const { return CC.bit.V != 0; }
 	inline bool getCC_C()    const { return CC.bit.C != 0; }
 	inline Byte getCycles()  const { return cycles; }
+	inline Word getOpPC()    const { return op_pc; }	// address of the instruction being run
     // setters
 	inline void setPC(Word pPc)    { PC = pPc; }
 	inline void setU(Word pU)      { U = pU; }
@@ -193,28 +170,24 @@ public:
 	Word read_word(Word offset)					{ return Memory::Read_Word(offset); }
 	void write_word(Word offset, Word data)		{ Memory::Write_Word(offset, data); }
 
-	Byte debug_read(Word offset)				{ return Memory::Read(offset, true);}
-	void debug_write(Word offset, Byte data)	{ Memory::Write(offset, data, true); }
-	Word debug_read_word(Word offset)			{ return Memory::Read_Word(offset, true); }
-	void debug_write_word(Word offset, Word data) { Memory::Write_Word(offset, data, true); }
+	// side-effect-free access (disassembly and other debugger views)
+	Byte debug_read(Word offset)				{ return Memory::Peek(offset); }
+	void debug_write(Word offset, Byte data)	{ Memory::Poke(offset, data); }
+	Word debug_read_word(Word offset)			{ return (Word)((Memory::Peek(offset) << 8) | Memory::Peek(offset + 1)); }
+	void debug_write_word(Word offset, Word data) { Memory::Poke(offset, (Byte)(data >> 8)); Memory::Poke(offset + 1, (Byte)data); }
 
 
 private:
-	// Registers
-    std::mutex _register_mutex;
-	std::mutex _mutex_U;
-	std::mutex _mutex_S;
-	std::mutex _mutex_X;
-	std::mutex _mutex_Y;
-	std::mutex _mutex_DP;
-	std::mutex _mutex_PC;
-	std::mutex _mutex_D;	// includes both A and B
-	std::mutex _mutex_CC;
+	// PublishState() output: an odd sequence means a write is in progress
+	std::atomic<Uint32> _state_seq = 0;
+	std::array<std::atomic<Word>, 8> _state{};
 
+	// Registers
 	Word U, S;
 	Word X, Y;
 	Byte DP;
 	Word PC;
+	Word op_pc = 0;		// PC at the opcode fetch of the current instruction
 	union {
 		Word D;
 		struct {
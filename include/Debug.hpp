@@ -15,15 +15,23 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <list>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <map>
 
 #include "types.hpp"
 #include "Memory.hpp"
 #include "IDevice.hpp"
+#include "Breakpoints.hpp"
+#include "C6809.hpp"
+#include "Symbols.hpp"
 #include "font8x8_system.hpp"
 
+
 class Debug : public IDevice {
 
 public: // PUBLIC CONSTRUCTOR / DESTRUCTOR
@@ -40,7 +48,7 @@ public: // VIRTUAL METHODS
     virtual void OnEvent(SDL_Event* evnt) override;     // handle events
     virtual void OnUpdate(float fElapsedTime) override; // update
     virtual void OnRender() override;                   // render
-    // virtual bool OnTest() override;                     // Unit Tests
+    virtual bool OnTest() override;                     // Unit Tests
 
 public: // PUBLIC ACCESSORS
 
@@ -84,6 +92,34 @@ public: // PUBLIC ACCESSORS
     inline bool IsCursorVisible() { return bIsCursorVisible; }
     inline void SetDebugActive(bool value) { s_bIsDebugActive = value; }
 
+    // watchpoints over address ranges (Memory::_WATCH flags)
+    struct WATCH_HIT {
+        Word pc;            // instruction that made the access
+        Word address;
+        Byte kind;          // WATCH_READ, WATCH_WRITE or WATCH_CHANGE
+        Byte old_data;
+        Byte data;
+        Uint32 count;       // hits recorded so far, this one included
+    };
+    void AddWatch(Word first, Word last, Byte flags);
+    void RemoveWatch(Word first, Word last, Byte flags);
+    void ClearWatches();
+    void WatchHit(Word address, Byte kind, Byte old_data, Byte data);  // from Memory
+    bool LastWatchHit(WATCH_HIT& hit);              // false before the first hit
+
+    // run at full speed until a step completes (or a breakpoint is hit)
+    void StepOver();                // over calls, otherwise a single step
+    void StepOut();                 // until the current subroutine returns
+    void RunTo(Word address);       // until the PC reaches address
+
+    // remote control (GdbStub)
+    void Break() { s_bSingleStep = true; }                              // halt after the current instruction
+    void Resume() { s_bSingleStep = false; s_bIsStepPaused = false; }
+    void Step() { s_bSingleStep = true; s_bIsStepPaused = false; }      // one instruction, then halt
+    bool IsStopped() { return s_bSingleStep && s_bIsStepPaused; }
+    Breakpoints& GetBreakpoints() { return _breakpoints; }
+    Symbols& GetSymbols() { return _symbols; }
+
 
     SDL_WindowID Get_Window_ID() { return SDL_GetWindowID( _dbg_window ); }
     SDL_Window* Get_SDL_Window() { return _dbg_window; }
@@ -103,7 +139,6 @@ public: // PUBLIC ACCESSORS
 private: // PRIVATE MEMBERS
 
     void _clear_texture(SDL_Texture* texture, Byte r, Byte g, Byte b, Byte a);
-    void _setPixel_unlocked(void* pixels, int pitch, int x, int y, Byte palette_index);
     void OutGlyph(int col, int row, Byte glyph, Byte color_attr);
     int OutText(int col, int row, std::string text, Byte color_attr);
     std::string _hex(Uint32 n, Uint8 d);
@@ -121,10 +156,15 @@ private: // PRIVATE MEMBERS
     void _display_previous_instructions(int col, int& row);
     void _display_single_instruction(int col, int& row, Word &nextAddress);
     void _display_next_instructions(int col, int& row, Word &nextAddress);
+    std::string _symbolize(const std::string& code, int width);
+    void _upload_debug_screen();
+    void _apply_window_request();
 
     void DrawButtons();
     void HandleButtons();
     void DrawBreakpoints();
+    void DrawFrameTimes(int col, int row);
+    void DrawWatchHit(int col, int row);
     bool EditRegister(float fElapsedTime);
 
 
@@ -162,6 +202,7 @@ private: // PRIVATE MEMBERS
     void cbExit();
     void cbStepIn();
     void cbStepOver();
+    void cbStepOut();
     void cbAddBrk();
 
     // debugger stuctures
@@ -251,7 +292,21 @@ private: // PRIVATE MEMBERS
 
     std::vector<int> sDisplayedAsm = std::vector<int>(34, -1);  // 0-33 are valid, otherwise invalid or not displayed
 
-    std::unordered_map<Word, bool> mapBreakpoints;	
+    Breakpoints _breakpoints;		// breakpoint bitset and conditions
+    Symbols _symbols;               // kernel labels and memory map names
+    std::atomic<bool> _watch_stop = false;  // a watchpoint hit during the current instruction
+    WATCH_HIT _watch_hit = {};
+    bool _watch_hit_valid = false;
+    std::mutex _watch_mutex;        // guards _watch_hit
+
+    // StepOver(), StepOut() and RunTo() targets, checked after each instruction
+    enum _RUN_MODE : Byte { RUN_NONE, RUN_TO, RUN_OVER, RUN_OUT };
+    std::atomic<Byte> _run_mode = RUN_NONE;
+    Word _run_from = 0;             // PC when the run started
+    Word _run_addr = 0;             // RUN_TO: the address to stop at
+    Word _run_stack = 0;            // RUN_OVER / RUN_OUT: S when the run started
+    void _run_until(Byte mode, Word address);
+    bool _run_reached(C6809* cpu);
     std::list<Word> asmHistory;		// track last several asm addresses
 
     int csr_x = 0;
@@ -287,7 +342,7 @@ private: // PRIVATE MEMBERS
     inline static bool s_bSingleStep = DEBUG_SINGLE_STEP;
     inline static bool s_bIsStepPaused = true;        
 
-    const bool* keybfr = SDL_GetKeyboardState(NULL);
+    const bool* keybfr = nullptr;                  // _input.keys
 
     struct D_GLYPH 
     { 
@@ -296,6 +351,42 @@ private: // PRIVATE MEMBERS
     };
     std::vector<D_GLYPH> _db_bfr{0};
 
+    // _update_debug_screen() state
+    std::vector<D_GLYPH> _db_shadow;                // _db_bfr as last drawn into _db_pixels
+    std::vector<Uint16> _db_pixels;                 // ARGB4444 copy of _dbg_texture
+    std::vector<std::pair<int, int>> _db_dirty;     // per text row: changed columns not yet uploaded
+    std::array<Byte, 256 * 8> _db_atlas{};          // glyph rows as last drawn
+    bool _db_redraw_all = true;                     // the next update redraws every cell
+
+    // UI thread (OnActivate() to OnDeactivate()). The main thread only
+    // queues events, samples the input and uploads the finished rows; the
+    // UI thread composes the screen from the CPU's register snapshot and
+    // makes no SDL calls.
+    struct INPUT_STATE {
+        float mouse_x = 0.0f, mouse_y = 0.0f;
+        Uint32 buttons = 0;
+        SDL_Keymod mod = 0;
+        int window_width = DEBUG_WINDOW_WIDTH;
+        int window_height = DEBUG_WINDOW_HEIGHT;
+        bool focus = false;                         // the mouse is over the debugger
+        std::array<bool, SDL_SCANCODE_COUNT> keys{};
+    };
+    void _ui_proc();
+    void _ui_compose(float fElapsedTime);
+    void _handle_event(const SDL_Event* evnt);
+
+    std::thread _ui_thread;
+    std::atomic<bool> _ui_running = false;
+    std::mutex _ui_mutex;                           // held while a frame is composed
+    std::mutex _input_mutex;                        // guards _input_next and _events
+    INPUT_STATE _input_next;                        // latest sample from OnUpdate()
+    INPUT_STATE _input;                             // the UI thread's copy for this frame
+    std::vector<SDL_Event> _events;                 // queued by OnEvent()
+    C6809::CPU_STATE _cpu;                          // registers shown this frame
+
+    enum _WINDOW_REQUEST : Byte { WINDOW_NONE, WINDOW_SHOW, WINDOW_HIDE };
+    std::atomic<Byte> _window_request = WINDOW_NONE;
+
 };
 
 // END: Debug.hpp
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*** FIO_EXT.hpp *******************************************
+ *    ______ _____ ____        ________   _________     _
+ *   |  ____|_   _/ __ \      |  ____\ \ / /__   __|   | |
+ *   | |__    | || |  | |     | |__   \ V /   | |      | |__  _ __  _ __
+ *   |  __|   | || |  | |     |  __|   > <    | |      | '_ \| '_ \| '_ \
+ *   | |     _| || |__| |     | |____ / . \   | |   _  | | | | |_) | |_) |
+ *   |_|    |_____\____/      |______/_/ \_\  |_|  (_) |_| |_| .__/| .__/
+ *                      ______                               | |   | |
+ *                     |______|                              |_|   |_|
+ *
+ * Extended File I/O Registers. The CPU address and length used by the
+ * FileIO block transfer commands (FC_READBLOCK and FC_WRITEBLOCK).
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include "IDevice.hpp"
+
+class FIO_EXT : public IDevice {
+
+public: // PUBLIC CONSTRUCTOR / DESTRUCTOR
+    FIO_EXT();
+    virtual ~FIO_EXT();
+
+public: // VIRTUAL METHODS
+
+    virtual int  OnAttach(int nextAddr) override;   // attach to the memory map
+
+    // not used
+    virtual void OnInit() override {};
+    virtual void OnQuit() override {};
+    virtual void OnActivate() override {};
+    virtual void OnDeactivate() override {};
+    virtual void OnEvent(SDL_Event* evnt) override { (void)evnt; }
+    virtual void OnUpdate(float fElapsedTime) override { (void)fElapsedTime; }
+    virtual void OnRender() override {};
+
+private: // PRIVATE MEMBERS
+
+    Word _blk_addr = 0;                             // FIO_BLK_ADDR
+    Word _blk_len = 0;                              // FIO_BLK_LEN
+};
+
+// END: FIO_EXT.hpp
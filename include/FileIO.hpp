@@ -33,6 +33,7 @@ public: // VIRTUAL METHODS
     virtual int  OnAttach(int nextAddr);            // attach to the memory map
     virtual void OnInit();                          // initialize
     virtual void OnQuit();                          // shutdown
+    virtual bool OnTest() override;                 // return true for successful unit tests
 
     // unused pure virtuals
     virtual void OnActivate() {};                   // activate
@@ -84,6 +85,9 @@ private: // PRIVATE MEMBERS
     void _cmd_seek_end();                       // * Seek End    
     void _cmd_set_seek_position();              // * Set Seek Position (from FIO_IOWORD)            
     void _cmd_get_seek_position();              // * Get Seek Position (into FIO_IOWORD)    
+    void _cmd_read_block();                     // Read Block (into FIO_BLK_ADDR)
+    void _cmd_write_block();                    // Write Block (from FIO_BLK_ADDR)
+    Word _blk_length(Word address);             // FIO_BLK_LEN clipped to the address space
 
     Byte _fread_hex_byte(std::ifstream& ifs);                           
     Word _fread_hex_word(std::ifstream& ifs);                           
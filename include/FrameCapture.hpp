@@ -0,0 +1,95 @@
+/*** FrameCapture.hpp ****************************
+ *    ______                         _____            _                    _
+ *   |  ____|                       / ____|          | |                  | |
+ *   | |__ _ __ __ _ _ __ ___   ___| |     __ _ _ __ | |_ _   _ _ __ ___  | |__  _ __  _ __
+ *   |  __| '__/ _` | '_ ` _ \ / _ \ |    / _` | '_ \| __| | | | '__/ _ \ | '_ \| '_ \| '_ \
+ *   | |  | | | (_| | | | | | |  __/ |___| (_| | |_) | |_| |_| | | |  __/_| | | | |_) | |_) |
+ *   |_|  |_|  \__,_|_| |_| |_|\___|\_____\__,_| .__/ \__|\__,_|_|  \___(_)_| |_| .__/| .__/
+ *                                             | |                              | |   | |
+ *                                             |_|                              |_|   |_|
+ *
+ * Streams composed frames to a YUV4MPEG2 (.y4m) or raw RGB24 file. The
+ * render thread only copies changed ARGB4444 frames into a bounded
+ * queue; color conversion and disk writes happen on a background writer
+ * thread. Unchanged frames are queued as repeat counts and written by
+ * re-using the last encoded frame, so they cost neither a copy nor a
+ * conversion.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+
+class FrameCapture
+{
+public:
+    enum FORMAT { FORMAT_Y4M = 0, FORMAT_RAW };
+
+    FrameCapture() = default;
+    ~FrameCapture() { Stop(); }
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    bool Start(const std::string& filename, FORMAT format, int width, int height, int fps);
+    void Stop();                                    // flushes the queue and closes the file
+    bool IsActive() const { return _active; }
+    int  Width() const { return _width; }
+    int  Height() const { return _height; }
+
+    // Queue an ARGB4444 frame (width x height, pitch bytes per row).
+    // Never blocks on disk; when the queue is full the frame is written
+    // as a repeat of the previous one. Returns false for a size mismatch.
+    bool Submit(const Uint16* frame, int width, int height, int pitch);
+    // Queue the previous frame again, for a frame that was not composed.
+    void Repeat();
+
+    int Written() const { return _written; }        // unique frames encoded
+    int Repeated() const { return _repeated; }      // frames written as repeats
+    int Dropped() const { return _dropped; }        // changed frames lost to a full queue
+
+private:
+    // a queued frame is shared by the queue, the writer and _last; it
+    // returns to _pool when the last of them lets go (under _mutex)
+    using FRAME = std::shared_ptr<std::vector<Uint16>>;
+    struct ENTRY {
+        FRAME pixels;                               // null: repeat only
+        int repeats = 0;                            // times to repeat after this entry
+    };
+
+    void _writer_proc();
+    void _encode(const std::vector<Uint16>& pixels);
+    void _release(FRAME& frame);
+
+    FORMAT _format = FORMAT_Y4M;
+    int _width = 0;
+    int _height = 0;
+    FILE* _file = nullptr;
+
+    std::atomic<bool> _active = false;
+    bool _quit = false;
+    std::thread _writer;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<ENTRY> _queue;
+    std::vector<FRAME> _pool;                       // recycled frame buffers
+    FRAME _last;                                    // the last queued frame (unchanged frames compare against it)
+    std::vector<Byte> _encoded;                     // writer side copy of the last encoded frame
+
+    std::atomic<int> _written = 0;
+    std::atomic<int> _repeated = 0;
+    std::atomic<int> _dropped = 0;
+};
@@ -18,12 +18,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <SDL3/SDL.h>
 #include "IDevice.hpp"
+#include "FrameCapture.hpp"
 #include "font8x8_system.hpp"
 
 class GPU : public IDevice {
 
+    friend class GPU_EXT;   // the extended graphics engines work directly
+                            // on the extended video buffer and palette
+
 public: // PUBLIC CONSTRUCTOR / DESTRUCTOR
     GPU();
     virtual ~GPU();
@@ -37,10 +42,11 @@ public: // VIRTUAL METHODS
     virtual void OnEvent(SDL_Event* evnt);          // handle events
     virtual void OnUpdate(float fElapsedTime);      // update
     virtual void OnRender();                        // render
+    virtual bool OnTest();                          // return true for successful unit tests
 
 public: // PUBLIC ACCESSORS
     void RenderPresent() {
-        SDL_RenderPresent(pRenderer);
+        if (pRenderer) { SDL_RenderPresent(pRenderer); }
     }
     SDL_Window* GetWindow() { return pWindow; }         // get the SDL window
     SDL_Renderer* GetRenderer() { return pRenderer; }   // get the SDL renderer
@@ -48,10 +54,28 @@ public: // PUBLIC ACCESSORS
     inline SDL_Window* GetSDLWindow() { return pWindow; }   
 
 
-    SDL_Texture* GetTexture() { return pForeground_Texture; }  // fetch an SDL texture to render foreground
+    SDL_Texture* GetTexture() { return pComposite_Texture; }   // fetch the composed display texture
 
     static Byte GetGlyphData(Byte index, Byte row) { return _gpu_glyph_data[index][row]; }
 
+    // software compositor: blends the extended, standard and foreground
+    // layers into an ARGB8888 frame (_ext_width x _ext_height)
+    void ComposeFrame(std::vector<Uint32>& frame);
+    static Uint16 BlendPixel(Uint16 dst, Uint16 src);      // ARGB4444 src over dst (opaque result)
+    void RequestFrameDump() { _dump_requested = true; }     // dump the next headless frame
+
+    static bool WritePPM(const std::string& filename, const std::vector<Uint32>& frame, int width, int height);
+    static bool ReadPPM(const std::string& filename, std::vector<Uint32>& frame, int& width, int& height);
+    // number of pixels with any channel further apart than tolerance (-1: size mismatch)
+    static int  CompareFrames(const std::vector<Uint32>& a, const std::vector<Uint32>& b, int tolerance);
+
+    // stream composed frames to GPU_CAPTURE_PATH on a writer thread
+    bool StartCapture(FrameCapture::FORMAT format);
+    void StopCapture();
+    bool IsCapturing() { return _capture.IsActive(); }
+    void CaptureSkippedFrame() { _capture.Repeat(); }     // hold the stream's frame rate
+
+    bool IsVsync() { return _gpu_mode & 0x0200; }      // GPU_MODE VSync Enable
     float Get_Width() { return _gpu_hres; }
     float Get_Height() { return _gpu_vres; }
 
@@ -176,14 +200,25 @@ private: // PRIVATE MEMBERS
 
     void _render_extended_graphics();
     void _render_standard_graphics();
-    void _update_text_buffer();
-    void _update_tile_buffer();
+    void _render_ext_line(Uint16* dst, int y);
+    void _render_std_line(Uint16* dst, int y);
+    void _render_std_row(Uint16* dst, int y);
+    void _update_scanline_buffers();
+    void _update_sprite_buffer();
     void _display_mode_helper(Byte mode, int &width, int &height);
     // Byte _verify_gpu_mode_change(Byte data, Word map_register);
     void _verify_gpu_mode_change(Word mode_data);
-    void _setPixel_unlocked(void* pixels, int pitch, int x, int y, Byte color_index, bool bIgnoreAlpha);
     void _build_palette();
-    void _clear_texture(SDL_Texture* texture, Byte alpha, Byte red, Byte grn, Byte blu);
+    void _clear_layer(int layer, Byte alpha, Byte red, Byte grn, Byte blu);
+
+    // display layers: host buffers composed into a single texture
+    enum _LAYER { LAYER_EXT = 0, LAYER_STD, LAYER_FG, LAYER_COUNT };
+    void* _layer_pixels(int layer, int* pitch);
+    void _compose_layers();
+    void _compose_span(Uint16* dst, const Uint16* src, int count);
+    void _expand_composite(std::vector<Uint32>& frame);
+    void _headless_frame();
+    void _capture_frame();
 
     // internal hardware register states:
 
@@ -193,6 +228,12 @@ private: // PRIVATE MEMBERS
     float _ext_height = 0.0f;           // ToDo: remove this (redundant)
     float _std_width = 0.0f;            // ToDo: remove this (redundant)
     float _std_height = 0.0f;           // ToDo: remove this (redundant)
+    Word _std_scroll_x = 0;             // GPU_STD_SCROLL_X (in pixels)
+    Word _std_scroll_y = 0;             // GPU_STD_SCROLL_Y (in pixels)
+    Word _ext_scroll_x = 0;             // GPU_EXT_SCROLL_X (in pixels)
+    Word _ext_scroll_y = 0;             // GPU_EXT_SCROLL_Y (in pixels)
+    Word _video_start = 0x0400;         // cached MAP(VIDEO_START)
+    Word _video_end = 0x23FF;           // cached MAP(VIDEO_END)
 
 
 	// SDL stuff
@@ -200,14 +241,30 @@ private: // PRIVATE MEMBERS
     int initial_height = 400*2.125;
 	SDL_Window* pWindow = nullptr;
 	SDL_Renderer* pRenderer = nullptr;
-    SDL_Texture* pExt_Texture = nullptr;
-    SDL_Texture* pStd_Texture = nullptr;
-    SDL_Texture* pForeground_Texture = nullptr;
+    SDL_Texture* pComposite_Texture = nullptr;
 	Uint32 window_flags = SDL_WINDOW_RESIZABLE;
     Uint32 renderer_flags = SDL_RENDERER_VSYNC_DISABLED;
 
+    // Software Compositor
+    std::vector<Uint16> _soft_layer[LAYER_COUNT];   // ARGB4444 layers, (_screen_width/2) pixels per row
+    std::vector<Uint16> _composite;                 // the composed layers, same layout
+
+    // Headless Backend
+    std::vector<Uint32> _frame;                     // last composed frame
+    int _frame_count = 0;
+    bool _dump_requested = false;
+
+    // Frame Capture
+    FrameCapture _capture;
+    bool _capture_started = false;      // GPU_CAPTURE has been started
+
     // Extended Video Buffer (Sprites and Tiles Too?)
-    std::vector<Byte> _ext_video_buffer;    // 64k extended video buffer
+    static constexpr int EXT_PAGES = 4;     // 64k extended video pages
+    std::vector<Byte> _ext_video_buffer;    // EXT_PAGES x 64k extended video buffer
+    int _ext_draw = 0;                      // page accessed by the data port and blitter
+    std::atomic<int> _ext_display = 0;      // page read by the renderers
+    Byte* _ext_draw_page() { return &_ext_video_buffer[_ext_draw << 16]; }
+    const Byte* _ext_display_page() { return &_ext_video_buffer[_ext_display << 16]; }
 };
 
 /*** NOTES: ****************************************
@@ -238,6 +295,12 @@ GPU_ARG_3           (Word)      // Argument 3
 GPU_ARG_4           (Word)      // Argument 4
 GPU_ARG_5           (Word)      // Argument 5
 
+// Blitter Command Processor:
+//      (implemented by GPU_EXT as GPU_BLT_SRC/DST, GPU_BLT_WIDTH/HEIGHT,
+//       GPU_BLT_SPITCH/DPITCH, GPU_BLT_COLOR, GPU_BLT_KEY, GPU_BLT_ROP,
+//       GPU_BLT_FLAGS, GPU_COMMAND and GPU_ERROR with the CLEAR, COPY,
+//       BLIT, SCROLL, DRAW_LINE and FILL_RECT commands)
+
 GPU_COMMAND         (Byte)      // Graphics Processing Unit Command
 GPU_CMD_CLEAR                   // Clear Video Buffer:
                                 // GPU_ARG_1_MSB = Color Index
@@ -285,24 +348,10 @@ GPU_ERROR           (Byte)      // (Byte) Graphics Processing Unit Error
 
 
 // Sprite Registers:
-GPU_SPR_MAX         (Byte)      // Maximum Sprite Index (Read Only)
-GPU_SPR_IDX         (Byte)      // Sprite Index
-GPU_SPR_XPOS        (SInt16)    // Sprite X Position
-GPU_SPR_YPOS        (SInt16)    // Sprite Y Position
-GPU_SPR_IMG_IDX     (Byte)      // Sprite Image Index
-GPU_SPR_MASK        (Byte)      // Sprite Collision Mask (4x4)
-GPU_SPR_FLAGS       (Byte)      // Sprite Flags:
-                                // % 0000'0011: 
-                                //      00 = 2 colors, 
-                                //      01 = 4 colors, 
-                                //      10 = 16 colors, 
-                                //      11 = 256 colors
-                                // % 0000'0100: Double Width
-                                // % 0000'1000: Double Height
-                                // % 0001'0000: Flip Horizontal
-                                // % 0010'0000: Flip Vertical
-                                // % 0100'0000: Collision Enable
-                                // % 1000'0000: Display Enable
+//      (implemented by GPU_EXT as GPU_SPR_MAX, GPU_SPR_IDX,
+//       GPU_SPR_XPOS/YPOS, GPU_SPR_ADDR, GPU_SPR_PAL,
+//       GPU_SPR_PRIORITY, GPU_SPR_FLAGS, GPU_SPR_HITS and
+//       GPU_COLL_MAP)
 
 // Image Editing Registers:              
 GPU_BMP_MAX         (Byte)      // Maximum Bitmap Index (Read Only)
@@ -318,16 +367,12 @@ GPU_BMP_FLAGS       (Byte)      // Bitmap Flags:
                                 // % 1111'1100: Reserved
 
 // Tilemap Registers:
-GPU_TMAP_WIDTH      (Word)      // Tilemap Width (in pixels)
-GPU_TMAP_HEIGHT     (Word)      // Tilemap Height (in Pixels)
-GPU_TMAP_XPOS       (SInt16)    // Tilemap X Position (top left corner)
-GPU_TMAP_YPOS       (SInt16)    // Tilemap Y Position (top left corner)
-GPU_TMAP_CLIP_X1    (Word)      // Tilemap Clip Region X1
-GPU_TMAP_CLIP_Y1    (Word)      // Tilemap Clip Region Y1
-GPU_TMAP_CLIP_X2    (Word)      // Tilemap Clip Region X2
-GPU_TMAP_CLIP_Y2    (Word)      // Tilemap Clip Region Y2
+//      (implemented by GPU_EXT as GPU_TMAP_LAYER, GPU_TMAP_FLAGS,
+//       GPU_TMAP_WIDTH/HEIGHT, GPU_TMAP_XPOS/YPOS, GPU_TMAP_ADDR
+//       and GPU_TILE_ADDR)
 
 // GPU Dynamic Memory Registers:
+//      (implemented by GPU_EXT)
 GPU_DYN_ADDR        (Word)      // Dynamic Memory ADDRESS
                                 // (autoincrements on read/write)
 GPU_DYN_DATA        (Byte)      // Dynamic Memory DATA (Read/Write)
@@ -0,0 +1,342 @@
+/*** GPU_EXT.hpp *******************************************
+ *     _____ _____  _    _     ________   _________     _
+ *    / ____|  __ \| |  | |   |  ____\ \ / /__   __|   | |
+ *   | |  __| |__) | |  | |   | |__   \ V /   | |      | |__  _ __  _ __
+ *   | | |_ |  ___/| |  | |   |  __|   > <    | |      | '_ \| '_ \| '_ \
+ *   | |__| | |    | |__| |   | |____ / . \   | |   _  | | | | |_) | |_) |
+ *    \_____|_|     \____/    |______/_/ \_\  |_|  (_) |_| |_| .__/| .__/
+ *                        ______                             | |   | |
+ *                       |______|                            |_|   |_|
+ *
+ * Extended Graphics Registers. This device exposes the hardware engines
+ * that work on the GPU's 64k extended video buffer: the tilemap layers,
+ * the hardware sprites, the dynamic memory port used to upload tiles,
+ * maps and sprite images, the blitter command processor and the raster
+ * beam that drives the scanline renderer and the vertical blank
+ * interrupt.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <mutex>
+#include "IDevice.hpp"
+
+class GPU;
+
+class GPU_EXT : public IDevice {
+
+public: // PUBLIC CONSTRUCTOR / DESTRUCTOR
+    GPU_EXT();
+    virtual ~GPU_EXT();
+
+public: // VIRTUAL METHODS
+
+    virtual int  OnAttach(int nextAddr) override;   // attach to the memory map
+    virtual void OnInit() override;                 // initialize
+    virtual bool OnTest() override;                 // return true for successful unit tests
+
+    // not used
+    virtual void OnQuit() override {};
+    virtual void OnActivate() override;
+    virtual void OnDeactivate() override {};
+    virtual void OnEvent(SDL_Event* evnt) override { (void)evnt; }
+    virtual void OnUpdate(float fElapsedTime) override { (void)fElapsedTime; }
+    virtual void OnRender() override {};
+
+public: // PUBLIC ACCESSORS
+
+    // render the enabled tilemap layers into a locked ARGB4444 texture
+    // (the caller holds ComposeMutex())
+    void RenderTilemap(void* pixels, int pitch, int width, int height);
+
+    // render a single row of the enabled tilemap layers
+    // (the caller holds ComposeMutex())
+    void RenderTilemapLine(Uint16* dst, int width, int y);
+
+    // decode the enabled sprites and update the sprite collision
+    // registers (every frame, composed or skipped)
+    void UpdateSprites();
+
+    // render the sprites decoded by UpdateSprites() into a locked
+    // ARGB4444 texture
+    void RenderSprites(void* pixels, int pitch, int width, int height);
+
+    // advance the raster beam by one CPU clock cycle (CPU thread only)
+    void RasterClock(int cpu_hz);
+
+    // rotate the palette cycling ranges queued by the raster
+    // (the caller holds ComposeMutex())
+    void ApplyPaletteCycles();
+
+    // held by the thread composing the display: the main thread for a
+    // whole frame, the CPU thread for each scanline renderer row
+    std::mutex& ComposeMutex() { return _compose_mutex; }
+
+    // true while the scanline renderer composes the display
+    bool ScanlineMode() { return _raster_ctrl & RASTER_SCANLINE; }
+
+    // copy the last frame completed by the scanline renderer
+    // into the locked standard and extended ARGB4444 textures
+    void CopyScanlines(void* std_pixels, int std_pitch, void* ext_pixels, int ext_pitch);
+
+    static constexpr int TMAP_LAYERS = 2;       // number of hardware tilemap layers
+    static constexpr int TMAP_TILES = 256;      // tiles per tile set
+    static constexpr int SPR_COUNT = 64;        // number of hardware sprites
+    static constexpr int SPR_SIZE = 16;         // sprites are 16x16 pixels
+    static constexpr int RASTER_LINES = 525;    // lines per frame (640x400 @ 70hz timing)
+    static constexpr int RASTER_ACTIVE = 400;   // visible lines per frame
+    static constexpr int RASTER_HZ = 70;        // frames per second
+    static constexpr int SCAN_WIDTH = 320;      // largest display row (in pixels)
+    static constexpr int SCAN_HEIGHT = 200;     // largest display height (in rows)
+
+    enum _TMAP_FLAGS : Byte {
+        TMAP_ENABLE         = 0x80,  // - bit 7: Layer Display Enable
+        TMAP_TILE_16        = 0x40,  // - bit 6: 0: 8x8 tiles, 1: 16x16 tiles
+        TMAP_DEPTH          = 0x03,  // - bits 0-1: Tile Color Depth (2, 4, 16, 256 colors)
+    };
+
+    enum _SPR_FLAGS : Byte {
+        SPR_ENABLE          = 0x80,  // - bit 7: Sprite Display Enable
+        SPR_COLLIDE         = 0x40,  // - bit 6: Collision Detection Enable
+        SPR_FLIP_V          = 0x20,  // - bit 5: Flip Vertical
+        SPR_FLIP_H          = 0x10,  // - bit 4: Flip Horizontal
+        SPR_DEPTH           = 0x03,  // - bits 0-1: Sprite Color Depth (2, 4, 16, 256 colors)
+    };
+
+    enum _DYN_CTRL : Byte {
+        DYN_STEP            = 0x03,  // - bits 0-1: Address Step
+        DYN_STEP_1          = 0x00,  //      advance 1 byte (one word on GPU_DYN_DATA16)
+        DYN_STEP_2          = 0x01,  //      advance 2 bytes
+        DYN_STEP_PITCH      = 0x02,  //      advance GPU_DYN_PITCH bytes
+        DYN_STEP_NONE       = 0x03,  //      fixed address
+    };
+
+    enum _BLT_FLAGS : Byte {
+        BLT_BUSY            = 0x80,  // - bit 7: Command in Progress (Read Only)
+        BLT_IRQ             = 0x40,  // - bit 6: Raise IRQ on Command Completion
+        BLT_KEY             = 0x20,  // - bit 5: Color Key Enable (BLIT)
+        BLT_DST_CPU         = 0x10,  // - bit 4: Destination is CPU memory (video buffer)
+        BLT_SRC_CPU         = 0x08,  // - bit 3: Source is CPU memory (video buffer)
+        BLT_DONE            = 0x04,  // - bit 2: Completion IRQ Pending (write 1 to acknowledge)
+        BLT_DEPTH           = 0x03,  // - bits 0-1: Line Color Depth (2, 4, 16, 256 colors)
+    };
+
+    enum _RASTER_CTRL : Byte {
+        RASTER_SCANLINE     = 0x80,  // - bit 7: Scanline Renderer Enable
+        RASTER_IRQ          = 0x40,  // - bit 6: Raise IRQ on Compare Match
+        RASTER_MATCH        = 0x01,  // - bit 0: Compare Matched (write 1 to acknowledge)
+    };
+
+    enum _VBL_CTRL : Byte {
+        VBL_ENABLE          = 0x80,  // - bit 7: Vertical Blank Interrupt Enable
+        VBL_FIRQ            = 0x40,  // - bit 6: 0: raise IRQ, 1: raise FIRQ
+        VBL_VSYNC           = 0x02,  // - bit 1: Raster is in Vertical Blank (Read Only)
+        VBL_PENDING         = 0x01,  // - bit 0: Vertical Blank Occurred (write 1 to acknowledge)
+    };
+
+    static constexpr int CYCLE_RANGES = 8;      // palette cycling ranges
+
+    enum _CYCLE_FLAGS : Byte {
+        CYCLE_ENABLE        = 0x80,  // - bit 7: Range Cycling Enable
+        CYCLE_REVERSE       = 0x01,  // - bit 0: 0: colors move up, 1: colors move down
+    };
+
+    enum _PAGE : Byte {
+        PAGE_PENDING        = 0x80,  // - bit 7: Display Page Flip Pending (Read Only)
+        PAGE_MASK           = 0x03,  // - bits 0-1: Extended Video Page (0-3)
+    };
+
+    enum _BLT_ROP : Byte {
+        ROP_COPY = 0,                // dst = src
+        ROP_AND,                     // dst = dst & src
+        ROP_OR,                      // dst = dst | src
+        ROP_XOR,                     // dst = dst ^ src
+        ROP_NOT,                     // dst = ~src
+        ROP_LAST
+    };
+
+private: // PRIVATE UNIT TESTS
+    bool _test_tilemap();
+    bool _test_dyn_port();
+    bool _test_sprites();
+    bool _test_blitter();
+    bool _test_raster();
+    bool _test_vblank();
+    bool _test_pages();
+    bool _test_cycle();
+
+private: // PRIVATE MEMBERS
+
+    struct TILE_LAYER {
+        Byte flags = 0;             // GPU_TMAP_FLAGS
+        Byte width = 64;            // GPU_TMAP_WIDTH  (in tiles)
+        Byte height = 32;           // GPU_TMAP_HEIGHT (in tiles)
+        Word xpos = 0;              // GPU_TMAP_XPOS   (horizontal scroll in pixels)
+        Word ypos = 0;              // GPU_TMAP_YPOS   (vertical scroll in pixels)
+        Word map_addr = 0x0000;     // GPU_TMAP_ADDR   (tile index map in extended memory)
+        Word tile_addr = 0x0000;    // GPU_TILE_ADDR   (tile graphics in extended memory)
+
+        // decoded tile cache: one color index per pixel. Used by the
+        // thread composing the display, under _compose_mutex: the main
+        // thread for whole frames, the CPU thread in scanline mode.
+        std::vector<Byte> cache;
+        std::bitset<TMAP_TILES> valid;
+        Uint32 valid_gen = 0;       // _tile_gen the valid bits were last cleared for
+    };
+
+    int  _tile_size(const TILE_LAYER& layer)   { return (layer.flags & TMAP_TILE_16) ? 16 : 8; }
+    int  _tile_bpp(const TILE_LAYER& layer)    { return 1 << (layer.flags & TMAP_DEPTH); }
+    int  _tile_bytes(const TILE_LAYER& layer)  { int ts = _tile_size(layer); return (ts * ts * _tile_bpp(layer)) / 8; }
+    // any thread: the renderer drops the layer's cache before its next use
+    void _invalidate_tiles(TILE_LAYER& layer)  { _tile_gen[&layer - _layers].fetch_add(1, std::memory_order_release); }
+    const Byte* _fetch_tile(TILE_LAYER& layer, Byte tile);
+    void _tile_lut(Word* lut);
+    void _render_tile_line(Uint16* dst, int width, int y, const Word* lut);
+
+    struct SPRITE {
+        Sint16 xpos = 0;            // GPU_SPR_XPOS     (signed screen position)
+        Sint16 ypos = 0;            // GPU_SPR_YPOS     (signed screen position)
+        Word img_addr = 0x0000;     // GPU_SPR_ADDR     (16x16 image in extended memory)
+        Byte pal = 0;               // GPU_SPR_PAL      (palette offset)
+        Byte priority = 0;          // GPU_SPR_PRIORITY (higher draws on top)
+        Byte flags = 0;             // GPU_SPR_FLAGS
+    };
+
+    // decoded sprite image (color index per pixel, flips applied) and
+    // its collision mask (one bit per opaque pixel, msb = leftmost)
+    struct SPRITE_IMAGE {
+        Byte pixel[SPR_SIZE * SPR_SIZE];
+        Word mask[SPR_SIZE];
+    };
+
+    void _decode_sprite(const SPRITE& spr, SPRITE_IMAGE& img);
+    void _update_collisions();
+    bool _sprite_hit(int a, int b);
+    Byte _read_u64(const uint64_t& value, Word offset)  { return (value >> ((7 - offset) * 8)) & 0xFF; }
+
+    GPU* _gpu = nullptr;
+
+    // GPU_TMAP_LAYER
+    Byte _tmap_layer = 0;               // (Byte) currently selected tilemap layer
+    TILE_LAYER _layers[TMAP_LAYERS];    // per-layer tilemap state
+    std::array<std::atomic<Uint32>, TMAP_LAYERS> _tile_gen{};  // bumped by _invalidate_tiles()
+
+    // GPU_DYN_ADDR
+    Word _dyn_addr = 0;                 // (Word) extended memory address (auto-increments)
+    Byte _dyn_latch = 0;                // GPU_DYN_DATA16 most significant byte
+    Byte _dyn_ctrl = DYN_STEP_1;        // (Byte) GPU_DYN_CTRL
+    Word _dyn_pitch = 0;                // (Word) GPU_DYN_PITCH
+    static constexpr uint32_t DYN_CLEAN = 0x0000FFFF;
+    std::atomic<uint32_t> _dyn_dirty = DYN_CLEAN;      // dirty span written by the ports (hi << 16 | lo)
+    void _dyn_write(Word address, Byte data);
+    void _dyn_flush();
+    Word _dyn_step(int size);
+
+    // GPU_SPR_IDX
+    Byte _spr_idx = 0;                                  // (Byte) currently selected sprite
+    std::array<SPRITE, SPR_COUNT> _sprites;             // per-sprite attributes
+    std::array<SPRITE_IMAGE, SPR_COUNT> _spr_image;     // decoded once per frame
+    std::array<uint64_t, SPR_COUNT> _spr_hits{};        // GPU_SPR_HITS per sprite
+    uint64_t _coll_map = 0;                             // GPU_COLL_MAP
+
+    // GPU_BLT_* argument registers
+    struct BLITTER {
+        Word src = 0;               // GPU_BLT_SRC    (source address)
+        Word dst = 0;               // GPU_BLT_DST    (destination address)
+        Word width = 0;             // GPU_BLT_WIDTH  (in bytes)
+        Word height = 0;            // GPU_BLT_HEIGHT (in rows)
+        Word spitch = 0;            // GPU_BLT_SPITCH (source bytes per row)
+        Word dpitch = 0;            // GPU_BLT_DPITCH (destination bytes per row)
+        Byte color = 0;             // GPU_BLT_COLOR  (fill color)
+        Byte key = 0;               // GPU_BLT_KEY    (transparent source byte)
+        Byte rop = ROP_COPY;        // GPU_BLT_ROP    (raster operation)
+        Byte flags = 0;             // GPU_BLT_FLAGS
+    } _blt;
+    Byte _gpu_command = 0;          // GPU_COMMAND
+    Byte _gpu_error = 0;            // GPU_ERROR
+
+    Word _video_start = 0;          // cached MAP(VIDEO_START)
+    Word _video_end = 0;            // cached MAP(VIDEO_END)
+    std::vector<Byte> _blt_temp;    // staging buffer for overlapping copies
+
+    struct CommandInfo {
+        std::string key;
+        std::string description;
+        std::function<bool()> action;   // sets GPU_ERROR and returns false on failure
+    };
+    std::vector<CommandInfo> _gpu_command_list = {
+        {"GPU_CMD_NOP"      , "No Operation",                           [this]() -> bool { return true; }},
+        {"GPU_CMD_CLEAR"    , "Clear the Destination Buffer",           [this]() -> bool { return _do_clear(); }},
+        {"GPU_CMD_COPY"     , "Linear Copy (WIDTH bytes)",              [this]() -> bool { return _do_copy(); }},
+        {"GPU_CMD_BLIT"     , "Rectangle Copy (ROP, Color Key)",        [this]() -> bool { return _do_blit(); }},
+        {"GPU_CMD_SCROLL"   , "Scroll Destination Rectangle",           [this]() -> bool { return _do_scroll(); }},
+        {"GPU_CMD_DRAW_LINE", "Draw a Line",                            [this]() -> bool { return _do_draw_line(); }},
+        {"GPU_CMD_FILL_RECT", "Fill Destination Rectangle (ROP)",       [this]() -> bool { return _do_fill_rect(); }},
+        {"GPU_CMD_TEXT_SCROLL", "Scroll a Text Region (in cells)",      [this]() -> bool { return _do_text_scroll(); }},
+        {"GPU_CMD_SIZE"     , "Total Number of GPU Commands",           [this]() -> bool { return true; }}
+    };
+    std::vector<std::pair<std::string, std::string>> _gpu_error_list = {
+        { "GPU_ERR_NONE",       "No Error" },
+        { "GPU_ERR_COMMAND",    "Invalid Command" },
+        { "GPU_ERR_ADDRESS",    "Invalid Address (out of range)" },
+        { "GPU_ERR_ARGUMENT",   "Invalid Argument" },
+        { "GPU_ERR_SIZE",       "Total Number of GPU Errors" }
+    };
+
+    void _do_command(Byte command);
+    bool _do_clear();
+    bool _do_copy();
+    bool _do_blit();
+    bool _do_scroll();
+    bool _do_draw_line();
+    bool _do_fill_rect();
+    bool _do_text_scroll();
+
+    bool _blt_in_range(bool cpu, Word addr, int width, int height, int pitch);
+    Byte _blt_read(bool cpu, Word addr);
+    void _blt_write(bool cpu, Word addr, Byte data);
+    Byte _blt_rop(Byte src, Byte dst);
+    void _blt_done(bool dst_cpu);
+
+    // GPU_RASTER_* registers
+    Word _raster_line = 0;          // GPU_RASTER_LINE (current scanline, 0-524)
+    Word _raster_cmp = 0;           // GPU_RASTER_CMP  (line that raises the compare IRQ)
+    Byte _raster_ctrl = 0;          // GPU_RASTER_CTRL
+    int  _raster_acc = 0;           // cycle accumulator (in lines * cpu_hz)
+    Byte _vbl_ctrl = 0;             // GPU_VBL_CTRL
+    Word _vbl_frame = 0;            // GPU_VBL_FRAME (frames since power on)
+    Byte _page_request = 0;         // GPU_PAGE_DISPLAY (shown from the next vertical blank)
+    bool _page_flip = false;        // _page_request is waiting for the vertical blank
+
+    // GPU_CYCLE_* registers
+    struct PAL_CYCLE {
+        Byte start = 0;             // GPU_CYCLE_START (first palette entry)
+        Byte end = 0;               // GPU_CYCLE_END   (last palette entry)
+        Byte rate = 1;              // GPU_CYCLE_RATE  (vertical blanks per step)
+        Byte flags = 0;             // GPU_CYCLE_FLAGS
+        Byte count = 0;             // vertical blanks since the last step
+    };
+    Byte _cycle_idx = 0;            // GPU_CYCLE_IDX
+    PAL_CYCLE _cycles[CYCLE_RANGES];
+    std::array<std::atomic<int>, CYCLE_RANGES> _cycle_steps{};     // queued steps (+up, -down)
+    void _cycle_palette();
+    void _raster_next_line();
+    void _hold_interrupts();        // re-assert pending interrupt lines
+
+    // scanline renderer frames: [0] is being drawn, [1] is complete
+    int _scan_row = -1;             // last display row drawn this frame
+    std::vector<Uint16> _scan_std[2];
+    std::vector<Uint16> _scan_ext[2];
+    std::mutex _scan_mutex;         // guards the swap against CopyScanlines()
+    std::mutex _compose_mutex;      // see ComposeMutex()
+};
+
+// END: GPU_EXT.hpp
@@ -0,0 +1,78 @@
+/*** GdbStub.hpp ****************************
+ *     _____     _ _      _____ _         _          _
+ *    / ____|   | | |    / ____| |       | |        | |
+ *   | |  __  __| | |__ | (___ | |_ _   _| |__      | |__  _ __  _ __
+ *   | | |_ |/ _` | '_ \ \___ \| __| | | | '_ \     | '_ \| '_ \| '_ \
+ *   | |__| | (_| | |_) |____) | |_| |_| | |_) |  _ | | | | |_) | |_) |
+ *    \_____|\__,_|_.__/|_____/ \__|\__,_|_.__/  (_)|_| |_| .__/| .__/
+ *                                                        | |   | |
+ *                                                        |_|   |_|
+ *
+ * GDB remote serial protocol server. It listens on a localhost TCP port
+ * or a Unix socket and serves one client at a time from its own thread;
+ * the CPU loop never polls it. Stops are detected by the server thread
+ * watching the debugger's single step state.
+ *
+ * Registers follow the debugger's DrawCpu() order, big endian:
+ *
+ *      0:CC  1:A  2:B  3:X  4:Y  5:U  6:PC  7:S  8:DP
+ *      (1 + 1 + 1 + 2 + 2 + 2 + 2 + 2 + 1 = 14 bytes for 'g')
+ *
+ * Memory packets use Memory::Peek() and Memory::Poke(). Z0/Z1 set
+ * breakpoints, Z2/Z3/Z4 set write/read/access watchpoints. "monitor
+ * break KRNL_START" (qRcmd) sets a breakpoint by kernel symbol.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "types.hpp"
+
+class GdbStub
+{
+public:
+    GdbStub() = default;
+    ~GdbStub() { Stop(); }
+    GdbStub(const GdbStub&) = delete;
+    GdbStub& operator=(const GdbStub&) = delete;
+
+    // listen on 127.0.0.1:port, or on socket_path when it is not empty
+    bool Start(int port, const std::string& socket_path);
+    void Stop();                                    // drops the client and joins the thread
+    bool IsActive() const { return _active; }
+
+    // Handles one packet body (without '$' and the checksum). Returns
+    // false when the packet resumed the CPU: the reply is then the stop
+    // reply, sent once the CPU halts again.
+    bool Process(const std::string& packet, std::string& reply);
+
+    static std::string Frame(const std::string& body);     // "$body#cs"
+
+    static constexpr int REG_COUNT = 9;
+    static constexpr int REG_BYTES = 14;
+
+private:
+    void _server_proc();
+    void _serve(int fd);
+    std::string _stop_reply();
+    void _resume(bool step);
+
+    std::atomic<bool> _active = false;
+    std::thread _server;
+    int _listen_fd = -1;
+    std::string _socket_path;
+
+    // run state of the current client (server thread only)
+    bool _running = false;                          // a c or s awaits its stop reply
+    bool _interrupted = false;                      // the stop was requested by the client
+    Uint32 _watch_count = 0;                        // watch hits seen when the CPU resumed
+};
+
+// END: GdbStub.hpp
@@ -75,6 +75,8 @@ protected: // PROTECTED ACCESSORS
         std::function<Byte(Word)> read;         // Read handler (lambda or function pointer)
         std::function<void(Word, Byte)> write;    // Write handler (lambda or function pointer)    
         std::vector<std::string> comment;   // register comments (can be multiple lines)
+        std::function<Byte(Word)> peek = nullptr;   // debugger read for registers whose read has
+                                                    // side effects (nullptr: read is used)
     };
     std::vector<REGISTER_NODE> mapped_register;
 };
@@ -76,6 +76,7 @@ private: // PRIVATE MEMBERS
     // HELPERS
 
     Byte _process_read_data(std::string& str, Byte& pos);
+    Byte _peek_data(const std::string& str, Byte pos) { return pos < str.size() ? (Byte)str[pos] : 0; }
 
 
     void _process_write_data(Word nextAddr, Byte data, 
@@ -19,6 +19,8 @@
  ******************/
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -78,6 +80,12 @@ public:     // PUBLIC ACCESSORS
     static void Write_Word(Word address, Word data, bool debug = false);     
     static void Write_DWord(Word address, DWord data, bool debug = false);   
 
+    // Side-effect-free access for the debugger, traces and snapshots.
+    // Peek() never pops queues or advances data ports and never trips a
+    // watchpoint; Poke() writes like the CPU but without watchpoints.
+    static Byte Peek(Word address);
+    static void Poke(Word address, Byte data);
+
     // Enforce Compile-time type checking for Write() methods
     template<typename T>
     static typename std::enable_if<!std::is_same<T, Byte>::value>::type
@@ -119,6 +127,17 @@ public:     // PUBLIC ACCESSORS
     // Map a constants name to its address
     static Word Map(std::string name, std::string file, int line);
 
+    // Watchpoints: one flag byte per address, beside the device dispatch
+    // table. Read() and Write() only leave their normal path when the
+    // flags of the address accessed are non-zero.
+    enum _WATCH : Byte {
+        WATCH_READ      = 0x01,     // any read
+        WATCH_WRITE     = 0x02,     // any write
+        WATCH_CHANGE    = 0x04,     // a write that changes the stored byte
+    };
+    static void Watch(Word address, Byte flags) { _watch[address].store(flags, std::memory_order_relaxed); }
+    static Byte Watched(Word address) { return _watch[address].load(std::memory_order_relaxed); }
+
 protected:
     inline static std::vector<Byte> _raw_cpu_memory;
 
@@ -128,6 +147,11 @@ private:
     inline static std::unordered_map<Word, REGISTER_NODE> _device_map;   // addressable hardware registers
     inline static std::vector<IDevice*> _memory_nodes;  // all of the attached devices	
     inline static std::unordered_map<std::string, Word> _map;   // constants
+    inline static std::array<std::atomic<Byte>, 0x10000> _watch{};   // watchpoint flags
+    static Byte _read_device(Word address);
+    static void _write_device(Word address, Byte data);
+    static Byte _read_watched(Word address, Byte flags);
+    static void _write_watched(Word address, Byte data, Byte flags);
     bool bWasInit = false;
 };
 
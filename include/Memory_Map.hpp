@@ -422,7 +422,9 @@ enum MEMMAP
     FC_SEEK_END           = 0x0016,   //     Seek End                              
     FC_SET_SEEK           = 0x0017,   //     Set Seek Position (from FIO_IOWORD)   
     FC_GET_SEEK           = 0x0018,   //     Get Seek Position (into FIO_IOWORD)   
-    FC_LAST               = 0x0018,   //   End FIO_COMMAND enumeration             
+    FC_READBLOCK          = 0x0019,   //     Read Block (into FIO_BLK_ADDR)        
+    FC_WRITEBLOCK         = 0x001A,   //     Write Block (from FIO_BLK_ADDR)       
+    FC_LAST               = 0x001A,   //   End FIO_COMMAND enumeration             
                                       // 
     FIO_HANDLE            = 0xFE5A,   // (Byte) Current File Stream HANDLE (0=NONE)
     FIO_SEEKPOS           = 0xFE5B,   // (DWord) File Seek Position
@@ -598,8 +600,328 @@ enum MEMMAP
     MMU_TOP               = 0xFEC1,   // Top of Banked Memory Register Space
 // _______________________________________________________________________
 
-    HDW_RESERVED_DEVICE   = 0xFEC1,   // START: Reserved Register Space
-    HDW_REG_END           = 0xFFF0,   // 303 bytes reserved for future use.
+    GPU_EXT_DEVICE        = 0xFEC1,   // START: Extended Graphics Hardware Registers
+    GPU_TMAP_LAYER        = 0xFEC1,   // (Byte) Tilemap Layer Select (0-1)
+                                      //   Note: Selects the tilemap layer referenced
+                                      //        by the GPU_TMAP_* and GPU_TILE_* registers.
+                                      //        Layer 1 is drawn over layer 0 and treats
+                                      //        color index 0 as transparent.
+                                      // 
+    GPU_TMAP_FLAGS        = 0xFEC2,   // (Byte) Tilemap Layer Flags
+                                      // - bit  7   = Layer Display Enable
+                                      // - bit  6   = Tile Size (0: 8x8, 1: 16x16)
+                                      // - bits 2-5 = (reserved)
+                                      // - bits 0-1 = Tile Color Depth:
+                                      //               00: 2-Colors
+                                      //               01: 4-Colors
+                                      //               10: 16-Colors
+                                      //               11: 256-Colors
+                                      // 
+    GPU_TMAP_WIDTH        = 0xFEC3,   // (Byte) Tilemap Width (in tiles, 1-255)
+                                      // 
+    GPU_TMAP_HEIGHT       = 0xFEC4,   // (Byte) Tilemap Height (in tiles, 1-255)
+                                      // 
+    GPU_TMAP_XPOS         = 0xFEC5,   // (Word) Tilemap Horizontal Scroll (in pixels)
+                                      //   Note: Pixel column of the tilemap shown at the
+                                      //        left edge of the display. The map wraps
+                                      //        around at its right edge.
+                                      // 
+    GPU_TMAP_YPOS         = 0xFEC7,   // (Word) Tilemap Vertical Scroll (in pixels)
+                                      //   Note: Pixel row of the tilemap shown at the
+                                      //        top edge of the display. The map wraps
+                                      //        around at its bottom edge.
+                                      // 
+    GPU_TMAP_ADDR         = 0xFEC9,   // (Word) Tile Index Map Address
+                                      //   Note: Extended memory address of the tile
+                                      //        index map. One byte per map cell, stored
+                                      //        row by row (GPU_TMAP_WIDTH bytes per row).
+                                      // 
+    GPU_TILE_ADDR         = 0xFECB,   // (Word) Tile Graphics Address
+                                      //   Note: Extended memory address of the first
+                                      //        of 256 tile images. Each tile is 8, 16,
+                                      //        32 or 64 bytes (8x8) and 32, 64, 128 or
+                                      //        256 bytes (16x16) at 2, 4, 16 and 256
+                                      //        colors respectively.
+                                      // 
+    GPU_DYN_ADDR          = 0xFECD,   // (Word) Extended Memory Address
+                                      //   Note: Auto-increments on each read or
+                                      //        write of GPU_DYN_DATA.
+                                      // 
+    GPU_DYN_DATA          = 0xFECF,   // (Byte) Extended Memory Data (Read/Write)
+                                      //   Note: GPU_DYN_ADDR advances by the
+                                      //        GPU_DYN_CTRL step after each access.
+                                      // 
+    GPU_DYN_DATA16        = 0xFED0,   // (Word) Extended Memory 16-Bit Data (Read/Write)
+                                      //   Note: Transfers the word at GPU_DYN_ADDR
+                                      //        (MSB first) and advances the address
+                                      //        once per word, after the LSB. Steps of
+                                      //        1 and 2 both move to the next word.
+                                      // 
+    GPU_DYN_CTRL          = 0xFED2,   // (Byte) Extended Memory Port Control
+                                      // - bits 2-7 = (reserved)
+                                      // - bits 0-1 = Address Step:
+                                      //               00: 1 byte
+                                      //               01: 2 bytes
+                                      //               10: GPU_DYN_PITCH bytes
+                                      //               11: none (fixed address)
+                                      // 
+    GPU_DYN_PITCH         = 0xFED3,   // (Word) Address Step for Column Access
+                                      //   Note: Usually the width of a bitmap or
+                                      //        tilemap row in bytes.
+                                      // 
+    GPU_SPR_MAX           = 0xFED5,   // (Byte) Maximum Sprite Index (Read Only)
+                                      // 
+    GPU_SPR_IDX           = 0xFED6,   // (Byte) Sprite Index (0-63)
+                                      //   Note: Selects the sprite referenced by
+                                      //        the GPU_SPR_* registers.
+                                      // 
+    GPU_SPR_XPOS          = 0xFED7,   // (SInt16) Sprite X Position (left edge)
+                                      // 
+    GPU_SPR_YPOS          = 0xFED9,   // (SInt16) Sprite Y Position (top edge)
+                                      // 
+    GPU_SPR_ADDR          = 0xFEDB,   // (Word) Sprite Image Address
+                                      //   Note: Extended memory address of the 16x16
+                                      //        sprite image; 32, 64, 128 or 256 bytes
+                                      //        at 2, 4, 16 and 256 colors respectively.
+                                      // 
+    GPU_SPR_PAL           = 0xFEDD,   // (Byte) Sprite Palette Offset
+                                      //   Note: Added to every non-zero color index
+                                      //        of the sprite image. Index 0 is always
+                                      //        transparent.
+                                      // 
+    GPU_SPR_PRIORITY      = 0xFEDE,   // (Byte) Sprite Display Priority
+                                      //   Note: Higher priorities are drawn on top.
+                                      //        Equal priorities draw the higher
+                                      //        sprite index on top.
+                                      // 
+    GPU_SPR_FLAGS         = 0xFEDF,   // (Byte) Sprite Flags
+                                      // - bit  7   = Display Enable
+                                      // - bit  6   = Collision Enable
+                                      // - bit  5   = Flip Vertical
+                                      // - bit  4   = Flip Horizontal
+                                      // - bits 2-3 = (reserved)
+                                      // - bits 0-1 = Sprite Color Depth:
+                                      //               00: 2-Colors
+                                      //               01: 4-Colors
+                                      //               10: 16-Colors
+                                      //               11: 256-Colors
+                                      // 
+    GPU_SPR_HITS          = 0xFEE0,   // (8-Bytes) Sprite Collision Bits (Read Only)
+                                      //   Note: One bit for each sprite that overlapped
+                                      //        an opaque pixel of the selected sprite
+                                      //        during the last frame. The first byte
+                                      //        holds sprites 63-56, the last 7-0.
+                                      // 
+    GPU_COLL_MAP          = 0xFEE8,   // (8-Bytes) Collided Sprites (Read Only)
+                                      //   Note: One bit for each sprite that collided
+                                      //        with any other sprite during the last
+                                      //        frame. The first byte holds sprites
+                                      //        63-56, the last 7-0.
+                                      // 
+    GPU_BLT_SRC           = 0xFEF0,   // (Word) Blitter Source Address
+                                      //   Note: Extended memory, or CPU memory when
+                                      //        GPU_BLT_FLAGS bit 3 is set. SCROLL uses
+                                      //        it as signed offsets (MSB: bytes, LSB: rows).
+                                      //        DRAW_LINE uses it as the starting X.
+                                      // 
+    GPU_BLT_DST           = 0xFEF2,   // (Word) Blitter Destination Address
+                                      //   Note: Extended memory, or CPU memory when
+                                      //        GPU_BLT_FLAGS bit 4 is set. CPU memory
+                                      //        is limited to VIDEO_START-VIDEO_END.
+                                      // 
+    GPU_BLT_WIDTH         = 0xFEF4,   // (Word) Blitter Width (in bytes)
+                                      //   Note: COPY uses it as the byte count.
+                                      //        DRAW_LINE uses it as the ending X.
+                                      // 
+    GPU_BLT_HEIGHT        = 0xFEF6,   // (Word) Blitter Height (in rows)
+                                      //   Note: DRAW_LINE uses it as the ending Y.
+                                      // 
+    GPU_BLT_SPITCH        = 0xFEF8,   // (Word) Blitter Source Stride (bytes per row)
+                                      //   Note: DRAW_LINE uses it as the starting Y.
+                                      // 
+    GPU_BLT_DPITCH        = 0xFEFA,   // (Word) Blitter Destination Stride (bytes per row)
+                                      // 
+    GPU_BLT_COLOR         = 0xFEFC,   // (Byte) Blitter Fill Color
+                                      //   Note: Byte value for CLEAR, SCROLL and
+                                      //        FILL_RECT; color index for DRAW_LINE.
+                                      // 
+    GPU_BLT_KEY           = 0xFEFD,   // (Byte) Blitter Color Key (source bytes skipped by BLIT)
+                                      // 
+    GPU_BLT_ROP           = 0xFEFE,   // (Byte) Blitter Raster Operation
+                                      //    $00 = COPY (dst = src)
+                                      //    $01 = AND  (dst = dst & src)
+                                      //    $02 = OR   (dst = dst | src)
+                                      //    $03 = XOR  (dst = dst ^ src)
+                                      //    $04 = NOT  (dst = ~src)
+                                      // 
+    GPU_BLT_FLAGS         = 0xFEFF,   // (Byte) Blitter Flags
+                                      // - bit  7   = Busy (Read Only)
+                                      // - bit  6   = IRQ on Command Completion
+                                      // - bit  5   = Color Key Enable (BLIT)
+                                      // - bit  4   = Destination in CPU Memory
+                                      // - bit  3   = Source in CPU Memory
+                                      // - bit  2   = Completion IRQ Pending
+                                      //               (write 1 to acknowledge)
+                                      // - bits 0-1 = DRAW_LINE Color Depth:
+                                      //               00: 2-Colors
+                                      //               01: 4-Colors
+                                      //               10: 16-Colors
+                                      //               11: 256-Colors
+                                      // 
+    GPU_COMMAND           = 0xFF00,   // (Byte) Graphics Processing Unit Command:
+                                      //   Note: Commands complete before the write
+                                      //        returns. Rectangles are GPU_BLT_WIDTH
+                                      //        bytes by GPU_BLT_HEIGHT rows.
+                                      //        TEXT_SCROLL works in text cells: DST is
+                                      //        the top left (MSB: column, LSB: row),
+                                      //        WIDTH x HEIGHT the region, SRC the signed
+                                      //        offsets as for SCROLL, and COLOR the
+                                      //        attribute of the blank cells it exposes.
+    GPU_CMD_NOP           = 0x0000,   //    $00 = No Operation
+    GPU_CMD_CLEAR         = 0x0001,   //    $01 = Clear the Destination Buffer
+    GPU_CMD_COPY          = 0x0002,   //    $02 = Linear Copy (WIDTH bytes)
+    GPU_CMD_BLIT          = 0x0003,   //    $03 = Rectangle Copy (ROP, Color Key)
+    GPU_CMD_SCROLL        = 0x0004,   //    $04 = Scroll Destination Rectangle
+    GPU_CMD_DRAW_LINE     = 0x0005,   //    $05 = Draw a Line
+    GPU_CMD_FILL_RECT     = 0x0006,   //    $06 = Fill Destination Rectangle (ROP)
+    GPU_CMD_TEXT_SCROLL   = 0x0007,   //    $07 = Scroll a Text Region (in cells)
+    GPU_CMD_SIZE          = 0x0008,   //    $08 = Total Number of GPU Commands
+                                      // 
+    GPU_ERROR             = 0xFF01,   // (Byte) Graphics Processing Unit Error Code:   (Read Only)
+    GPU_ERR_NONE          = 0x0000,   //    $00 = No Error
+    GPU_ERR_COMMAND       = 0x0001,   //    $01 = Invalid Command
+    GPU_ERR_ADDRESS       = 0x0002,   //    $02 = Invalid Address (out of range)
+    GPU_ERR_ARGUMENT      = 0x0003,   //    $03 = Invalid Argument
+    GPU_ERR_SIZE          = 0x0004,   //    $04 = Total Number of GPU Errors
+                                      // 
+    GPU_RASTER_LINE       = 0xFF02,   // (Word) Current Raster Line (Read Only)
+                                      //   Note: 525 lines per frame at 70 Hz, timed
+                                      //        from the CPU clock. Lines 0-399 are
+                                      //        visible, 400-524 are vertical blank.
+                                      // 
+    GPU_RASTER_CMP        = 0xFF04,   // (Word) Raster Compare Line
+                                      //   Note: GPU_RASTER_CTRL bit 0 is set, and an
+                                      //        IRQ raised if enabled, when the raster
+                                      //        reaches this line.
+                                      // 
+    GPU_RASTER_CTRL       = 0xFF06,   // (Byte) Raster Control
+                                      // - bit  7   = Scanline Renderer Enable
+                                      //               (palette, scroll and mode changes
+                                      //               take effect on the next line)
+                                      // - bit  6   = IRQ on Compare Match
+                                      // - bits 1-5 = (reserved)
+                                      // - bit  0   = Compare Matched (write 1 to clear)
+                                      // 
+    GPU_VBL_CTRL          = 0xFF07,   // (Byte) Vertical Blank Control / Status
+                                      // - bit  7   = Vertical Blank Interrupt Enable
+                                      // - bit  6   = Interrupt Line (0: IRQ, 1: FIRQ)
+                                      // - bits 2-5 = (reserved)
+                                      // - bit  1   = VSYNC: Raster in Vertical Blank
+                                      //               (Read Only)
+                                      // - bit  0   = Vertical Blank Pending
+                                      //               (write 1 to acknowledge)
+                                      // 
+    GPU_VBL_FRAME         = 0xFF08,   // (Word) Frame Counter (Read Only)
+                                      //   Note: Increments at the start of each
+                                      //        vertical blank (70 times per second
+                                      //        of emulated CPU time).
+                                      // 
+    GPU_PAGE_DISPLAY      = 0xFF0A,   // (Byte) Displayed Extended Video Page
+                                      //   Write: page shown from the next vertical blank
+                                      //   Read:  bits 0-1: page being displayed
+                                      //          bit 7:    flip pending (until the vertical blank)
+                                      // 
+    GPU_PAGE_DRAW         = 0xFF0B,   // (Byte) Extended Video Page Accessed by the CPU
+                                      //   The GPU_DYN_* ports and the blitter read and
+                                      //   write this page (0-3); takes effect immediately.
+                                      // 
+    GPU_STD_SCROLL_X      = 0xFF0C,   // (Word) Standard Display Horizontal Scroll (in pixels)
+                                      //   Note: Text and bitmap modes. Pixel column shown
+                                      //        at the left edge; text scrolls by whole and
+                                      //        partial characters. The display wraps around.
+                                      // 
+    GPU_STD_SCROLL_Y      = 0xFF0E,   // (Word) Standard Display Vertical Scroll (in pixels)
+                                      //   Note: Pixel row shown at the top of the display.
+                                      //        The display wraps around at its bottom edge.
+                                      // 
+    GPU_EXT_SCROLL_X      = 0xFF10,   // (Word) Extended Bitmap Horizontal Scroll (in pixels)
+                                      //   Note: Extended bitmap modes only; the tilemaps use
+                                      //        GPU_TMAP_XPOS and GPU_TMAP_YPOS.
+                                      // 
+    GPU_EXT_SCROLL_Y      = 0xFF12,   // (Word) Extended Bitmap Vertical Scroll (in pixels)
+                                      // 
+    GPU_CYCLE_IDX         = 0xFF14,   // (Byte) Palette Cycling Range Index (0-7)
+                                      //   Note: Selects the range GPU_CYCLE_START through
+                                      //        GPU_CYCLE_FLAGS refer to.
+                                      // 
+    GPU_CYCLE_START       = 0xFF15,   // (Byte) First Palette Entry of the Range
+    GPU_CYCLE_END         = 0xFF16,   // (Byte) Last Palette Entry of the Range
+    GPU_CYCLE_RATE        = 0xFF17,   // (Byte) Vertical Blanks per Cycling Step (1-255)
+    GPU_CYCLE_FLAGS       = 0xFF18,   // (Byte) Palette Cycling Range Flags
+                                      //    - bit  7   = Range Cycling Enable
+                                      //    - bits 1-6 = Reserved
+                                      //    - bit  0   = Direction (0: colors move up, 1: down)
+                                      //   Note: Enabled ranges rotate the palette entries
+                                      //        START through END one place every RATE
+                                      //        vertical blanks without any CPU time.
+                                      // 
+    GPU_EXT_END           = 0xFF18,   // End of Extended Graphics Register Space
+    GPU_EXT_TOP           = 0xFF19,   // Top of Extended Graphics Register Space
+// _______________________________________________________________________
+
+    SYS_EXT_DEVICE        = 0xFF19,   // START: Extended System Hardware Registers
+    SYS_PACE_CTRL         = 0xFF19,   // (Byte) Frame Pacing Control / Status
+                                      // - bit  7   = Pace Frames to 70 Hz
+                                      //               (0: run as fast as possible)
+                                      // - bit  6   = Presentation Waits for VSYNC
+                                      //               (GPU_MODE VSync, Read Only)
+                                      // - bits 1-5 = (reserved)
+                                      // - bit  0   = Clear Frame Time Histogram
+                                      //               (write 1)
+                                      // 
+    SYS_FRAME_TIME        = 0xFF1A,   // (Word) Last Host Frame Time (Read Only)
+                                      //   Note: In 1/100 milliseconds. A paced
+                                      //        frame is 1428 (14.28 ms).
+                                      // 
+    SYS_FRAME_HIST_SEL    = 0xFF1C,   // (Byte) Frame Time Histogram Bucket (0-15)
+                                      //   Note: Bucket N counts frames that took
+                                      //        N*2 to N*2+2 ms. Bucket 15 also counts
+                                      //        every longer frame.
+                                      // 
+    SYS_FRAME_HIST        = 0xFF1D,   // (Word) Frames in the Selected Bucket (Read Only)
+                                      //   Note: Counts stop at $FFFF.
+                                      // 
+    SYS_RENDER_TIME       = 0xFF1F,   // (Word) Average Composed Frame Cost (Read Only)
+                                      //   Note: In 1/100 milliseconds. Covers the
+                                      //        device updates and rendering of the
+                                      //        frames that are not skipped.
+                                      // 
+    SYS_SKIP_LEVEL        = 0xFF21,   // (Byte) Current Frame Skip Level (Read Only)
+                                      //   Note: N skipped frames follow each composed
+                                      //        frame. Input, device updates and the
+                                      //        vertical blank continue every frame.
+                                      // 
+    SYS_SKIP_MAX          = 0xFF22,   // (Byte) Frame Skip Level Limit (0-7)
+                                      //   Note: 0 composes every frame.
+                                      // 
+    SYS_EXT_END           = 0xFF22,   // End of Extended System Register Space
+    SYS_EXT_TOP           = 0xFF23,   // Top of Extended System Register Space
+// _______________________________________________________________________
+
+    FIO_EXT_DEVICE        = 0xFF23,   // START: Extended File I/O Hardware Registers
+    FIO_BLK_ADDR          = 0xFF23,   // (Word) CPU Address of the Block to Read / Write
+                                      //   Note: Used by FC_READBLOCK and FC_WRITEBLOCK.
+                                      // 
+    FIO_BLK_LEN           = 0xFF25,   // (Word) Block Length in Bytes
+                                      //   Note: Replaced by the number of bytes
+                                      //        actually transferred.
+                                      // 
+    FIO_EXT_END           = 0xFF26,   // End of Extended File I/O Register Space
+    FIO_EXT_TOP           = 0xFF27,   // Top of Extended File I/O Register Space
+// _______________________________________________________________________
+
+    HDW_RESERVED_DEVICE   = 0xFF27,   // START: Reserved Register Space
+    HDW_REG_END           = 0xFFF0,   // 201 bytes reserved for future use.
 // _______________________________________________________________________
 
     ROM_VECTS_DEVICE      = 0xFFF0,   // START: Hardware Interrupt Vectors
@@ -84,10 +84,9 @@ private: // PRIVATE MEMBERS
     void _show_SDL_cursor(bool b);      // hides or shows the SDL and Hardware cursors 
     void _display_SDL_cursor();         // displays the cursor bitmap image
     void _render_csr_buffer();
-    void _setPixel_cursor(void* pixels, int pitch, int x, int y, Byte color_index);
 
     // SDL Stuff
-    // SDL_Texture* _cursor_texture = nullptr;
+    SDL_Texture* _cursor_texture = nullptr;     // 16x16 ARGB4444 cursor image
 
     // internal state
     int mouse_x = 0;			// horizontal mouse cursor position
@@ -96,7 +95,7 @@ private: // PRIVATE MEMBERS
     Uint8 mouse_x_offset = 0;	// mouse cursor offset x
     Uint8 mouse_y_offset = 0;	// mouse cursor offset y
     Byte button_flags = 0;		// bits 0-4: button states, bit 5: cursor enable, bits 6-7: number of clicks
-    bool _bCsrIsDirty = true;	// internal flag
+    bool _bCsrIsDirty = true;	// the cursor texture needs rebuilding
     // bool _bUseSdlCursor = ENABLE_SDL_MOUSE_CURSOR;  // was _bCsrIsVisible
 
     // cursor stuff
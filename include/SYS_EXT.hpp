@@ -0,0 +1,105 @@
+/*** SYS_EXT.hpp *******************************************
+ *     _______     _______     ________   _________     _
+ *    / ____\ \   / / ____|   |  ____\ \ / /__   __|   | |
+ *   | (___  \ \_/ / (___     | |__   \ V /   | |      | |__  _ __  _ __
+ *    \___ \  \   / \___ \    |  __|   > <    | |      | '_ \| '_ \| '_ \
+ *    ____) |  | |  ____) |   | |____ / . \   | |   _  | | | | |_) | |_) |
+ *   |_____/   |_| |_____/    |______/_/ \_\  |_|  (_) |_| |_| .__/| .__/
+ *                        ______                             | |   | |
+ *                       |______|                            |_|   |_|
+ *
+ * Extended System Registers. This device paces the host frame loop to
+ * the 70 Hz display rate, reports the measured frame times and skips
+ * composing frames when the host cannot keep up.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include "IDevice.hpp"
+
+class SYS_EXT : public IDevice {
+
+public: // PUBLIC CONSTRUCTOR / DESTRUCTOR
+    SYS_EXT();
+    virtual ~SYS_EXT();
+
+public: // VIRTUAL METHODS
+
+    virtual int  OnAttach(int nextAddr) override;   // attach to the memory map
+    virtual bool OnTest() override;                 // return true for successful unit tests
+
+    // not used
+    virtual void OnInit() override {};
+    virtual void OnQuit() override {};
+    virtual void OnActivate() override {};
+    virtual void OnDeactivate() override {};
+    virtual void OnEvent(SDL_Event* evnt) override { (void)evnt; }
+    virtual void OnUpdate(float fElapsedTime) override { (void)fElapsedTime; }
+    virtual void OnRender() override {};
+
+public: // PUBLIC ACCESSORS
+
+    // start a Bus::Run() iteration and decide whether it is skipped
+    void BeginFrame();
+
+    // true while the current frame is not composed or presented
+    bool IsSkipping() { return _skipping; }
+
+    // the current frame has been composed (records its cost)
+    void EndRender();
+
+    // wait for the next frame deadline, then record the frame time
+    // (called once per Bus::Run() iteration after presenting)
+    void PaceFrame();
+
+    float FrameTime() { return _frame_time / 100.0f; }     // last frame time in milliseconds
+    Word  FrameHistogram(int bucket) { return _hist[bucket]; }
+    float RenderTime() { return _render_time / 100.0f; }   // average composed frame cost in milliseconds
+    Byte  SkipLevel() { return _skip_level; }
+    Byte  SkipMax() { return _skip_max; }
+
+    static constexpr int FRAME_HZ = 70;         // target frames per second (640x400 @ 70hz timing)
+    static constexpr int HIST_BUCKETS = 16;     // frame time histogram buckets
+    static constexpr int HIST_MS = 2;           // milliseconds per histogram bucket
+    static constexpr int SKIP_LIMIT = 7;        // largest frame skip level
+    static constexpr int SKIP_WINDOW = 35;      // composed frames between skip level changes
+
+    enum _PACE_CTRL : Byte {
+        PACE_ENABLE         = 0x80,  // - bit 7: Frame Pacing Enable
+        PACE_VSYNC          = 0x40,  // - bit 6: Presentation Waits for VSYNC (Read Only)
+        PACE_RESET          = 0x01,  // - bit 0: Clear the Frame Time Histogram (write 1)
+    };
+
+private: // PRIVATE MEMBERS
+    using clock = std::chrono::steady_clock;
+
+    void _record_frame(clock::duration frame);
+    void _record_render(clock::duration cost);
+
+    Byte _pace_ctrl = PACE_ENABLE;                  // SYS_PACE_CTRL
+    Word _frame_time = 0;                           // SYS_FRAME_TIME (1/100 ms)
+    Byte _hist_sel = 0;                             // SYS_FRAME_HIST_SEL
+    std::array<Word, HIST_BUCKETS> _hist = {};      // SYS_FRAME_HIST
+
+    clock::time_point _deadline;                    // end of the current frame
+    clock::time_point _last_frame;                  // when the previous frame ended
+    bool _pacing = false;                           // _deadline is valid
+
+    // adaptive frame skip
+    Word _render_time = 0;                          // SYS_RENDER_TIME (1/100 ms)
+    Byte _skip_level = 0;                           // SYS_SKIP_LEVEL
+    Byte _skip_max = GPU_HEADLESS ? 0 : 3;          // SYS_SKIP_MAX (headless runs compose every frame)
+    bool _skipping = false;                         // the current frame is skipped
+    int  _skip_count = 0;                           // frames skipped since the last composed one
+    clock::time_point _frame_start;                 // BeginFrame() of the current frame
+    long long _render_acc = 0;                      // composed frame cost over the window (us)
+    int _render_frames = 0;                         // composed frames in the window
+};
+
+// END: SYS_EXT.hpp
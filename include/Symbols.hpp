@@ -0,0 +1,79 @@
+/*** Symbols.hpp ****************************
+ *     _____                 _           _         _
+ *    / ____|               | |         | |       | |
+ *   | (___  _   _ _ __ ___ | |__   ___ | |___    | |__  _ __  _ __
+ *    \___ \| | | | '_ ` _ \| '_ \ / _ \| / __|   | '_ \| '_ \| '_ \
+ *    ____) | |_| | | | | | | |_) | (_) | \__ \ _ | | | | |_) | |_) |
+ *   |_____/ \__, |_| |_| |_|_.__/ \___/|_|___/(_)|_| |_| .__/| .__/
+ *            __/ |                                     | |   | |
+ *           |___/                                      |_|   |_|
+ *
+ * Debugger symbol table, loaded from the assembler output in ./asm/:
+ *
+ *      Kernel.sym          "name equ value" lines (asm6809 -s, or an
+ *                          lwasm style equate dump; decimal or $hex)
+ *      Kernel.lst          asm6809 listing; tells code labels apart
+ *                          from equates
+ *      Memory_Map.asm      the generated hardware register map
+ *
+ * Labels and register addresses are kept in one table sorted by address.
+ * Each entry covers the addresses up to the next one, so an address maps
+ * to "name" or "name+$ofs" with a binary search. A hash map resolves
+ * names back to values, including plain constants (CALL_CMPSTR, FE_EOF)
+ * that never take part in address lookups.
+ *
+ * The table is filled before the CPU thread starts and is only read
+ * afterwards.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+class Symbols
+{
+public:
+    enum KIND : Byte {
+        SYM_LABEL,          // code or data label
+        SYM_ADDRESS,        // memory mapped register or region
+        SYM_CONST,          // value only: never shown for an address
+    };
+    struct SYMBOL {
+        Word address = 0;
+        KIND kind = SYM_LABEL;
+        std::string name;
+    };
+
+    bool LoadSym(const std::string& filename);      // false if the file can't be read
+    bool LoadListing(const std::string& filename);
+    bool LoadMap(const std::string& filename);
+    void Add(const std::string& name, Word value, KIND kind);
+    void Clear();
+    size_t Size() const { return _by_name.size(); }
+
+    // the entry covering address (nullptr below the first one)
+    const SYMBOL* Find(Word address) const;
+    // "name" or "name+$ofs", "" if no symbol covers address
+    std::string Name(Word address) const;
+    // exact name lookup
+    bool Value(const std::string& name, Word& value) const;
+    // "$hex", "0xhex", decimal, "name" or "name+ofs"
+    bool Parse(const std::string& text, Word& value) const;
+
+private:
+    void _add(const std::string& name, Word value, KIND kind);
+    void _sort();
+
+    std::vector<SYMBOL> _by_address;                    // labels and addresses only
+    std::unordered_map<std::string, SYMBOL> _by_name;   // everything
+};
+
+// END: Symbols.hpp
@@ -38,6 +38,8 @@
     #define MEMORY_MAP_OUTPUT_FILE_HPP  "./include/Memory_Map.hpp"
     #define MEMORY_MAP_OUTPUT_FILE_ASM  "./asm/Memory_Map.asm"    
     #define KERNEL_ROM_FILENAME         "./asm/Kernel.hex"
+    #define KERNEL_SYMBOL_FILENAME      "./asm/Kernel.sym"
+    #define KERNEL_LISTING_FILENAME     "./asm/Kernel.lst"
 
 
     // simple types for 8-bit archetecture 
@@ -81,6 +83,52 @@
         #define MAP(key) static_cast<Word>(key)
     #endif  // END: GENERATE_MEMORY_MAP
 
+    // GPU Headless Backend Constants:
+    //      GPU_HEADLESS:           compose frames in software only (no window,
+    //                              renderer or textures); build with
+    //                              -DGPU_HEADLESS=true for visual tests
+    //      GPU_HEADLESS_FRAMES:    stop after this many frames (0: run normally)
+    //      GPU_DUMP_EVERY:         dump every Nth frame (0: only on request)
+    //      GPU_DUMP_PATH:          folder for the dumped .ppm frames
+    //      GPU_GOLDEN_PATH:        dumped frames are compared against a golden
+    //                              image of the same name in this folder
+    //      GPU_GOLDEN_TOLERANCE:   allowed difference per color channel
+    #ifndef GPU_HEADLESS
+        #define GPU_HEADLESS false
+    #endif
+    #ifndef GPU_HEADLESS_FRAMES
+        #define GPU_HEADLESS_FRAMES 0
+    #endif
+    #ifndef GPU_DUMP_EVERY
+        #define GPU_DUMP_EVERY 0
+    #endif
+    #define GPU_DUMP_PATH           "./frames/"
+    #define GPU_GOLDEN_PATH         "./frames/golden/"
+    constexpr int GPU_GOLDEN_TOLERANCE = 2;
+
+    // GPU Frame Capture Constants:
+    //      GPU_CAPTURE:            start capturing at launch (0: off, 1: .y4m, 2: raw RGB24);
+    //                              [CTRL]+[R] toggles a .y4m capture, [CTRL]+[SHIFT]+[R] raw
+    //      GPU_CAPTURE_PATH:       folder for the capture files
+    //      GPU_CAPTURE_QUEUE:      frames buffered for the writer thread
+    #ifndef GPU_CAPTURE
+        #define GPU_CAPTURE 0
+    #endif
+    #define GPU_CAPTURE_PATH        "./capture/"
+    constexpr int GPU_CAPTURE_QUEUE = 8;
+
+    // GDB Remote Stub Constants:
+    //      GDB_STUB:               localhost TCP port for a gdb remote
+    //                              connection (0: off); build with
+    //                              -DGDB_STUB=6809 and use "target remote :6809"
+    //      GDB_STUB_SOCKET:        listen on this Unix socket instead ("": TCP)
+    #ifndef GDB_STUB
+        #define GDB_STUB 0
+    #endif
+    #ifndef GDB_STUB_SOCKET
+        #define GDB_STUB_SOCKET ""
+    #endif
+
     // Keyboard Constants:
     constexpr size_t EDIT_BUFFER_SIZE = 128; // FIO_LN_EDT_BUFFER through FIO_LN_EDT_END
 
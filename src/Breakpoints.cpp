@@ -0,0 +1,333 @@
+/*** Breakpoints.cpp ****************************
+ *    ____                 _                _       _
+ *   |  _ \               | |              (_)     | |
+ *   | |_) |_ __ ___  __ _| | ___ __   ___  _ _ __ | |_ ___   ___ _ __  _ __
+ *   |  _ <| '__/ _ \/ _` | |/ / '_ \ / _ \| | '_ \| __/ __| / __| '_ \| '_ \
+ *   | |_) | | |  __/ (_| |   <| |_) | (_) | | | | | |_\__ \| (__| |_) | |_) |
+ *   |____/|_|  \___|\__,_|_|\_\ .__/ \___/|_|_| |_|\__|___(_)___| .__/| .__/
+ *                             | |                               | |   | |
+ *                             |_|                               |_|   |_|
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+#include <cctype>
+#include "Breakpoints.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "Memory.hpp"
+#include "Symbols.hpp"
+
+
+bool Breakpoints::Hit(Word address)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _info.find(address);
+    if (it == _info.end()) { return true; }
+    BREAKPOINT& bp = it->second;
+    if (!bp.code.empty() && Evaluate(bp.code) == 0) { return false; }
+    bp.hits++;
+    if (bp.ignore > 0) {
+        bp.ignore--;
+        return false;
+    }
+    return true;
+} // END: Breakpoints::Hit()
+
+
+void Breakpoints::Set(Word address, bool enable)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint64_t bit = 1ull << (address & 63);
+    if (enable) {
+        _info.try_emplace(address);
+        _bits[address >> 6].fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        _bits[address >> 6].fetch_and(~bit, std::memory_order_relaxed);
+        _info.erase(address);
+    }
+} // END: Breakpoints::Set()
+
+
+void Breakpoints::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& bits : _bits) { bits.store(0, std::memory_order_relaxed); }
+    _info.clear();
+} // END: Breakpoints::Clear()
+
+
+/**
+ * Compiles and attaches a condition, setting the breakpoint if needed.
+ * An empty condition makes the breakpoint unconditional again.
+ *
+ * @return false (with the breakpoint unchanged) if the condition is invalid.
+ */
+bool Breakpoints::SetCondition(Word address, const std::string& condition, std::string& error)
+{
+    std::vector<Byte> code;
+    if (!condition.empty() && !Compile(condition, code, error, _symbols)) { return false; }
+    Set(address, true);
+    std::lock_guard<std::mutex> lock(_mutex);
+    BREAKPOINT& bp = _info[address];
+    bp.condition = condition;
+    bp.code = std::move(code);
+    return true;
+} // END: Breakpoints::SetCondition()
+
+
+void Breakpoints::SetIgnore(Word address, Uint32 count)
+{
+    Set(address, true);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _info[address].ignore = count;
+} // END: Breakpoints::SetIgnore()
+
+
+std::vector<Word> Breakpoints::Addresses()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Word> list;
+    for (auto& bp : _info) { list.push_back(bp.first); }
+    return list;
+} // END: Breakpoints::Addresses()
+
+
+bool Breakpoints::Info(Word address, BREAKPOINT& info)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _info.find(address);
+    if (it == _info.end()) { return false; }
+    info = it->second;
+    return true;
+} // END: Breakpoints::Info()
+
+
+
+/*********************
+* Condition Compiler *
+*********************/
+
+
+namespace {
+
+    enum OPCODE : Byte {
+        OP_CONST = 0,   // push the following Word (MSB first)
+        OP_REG,         // push the register numbered by the following byte
+        OP_PEEK8,       // replace the address on top with the byte there
+        OP_PEEK16,      // replace the address on top with the word there
+        OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE,
+        OP_AND,         // bitwise and
+        OP_LAND,        // logical and
+        OP_LOR,         // logical or
+    };
+    enum REG : Byte { REG_A, REG_B, REG_D, REG_X, REG_Y, REG_U, REG_S, REG_PC, REG_DP, REG_CC };
+    constexpr int STACK_DEPTH = 16;
+
+    // recursive descent over the source text, emitting bytecode as it goes
+    struct COMPILER {
+        const std::string& src;
+        std::vector<Byte>& code;
+        std::string& error;
+        const Symbols* symbols;
+        size_t pos = 0;
+        int depth = 0;          // current evaluation stack depth
+        int max_depth = 0;
+
+        void skip() { while (pos < src.size() && std::isspace((unsigned char)src[pos])) { pos++; } }
+        bool accept(const char* token)
+        {
+            skip();
+            size_t len = std::char_traits<char>::length(token);
+            if (src.compare(pos, len, token) != 0) { return false; }
+            // "&" and "<" must not swallow the first half of "&&" and "<="
+            if (len == 1 && pos + 1 < src.size() && (token[0] == '&' || token[0] == '<' || token[0] == '>')) {
+                if (src[pos + 1] == '&' || src[pos + 1] == '=') { return false; }
+            }
+            pos += len;
+            return true;
+        }
+        bool fail(const std::string& what)
+        {
+            if (error.empty()) { error = what + " at column " + std::to_string(pos + 1); }
+            return false;
+        }
+        void push() { depth++; max_depth = std::max(max_depth, depth); }
+        void emit_binary(Byte op) { code.push_back(op); depth--; }
+
+        bool primary()
+        {
+            skip();
+            if (accept("(")) { return logical_or() && (accept(")") || fail("expected )")); }
+            if (accept("[")) { return logical_or() && (accept("]") || fail("expected ]")) && (code.push_back(OP_PEEK8), true); }
+            if (accept("{")) { return logical_or() && (accept("}") || fail("expected }")) && (code.push_back(OP_PEEK16), true); }
+            if (pos >= src.size()) { return fail("unexpected end"); }
+
+            // numbers: $hex, 0xhex or decimal
+            int base = 10;
+            if (src[pos] == '$') { base = 16; pos++; }
+            else if (src.compare(pos, 2, "0x") == 0 || src.compare(pos, 2, "0X") == 0) { base = 16; pos += 2; }
+            if (std::isxdigit((unsigned char)src[pos]) && (base == 16 || std::isdigit((unsigned char)src[pos])))
+            {
+                size_t end = pos;
+                while (end < src.size() && std::isxdigit((unsigned char)src[end]) &&
+                       (base == 16 || std::isdigit((unsigned char)src[end]))) { end++; }
+                if (end - pos > 5) { return fail("number out of range"); }
+                unsigned long value = std::stoul(src.substr(pos, end - pos), nullptr, base);
+                if (value > 0xFFFF) { return fail("number out of range"); }
+                pos = end;
+                code.push_back(OP_CONST);
+                code.push_back((Byte)(value >> 8));
+                code.push_back((Byte)(value & 0xFF));
+                push();
+                return true;
+            }
+            if (base == 16) { return fail("expected hex digits"); }
+
+            // registers, then symbols
+            size_t end = pos;
+            while (end < src.size() && (std::isalnum((unsigned char)src[end]) || src[end] == '_' || src[end] == '.')) { end++; }
+            std::string name = src.substr(pos, end - pos);
+            std::string upper = name;
+            for (auto& c : upper) { c = (char)std::toupper((unsigned char)c); }
+            static const char* names[] = { "A", "B", "D", "X", "Y", "U", "S", "PC", "DP", "CC" };
+            for (Byte r = 0; r < sizeof(names) / sizeof(names[0]); r++)
+            {
+                if (upper == names[r])
+                {
+                    pos = end;
+                    code.push_back(OP_REG);
+                    code.push_back(r);
+                    push();
+                    return true;
+                }
+            }
+            Word value;
+            if (symbols && !name.empty() && symbols->Value(name, value))
+            {
+                pos = end;
+                code.push_back(OP_CONST);
+                code.push_back((Byte)(value >> 8));
+                code.push_back((Byte)(value & 0xFF));
+                push();
+                return true;
+            }
+            return fail("unknown operand");
+        }
+        bool bitwise()
+        {
+            if (!primary()) { return false; }
+            while (accept("&")) {
+                if (!primary()) { return false; }
+                emit_binary(OP_AND);
+            }
+            return true;
+        }
+        bool compare()
+        {
+            if (!bitwise()) { return false; }
+            static const std::pair<const char*, Byte> ops[] = {
+                { "==", OP_EQ }, { "!=", OP_NE }, { "<=", OP_LE }, { ">=", OP_GE }, { "<", OP_LT }, { ">", OP_GT }
+            };
+            for (auto& op : ops) {
+                if (accept(op.first)) {
+                    if (!bitwise()) { return false; }
+                    emit_binary(op.second);
+                    break;
+                }
+            }
+            return true;
+        }
+        bool logical_and()
+        {
+            if (!compare()) { return false; }
+            while (accept("&&")) {
+                if (!compare()) { return false; }
+                emit_binary(OP_LAND);
+            }
+            return true;
+        }
+        bool logical_or()
+        {
+            if (!logical_and()) { return false; }
+            while (accept("||")) {
+                if (!logical_and()) { return false; }
+                emit_binary(OP_LOR);
+            }
+            return true;
+        }
+    };
+
+} // END: namespace
+
+
+bool Breakpoints::Compile(const std::string& source, std::vector<Byte>& code, std::string& error, const Symbols* symbols)
+{
+    code.clear();
+    error.clear();
+    COMPILER c{ source, code, error, symbols };
+    if (!c.logical_or()) { return false; }
+    c.skip();
+    if (c.pos != source.size()) { return c.fail("unexpected text"); }
+    if (c.max_depth > STACK_DEPTH) { return c.fail("expression too deep"); }
+    return true;
+} // END: Breakpoints::Compile()
+
+
+Word Breakpoints::Evaluate(const std::vector<Byte>& code)
+{
+    C6809* cpu = Bus::GetC6809();
+    Word stack[STACK_DEPTH];
+    int sp = 0;
+    for (size_t pc = 0; pc < code.size(); )
+    {
+        Byte op = code[pc++];
+        switch (op)
+        {
+            case OP_CONST:  stack[sp++] = (Word)((code[pc] << 8) | code[pc + 1]); pc += 2; break;
+            case OP_REG:
+                switch (code[pc++])
+                {
+                    case REG_A:  stack[sp++] = cpu->getA();  break;
+                    case REG_B:  stack[sp++] = cpu->getB();  break;
+                    case REG_D:  stack[sp++] = cpu->getD();  break;
+                    case REG_X:  stack[sp++] = cpu->getX();  break;
+                    case REG_Y:  stack[sp++] = cpu->getY();  break;
+                    case REG_U:  stack[sp++] = cpu->getU();  break;
+                    case REG_S:  stack[sp++] = cpu->getS();  break;
+                    case REG_PC: stack[sp++] = cpu->getPC(); break;
+                    case REG_DP: stack[sp++] = cpu->getDP(); break;
+                    default:     stack[sp++] = cpu->getCC(); break;
+                }
+                break;
+            case OP_PEEK8:  stack[sp - 1] = Memory::Peek(stack[sp - 1]); break;
+            case OP_PEEK16: stack[sp - 1] = (Word)((Memory::Peek(stack[sp - 1]) << 8) | Memory::Peek((Word)(stack[sp - 1] + 1))); break;
+            default:
+            {
+                Word b = stack[--sp];
+                Word a = stack[sp - 1];
+                Word r = 0;
+                switch (op)
+                {
+                    case OP_EQ:   r = a == b; break;
+                    case OP_NE:   r = a != b; break;
+                    case OP_LT:   r = a <  b; break;
+                    case OP_LE:   r = a <= b; break;
+                    case OP_GT:   r = a >  b; break;
+                    case OP_GE:   r = a >= b; break;
+                    case OP_AND:  r = a & b;  break;
+                    case OP_LAND: r = a && b; break;
+                    default:      r = a || b; break;
+                }
+                stack[sp - 1] = r;
+            }
+        }
+    }
+    return sp ? stack[sp - 1] : 1;
+} // END: Breakpoints::Evaluate()
+
+
+// END: Breakpoints.cpp
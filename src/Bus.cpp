@@ -22,13 +22,17 @@
 #include "UnitTest.hpp"
 #include "Kernel_Rom.hpp"
 #include "GPU.hpp"
+#include "GPU_EXT.hpp"
+#include "SYS_EXT.hpp"
 #include "MMU.hpp"
 #include "Debug.hpp"
+#include "GdbStub.hpp"
 #include "C6809.hpp"
 #include "Mouse.hpp"
 #include "Keyboard.hpp"
 #include "Joystick.hpp"
 #include "FileIO.hpp"
+#include "FIO_EXT.hpp"
 #include "Math.hpp"
 
 
@@ -158,19 +162,32 @@ bool Bus::Run()
                 // no longer dirty
                 Bus::IsDirty(false);           
             }
+            // skip composing this frame when the host is falling behind
+            _pSYS_EXT->BeginFrame();
+
             // update all of the attached devices
             _onUpdate();
             
             // dispatch SDL events to the devices
             _onEvent();
             
-            // render all of the devices to the screen buffers
-            _onRender();      
+            if (!_pSYS_EXT->IsSkipping())
+            {
+                // render all of the devices to the screen buffers
+                _onRender();      
+                _pSYS_EXT->EndRender();
 
-            // only present for GfxCore            
-            if (_pGPU) { _pGPU->RenderPresent(); }
+                // only present for GfxCore            
+                if (_pGPU) { _pGPU->RenderPresent(); }
+            }
+            else if (_pGPU)
+            {
+                // a capture stream still needs a frame for every 1/70 s
+                _pGPU->CaptureSkippedFrame();
+            }
 
-            SDL_Delay(1);
+            // wait for the next 70 Hz frame
+            _pSYS_EXT->PaceFrame();
         }
         // shutdown the environment
         _onDeactivate();    
@@ -243,6 +260,11 @@ void Bus::_onInit()
     Memory::Attach<FileIO>();
     Memory::Attach<Math>();
     Memory::Attach<MMU>();
+    // the extended devices are attached after the core devices so the core
+    // register addresses remain unchanged for the existing kernel
+    _pGPU_EXT = Memory::Attach<GPU_EXT>();
+    _pSYS_EXT = Memory::Attach<SYS_EXT>();
+    Memory::Attach<FIO_EXT>();
 
     Memory::Attach<HDW_RESERVED>();     // reserved space for future use
     Memory::Attach<ROM_VECTS>();        // 0xFFF0 - 0xFFFF      (System ROM Vectors)
@@ -259,6 +281,10 @@ void Bus::_onInit()
     // Generate the Device Map
     Memory::Generate_Device_Map();
 
+    // headless builds still create the debugger window and receive
+    // events, so use a video driver that needs no display server
+    if (GPU_HEADLESS) { SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen"); }
+
     // initialize the devices
     _memory.OnInit();
 
@@ -284,6 +310,13 @@ void Bus::_onInit()
 		std::cout << e.what() << std::endl;
 	}
 
+    // the remote debugger needs the CPU and stops before it goes away
+    if (GDB_STUB || std::string(GDB_STUB_SOCKET).size())
+    {
+        s_gdb = new GdbStub();
+        s_gdb->Start(GDB_STUB, GDB_STUB_SOCKET);
+    }
+
     // cleanup and return
     std::cout << clr::indent_pop() << clr::CYAN << "Bus::_onInit() Exit" << clr::RETURN;
 
@@ -302,6 +335,12 @@ void Bus::_onQuit()
     // check if the bus is initialized
     if (_bWasInit)   
     { 
+        // shutdown the remote debugger
+        if (s_gdb)
+        {
+            delete s_gdb;
+            s_gdb = nullptr;
+        }
         // shutdown the CPU thread
         if (s_cpuThread.joinable())
             s_cpuThread.join();
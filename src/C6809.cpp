@@ -23,6 +23,7 @@
 #include "Bus.hpp"
 #include "C6809.hpp"
 #include "Debug.hpp"
+#include "GPU_EXT.hpp"
 
 C6809::C6809(Bus* p_bus) : A(acc.byte.A = 0), B(acc.byte.B = 0), D(acc.D = 0)
 {
@@ -52,6 +53,7 @@ void C6809::ThreadProc()
 {
     C6809* cpu = Bus::GetC6809();
     cpu->reset();
+    cpu->PublishState();
     // std::this_thread::sleep_for(std::chrono::microseconds(1000));
     // 
     {
@@ -63,6 +65,9 @@ void C6809::ThreadProc()
 
     // Variables to measure frequency
     int callCount = 0; // Counts the number of calls to `clock_input`
+    int slice = 0;     // clocks since the last PublishState()
+    int hz_speed = -1; // the speed setting cpu_hz was computed for
+    int cpu_hz = 0;    // emulated clock rate handed to the raster beam
     auto startMeasure = std::chrono::steady_clock::now(); // Start time for measurement
 
 
@@ -97,14 +102,33 @@ void C6809::ThreadProc()
 			case 0x0E: cycle_time =     250.00; break;		// 4000 khz
 			case 0x0F: cycle_time =       0.00; break;		// Unmetered  
 		}
+		// the raster beam follows emulated (not host) time; unmetered
+		// speeds use the last measured frequency
+		if (cpu_speed != hz_speed)
+		{
+			hz_speed = cpu_speed;
+			cpu_hz = (cycle_time > 0.0) ? (int)(1'000'000'000.0 / cycle_time) : std::max(1, (int)_cpu_speed) * 1000;
+		}
 		if (duration.count() > cycle_time*1000.0)
 		{
 			before_CPU = clock::now();
 			if (s_bCpuEnabled)
 			{
-				Bus::GetC6809()->clock_input();
+				bool ran = Bus::GetC6809()->clock_input();
 				// Increment call counter
 				callCount++;                
+
+				// publish the registers for the debugger once per slice, and
+				// on every clock while it holds the CPU so edits show at once
+				if (++slice >= STATE_SLICE || Bus::GetDebug()->IsStopped())
+				{
+					cpu->PublishState();
+					slice = 0;
+				}
+
+				// the beam stands still while the debugger holds the CPU
+				if (ran)
+					Bus::GetGPU_EXT()->RasterClock(cpu_hz);
 			}				
 		}
 
@@ -118,6 +142,7 @@ void C6809::ThreadProc()
 
 			// Bus::SetCpuSpeed((Word)(frequency / 1000.0));
 			_cpu_speed = (Word)(frequency / 1000.0);
+			if (cpu_speed == 0x0F) { hz_speed = -1; }	// re-read the measured rate
 
             // Reset counter and start time
             callCount = 0;
@@ -130,10 +155,50 @@ void C6809::ThreadProc()
 
 
 
-void C6809::clock_input()
+void C6809::PublishState()
+{
+	Uint32 seq = _state_seq.load(std::memory_order_relaxed);
+	_state_seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	_state[0].store(PC, std::memory_order_relaxed);
+	_state[1].store(op_pc, std::memory_order_relaxed);
+	_state[2].store(X, std::memory_order_relaxed);
+	_state[3].store(Y, std::memory_order_relaxed);
+	_state[4].store(U, std::memory_order_relaxed);
+	_state[5].store(S, std::memory_order_relaxed);
+	_state[6].store(D, std::memory_order_relaxed);
+	_state[7].store((Word)((DP << 8) | CC.all), std::memory_order_relaxed);
+	_state_seq.store(seq + 2, std::memory_order_release);
+}
+
+
+C6809::CPU_STATE C6809::GetState() const
+{
+	CPU_STATE st;
+	Uint32 before, after;
+	do {
+		before = _state_seq.load(std::memory_order_acquire);
+		st.pc = _state[0].load(std::memory_order_relaxed);
+		st.op_pc = _state[1].load(std::memory_order_relaxed);
+		st.x = _state[2].load(std::memory_order_relaxed);
+		st.y = _state[3].load(std::memory_order_relaxed);
+		st.u = _state[4].load(std::memory_order_relaxed);
+		st.s = _state[5].load(std::memory_order_relaxed);
+		Word d = _state[6].load(std::memory_order_relaxed);
+		Word dp_cc = _state[7].load(std::memory_order_relaxed);
+		st.a = (Byte)(d >> 8);
+		st.b = (Byte)d;
+		st.dp = (Byte)(dp_cc >> 8);
+		st.cc = (Byte)dp_cc;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = _state_seq.load(std::memory_order_relaxed);
+	} while (before != after || (before & 1));
+	return st;
+}
+
+
+bool C6809::clock_input()
 {
-    // std::unique_lock<std::mutex> lock(_register_mutex);
-
     Debug* debug = Bus::GetDebug();
 
 	// if (s_bHalted)	return;
@@ -147,6 +212,7 @@ void C6809::clock_input()
 			{
                 // Mark the current address as visited before reading the opcode
                 SetVisited_Memory(PC);  // Update bitfield for current PC address
+				op_pc = PC;
 
 				// read the opcode
 				opcode = read(PC);
@@ -165,19 +231,19 @@ void C6809::clock_input()
 				{
 					std::string er = "Invalid Instruction at $";
 					er += C6809::hex(PC, 4);
-                    // lock.unlock();
 					Bus::Error(er.c_str(), __FILE__, __LINE__);
 				}
 				if (!waiting_cwai && !waiting_sync)
                 {
-                    // lock.unlock();  // without this unlock the app will hang
 				 	debug->ContinueSingleStep();
                 }
-				return;
+				return true;
 			}
 			cycles--;
 		}
+		return true;
 	}
+	return false;	// held by the debugger
 }
 
 void C6809::nmi() {
@@ -1579,18 +1645,18 @@ std::string C6809::disasm(Word addr, Word& next)
 	std::string sOperand = "";
 
 	// fetch the opcode (one or two bytes)
-	Word opcode = read(addr);
+	Word opcode = debug_read(addr);
 	Word ofs = 1;
 	if (opcode == 0x10 || opcode == 0x11) {
 		opcode <<= 8;
-		opcode |= read(addr + 1);
+		opcode |= debug_read(addr + 1);
 		ofs++;
 	}
 	// post the operation bytes
 	Byte length = opMap[opcode].size;
 	for (int t = 0; t < length; t++)
 	{
-		Byte data = read(addr + t);
+		Byte data = debug_read(addr + t);
 		sOperation += hex(data, 2);
         sOperation += " ";
 	}
@@ -1602,7 +1668,7 @@ std::string C6809::disasm(Word addr, Word& next)
 	}
 	// 8-bit immediate
 	else if (opMap[opcode].addrmode == &C6809::immb) {
-		//sOperand += hex(read(addr), 2);
+		//sOperand += hex(debug_read(addr), 2);
 
 		// handle special case opcodes: EXG, TFR, PSH, and PUL
 		if (opcode == 0x001e || opcode == 0x001f)
@@ -1610,7 +1676,7 @@ std::string C6809::disasm(Word addr, Word& next)
 			std::map<Byte, std::string> R;
 			R[0x00] = "D";  R[0x01] = "X"; R[0x02] = "Y"; R[0x03] = "U";  R[0x04] = "S";
 			R[0x05] = "PC"; R[0x08] = "A"; R[0x09] = "B"; R[0x0a] = "CC"; R[0x0b] = "DP";
-			Byte data = read(addr++);
+			Byte data = debug_read(addr++);
 			std::string src = R[data >> 4];
 			std::string dst = R[data & 0x0f];
 			sOperand += src + "," + dst;
@@ -1620,7 +1686,7 @@ std::string C6809::disasm(Word addr, Word& next)
 			std::map<Byte, std::string> R;
 			R[0x01] = "CC"; R[0x02] = "A"; R[0x04] = "B";  R[0x08] = "DP";
 			R[0x10] = "X"; 	R[0x20] = "Y"; R[0x40] = "S"; R[0x80] = "PC";
-			Byte data = read(addr++);
+			Byte data = debug_read(addr++);
 			for (int bit = 0; bit < 8; bit++)
 			{
 				if (data & (1 << bit))
@@ -1633,31 +1699,31 @@ std::string C6809::disasm(Word addr, Word& next)
 		}
 		else
 		{	// Otherwise, Immediate (8-bit) has a single post byte #$
-			sOperand += "#$" + hex(read(addr), 2); addr++;
+			sOperand += "#$" + hex(debug_read(addr), 2); addr++;
 		}
 	}
 	// 16-bit immediate
 	else if (opMap[opcode].addrmode == &C6809::immw) {
-		sOperand += "#$" + hex(read(addr), 2); addr++;
-		sOperand += hex(read(addr), 2); addr++;
+		sOperand += "#$" + hex(debug_read(addr), 2); addr++;
+		sOperand += hex(debug_read(addr), 2); addr++;
 	}
 	// extended
 	else if (opMap[opcode].addrmode == &C6809::ext) {
 		// Extended has two post bytes $
-		sOperand += "$" + hex(read(addr), 2); addr++;
-		sOperand += hex(read(addr), 2); addr++;
+		sOperand += "$" + hex(debug_read(addr), 2); addr++;
+		sOperand += hex(debug_read(addr), 2); addr++;
 	}
 	// direct
 	else if (opMap[opcode].addrmode == &C6809::dir) {
 		// Direct has an 8-bit post byte (is added with the DP register)
-		sOperand += "$" + hex(read(addr), 2); addr++;
+		sOperand += "$" + hex(debug_read(addr), 2); addr++;
 	}
 	// indexed
 	else if (opMap[opcode].addrmode == &C6809::idx) {
-		Byte post = read(addr);
-		sOperation += hex(read(addr + 1), 2);
+		Byte post = debug_read(addr);
+		sOperation += hex(debug_read(addr + 1), 2);
         sOperation += " ";
-		sOperation += hex(read(addr + 2), 2);
+		sOperation += hex(debug_read(addr + 2), 2);
 		addr++;
 
 		std::string regs[] = { "X", "Y", "U", "S" };
@@ -1706,16 +1772,16 @@ std::string C6809::disasm(Word addr, Word& next)
 				sOperand += "[A," + regs[rInd] + "]";
 				break;
 			case 0x08:					// <8-bit>,R
-				sOperand += "$" + hex(read(addr), 2) + "," + regs[rInd]; addr++;
+				sOperand += "$" + hex(debug_read(addr), 2) + "," + regs[rInd]; addr++;
 				break;
 			case 0x18:					// [<8-bit>,R]
-				sOperand += "[$" + hex(read(addr), 2) + "," + regs[rInd] + "]"; addr++;
+				sOperand += "[$" + hex(debug_read(addr), 2) + "," + regs[rInd] + "]"; addr++;
 				break;
 			case 0x09:					// <16-bit>,R
-				sOperand += "$" + hex(read_word(addr), 4) + "," + regs[rInd]; addr += 2;
+				sOperand += "$" + hex(debug_read_word(addr), 4) + "," + regs[rInd]; addr += 2;
 				break;
 			case 0x19:					// [<16-bit>,R]
-				sOperand += "[$" + hex(read_word(addr), 4) + "," + regs[rInd] + "]"; addr += 2;
+				sOperand += "[$" + hex(debug_read_word(addr), 4) + "," + regs[rInd] + "]"; addr += 2;
 				break;
 			case 0x0b:					// D,R
 				sOperand += "D," + regs[rInd];
@@ -1724,19 +1790,19 @@ std::string C6809::disasm(Word addr, Word& next)
 				sOperand += "[D," + regs[rInd] + "]";
 				break;
 			case 0x0c:					// <8-bit>,PC
-				sOperand += "$" + hex(read(addr), 2) + ",PC"; addr++;
+				sOperand += "$" + hex(debug_read(addr), 2) + ",PC"; addr++;
 				break;
 			case 0x1c:					// [<8-bit>,PC]
-				sOperand += "[$" + hex(read(addr), 2) + ",PC]"; addr++;
+				sOperand += "[$" + hex(debug_read(addr), 2) + ",PC]"; addr++;
 				break;
 			case 0x0d:					// <16-bit>,PC
-				sOperand += "$" + hex(read_word(addr), 4) + ",PC"; addr += 2;
+				sOperand += "$" + hex(debug_read_word(addr), 4) + ",PC"; addr += 2;
 				break;
 			case 0x1d:					// [<16-bit>,PC]
-				sOperand += "[$" + hex(read_word(addr), 4) + ",PC]"; addr += 2;
+				sOperand += "[$" + hex(debug_read_word(addr), 4) + ",PC]"; addr += 2;
 				break;
 			case 0x1f:					// [address]
-				sOperand += "[$" + hex(read_word(addr), 4) + "]"; addr += 2;
+				sOperand += "[$" + hex(debug_read_word(addr), 4) + "]"; addr += 2;
 				break;
 			default:
 				sOperand += "<ERROR>";
@@ -1745,12 +1811,12 @@ std::string C6809::disasm(Word addr, Word& next)
 	}
 	// 8-bit relative
 	else if (opMap[opcode].addrmode == &C6809::relb) {
-		Word ofs = addr + (char)ext8(read(addr)); addr++;
+		Word ofs = addr + (char)ext8(debug_read(addr)); addr++;
 		sOperand += "$" + hex(ofs + 1, 4);
 	}
 	// 16-bit relative
 	else if (opMap[opcode].addrmode == &C6809::relw) {
-		Word ofs = addr + (int)read_word(addr) + 1; addr += 2;
+		Word ofs = addr + (int)debug_read_word(addr) + 1; addr += 2;
 		sOperand += "$" + hex(ofs + 1, 4);
 	}
 
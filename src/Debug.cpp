@@ -13,12 +13,17 @@
  * 
  ************************************/
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <deque>
 #include "Debug.hpp"
 #include "Bus.hpp"
 #include "GPU.hpp"
 #include "Memory.hpp"
 #include "C6809.hpp"
+#include "GdbStub.hpp"
+#include "SYS_EXT.hpp"
 
 
 
@@ -160,7 +165,7 @@ int  Debug::OnAttach(int nextAddr)
             (s_bIsDebugActive) ? _dbg_flags |= DBGF_DEBUG_ENABLE : _dbg_flags &= ~DBGF_DEBUG_ENABLE; // Enable
             (s_bSingleStep)     ? _dbg_flags |= DBGF_SINGLE_STEP_ENABLE : _dbg_flags &= ~DBGF_SINGLE_STEP_ENABLE; // Single-Step
             _dbg_flags &= ~DBGF_CLEAR_ALL_BRKPT;     // zero for Clear all Breakpoints
-            (mapBreakpoints[_dbg_brk_addr]) ? _dbg_flags |= DBGF_UPDATE_BRKPT : _dbg_flags &= ~DBGF_UPDATE_BRKPT;
+            (_breakpoints.Test(_dbg_brk_addr)) ? _dbg_flags |= DBGF_UPDATE_BRKPT : _dbg_flags &= ~DBGF_UPDATE_BRKPT;
             _dbg_flags &= ~DBGF_FIRQ;     // FIRQ
             _dbg_flags &= ~DBGF_IRQ;     // IRQ
             _dbg_flags &= ~DBGF_NMI;     // NMI
@@ -172,26 +177,16 @@ int  Debug::OnAttach(int nextAddr)
             (void)nextAddr; 
             _dbg_flags = data;
 
-            if (_dbg_flags & DBGF_DEBUG_ENABLE) { s_bIsDebugActive = true; SDL_ShowWindow(_dbg_window); }
-            else { s_bIsDebugActive = false; SDL_HideWindow(_dbg_window); }
+            s_bIsDebugActive = (_dbg_flags & DBGF_DEBUG_ENABLE) != 0;
             (_dbg_flags & DBGF_SINGLE_STEP_ENABLE) ? s_bSingleStep = true : s_bSingleStep = false;
             if (_dbg_flags & DBGF_CLEAR_ALL_BRKPT)  cbClearBreaks();
-            (_dbg_flags & DBGF_UPDATE_BRKPT) ? mapBreakpoints[_dbg_brk_addr] = true : mapBreakpoints[_dbg_brk_addr] = false;
+            _breakpoints.Set(_dbg_brk_addr, _dbg_flags & DBGF_UPDATE_BRKPT);
             if (_dbg_flags & DBGF_FIRQ)   cbFIRQ();
             if (_dbg_flags & DBGF_IRQ)   cbIRQ();
             if (_dbg_flags & DBGF_NMI)   cbNMI();
             if (_dbg_flags & DBGF_RESET)   cbReset();
-            // activate or deactivate the debugger
-            if (s_bIsDebugActive)   // activate the debugger
-            {
-                SDL_ShowWindow( Bus::GetGPU()->GetWindow() );
-                SDL_RaiseWindow( _dbg_window );
-            }
-            else                    // deactivate the debugger     
-            {      
-                SDL_HideWindow(_dbg_window);
-                SDL_RaiseWindow(Bus::GetGPU()->GetWindow());
-            }    
+            // activate or deactivate the debugger (from the main thread)
+            _window_request = s_bIsDebugActive ? WINDOW_SHOW : WINDOW_HIDE;
         },  
         {  
             "(Byte) Debug Specific Hardware Flags:",
@@ -259,6 +254,7 @@ void Debug::OnInit()
         SDL_TEXTUREACCESS_STREAMING, 
         _dbg_width, _dbg_height);
     SDL_SetTextureScaleMode(_dbg_texture, SDL_SCALEMODE_NEAREST);        
+    _db_redraw_all = true;
 
     // create the character buffer
     _db_bfr.clear();
@@ -276,8 +272,17 @@ void Debug::OnInit()
         c.chr = ' ';
     }
 
-    // get the keybuffer
-    keybfr = SDL_GetKeyboardState(NULL);
+    // get the keybuffer (as sampled for the UI thread)
+    keybfr = _input.keys.data();
+
+    // symbols for the disassembly and breakpoint conditions; the listing
+    // and the map sort labels from constants, so they load before the .sym
+    _symbols.Clear();
+    _symbols.LoadMap(MEMORY_MAP_OUTPUT_FILE_ASM);
+    _symbols.LoadListing(KERNEL_LISTING_FILENAME);
+    _symbols.LoadSym(KERNEL_SYMBOL_FILENAME);
+    _breakpoints.SetSymbols(&_symbols);
+    std::cout << clr::indent() << "Loaded " << _symbols.Size() << " symbols" << clr::RETURN;
 
     std::cout << clr::indent() << clr::LT_BLUE << "Debug::OnInit() Exit" << clr::RETURN;
 }
@@ -314,7 +319,10 @@ void Debug::OnQuit()
 void Debug::OnActivate()
 {
     std::cout << clr::indent() << clr::LT_BLUE << "Debug::OnActivate() Entry" << clr::RETURN;
-  
+
+    // the debugger screen is composed on its own thread from here on
+    _ui_running = true;
+    _ui_thread = std::thread(&Debug::_ui_proc, this);
 
     std::cout << clr::indent() << clr::LT_BLUE << "Debug::OnActivate() Exit" << clr::RETURN;
 }
@@ -325,6 +333,9 @@ void Debug::OnDeactivate()
 {
     std::cout << clr::indent() << clr::LT_BLUE << "Debug::OnDeactivate() Entry" << clr::RETURN;
 
+    _ui_running = false;
+    if (_ui_thread.joinable()) { _ui_thread.join(); }
+
     std::cout << clr::indent() << clr::LT_BLUE << "Debug::OnDeactivate() Exit" << clr::RETURN;
 }
 
@@ -334,15 +345,22 @@ void Debug::OnEvent(SDL_Event* evnt)
     // if the debugger is not active, just return without doing anything
     if (s_bIsDebugActive == false) { return; }
 
-    switch (evnt->type) 
+    // window calls stay on the main thread; the rest is handled by the UI thread
+    if (evnt->type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) 
     {
-        // handle default events SDL_QUIT and ALT-X quits        
-        case SDL_EVENT_WINDOW_CLOSE_REQUESTED:  
-        {
-            SDL_MinimizeWindow(_dbg_window);
-            break;
-        }
+        SDL_MinimizeWindow(_dbg_window);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    _events.push_back(*evnt);
+}
+
 
+// UI thread: one event queued by OnEvent()
+void Debug::_handle_event(const SDL_Event* evnt)
+{
+    switch (evnt->type) 
+    {
         case SDL_EVENT_KEY_DOWN:
         {
             // if debugger is active
@@ -382,7 +400,7 @@ void Debug::OnEvent(SDL_Event* evnt)
                 }    
             }
             // if the debugger has focus ...
-            if (SDL_GetMouseFocus() == _dbg_window)
+            if (_input.focus)
             {
                 if (evnt->key.key == SDLK_SPACE)
                 {
@@ -393,6 +411,14 @@ void Debug::OnEvent(SDL_Event* evnt)
                 {
                     cbRunStop();
                 }
+                if (s_bSingleStep && evnt->key.key == SDLK_F10)
+                {
+                    cbStepOver();
+                }
+                if (s_bSingleStep && evnt->key.key == SDLK_F11)
+                {
+                    (evnt->key.mod & SDL_KMOD_SHIFT) ? cbStepOut() : cbStepIn();
+                }
             }
             
             break;
@@ -461,93 +487,303 @@ void Debug::OnEvent(SDL_Event* evnt)
 
 void Debug::OnUpdate(float fElapsedTime)
 {
+    (void)fElapsedTime;
+    _apply_window_request();
 
     // if the debugger is not active, just return
     if (!( _dbg_flags & DBGF_DEBUG_ENABLE))   { return; }   
 
-    // only update once every so often
-    const float delay = 1.0f / 30.0f;
-    static float delayAcc = fElapsedTime;
-    delayAcc += fElapsedTime;
-    if (delayAcc >= delay)
-    {
-        delayAcc -= delay;
+    // sample the input for the UI thread, which makes no SDL calls itself
+    INPUT_STATE in;
+    in.buttons = SDL_GetMouseState(&in.mouse_x, &in.mouse_y);
+    in.mod = SDL_GetModState();
+    SDL_GetWindowSize(_dbg_window, &in.window_width, &in.window_height);
+    in.focus = (SDL_GetMouseFocus() == _dbg_window);
+    int numkeys = 0;
+    const bool* keys = SDL_GetKeyboardState(&numkeys);
+    std::copy(keys, keys + std::min(numkeys, (int)in.keys.size()), in.keys.begin());
+
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    _input_next = in;
+}
 
-        // update internals
-        //_update_mouse_pos(); 
 
-        // render the debugger
-        // clear the text buffer
-        for (auto &c : _db_bfr)
+/**
+ * UI thread: wakes at 30 Hz, takes the queued events and the latest
+ * input sample, and composes and rasterizes the debugger screen from the
+ * CPU's register snapshot. _ui_mutex is held while it does, so OnRender()
+ * only uploads finished rows; it skips a frame rather than wait.
+ */
+void Debug::_ui_proc()
+{
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::microseconds(1'000'000 / 30);
+    auto last = clock::now();
+    while (_ui_running)
+    {
+        std::this_thread::sleep_until(last + period);
+        auto now = clock::now();
+        float fElapsedTime = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        std::vector<SDL_Event> events;
         {
-            c.attr = 0xf0;
-            c.chr = ' ';
+            std::lock_guard<std::mutex> lock(_input_mutex);
+            _input = _input_next;
+            events.swap(_events);
         }
+        if (!( _dbg_flags & DBGF_DEBUG_ENABLE))   { continue; }
 
-        // call update functions
-        MouseStuff();
-        KeyboardStuff();
+        std::lock_guard<std::mutex> lock(_ui_mutex);
+        for (auto& e : events) { _handle_event(&e); }
+        _ui_compose(fElapsedTime);
+    }
+} // END: Debug::_ui_proc()
 
-        DrawMemoryFrame(0,0);
-        DumpMemory(1,  1, mem_bank[0]);
-        DumpMemory(1, 10, mem_bank[1]);
-        DumpMemory(1, 19, mem_bank[2]);
-        DumpMemory(1, 28, mem_bank[3]);
 
-        DrawCpu(40, 1);     // was (39,1)
-        DrawCode(40, 7);    // was (39,6)
+void Debug::_ui_compose(float fElapsedTime)
+{
+    _cpu = Bus::GetC6809()->GetState();
 
-        DrawButtons();    
-        HandleButtons();
-        DrawBreakpoints();
+    // render the debugger
+    // clear the text buffer
+    for (auto &c : _db_bfr)
+    {
+        c.attr = 0xf0;
+        c.chr = ' ';
+    }
 
-        if (!EditRegister(fElapsedTime))
-            DrawCursor(fElapsedTime);
+    // call update functions
+    MouseStuff();
+    KeyboardStuff();
+
+    DrawMemoryFrame(0,0);
+    DumpMemory(1,  1, mem_bank[0]);
+    DumpMemory(1, 10, mem_bank[1]);
+    DumpMemory(1, 19, mem_bank[2]);
+    DumpMemory(1, 28, mem_bank[3]);
+
+    DrawCpu(40, 1);     // was (39,1)
+    DrawCode(40, 7);    // was (39,6)
+
+    DrawButtons();    
+    HandleButtons();
+    DrawBreakpoints();
+    DrawFrameTimes(40, 51);
+    DrawWatchHit(40, 54);
+
+    if (!EditRegister(fElapsedTime))
+        DrawCursor(fElapsedTime);
+
+    // instruction text
+    OutText(1, 51, "[SPACE] - SingleStep", 0x80);
+    OutText(1, 52, "[ALT-X] - Quit", 0x80);
+    OutText(1, 53, "[ALT-D] - Toggle Debug", 0x80);
+    OutText(1, 54, "[ALT-R] - Run / Stop", 0x80);
+    OutText(1, 55, "[F10/F11] - Step Over / Into", 0x80);
+    OutText(1, 56, "[SHIFT-F11] - Step Out", 0x80);
+    OutText(1, 57, "[MIDDLE CLICK] - Run to Line", 0x80);
+
+    // TESTING ...
+        int mx, my;
+        int row = 47;
+        _correct_mouse_coords(mx, my);
+
+        std::string s = "Mouse          - X: " + std::to_string(mx) + " Y: " + std::to_string(my);
+        OutText(1, row++, s, 0x80);
+
+        std::string q = "Window -- width: " + std::to_string(_dbg_window_width) + " height: " + std::to_string(_dbg_window_height);
+        OutText(1, row++, q, 0x80);
+
+        std::string r = "s_bSingleStep: " + std::to_string(s_bSingleStep);
+        OutText(1, row++, r, 0x80);
+
+        row = 47;
+        auto peek_word = [](Word a) { return (Memory::Peek(a) << 8) | Memory::Peek(a + 1); };
+        std::string p = "Width: " + std::to_string(peek_word(MAP(GPU_HRES))) + " Height: " + std::to_string(peek_word(MAP(GPU_VRES)));
+        OutText(40, row++, p, 0x80);
+        std::string t = "MX: " + std::to_string(peek_word(MAP(CSR_XPOS))) + " MY: " + std::to_string(peek_word(MAP(CSR_YPOS)));
+        OutText(40, row++, t, 0x80);
+
+        std::string opt = "GPU_OPTIONS: ";
+        // if (Memory::Read(MAP(GPU_OPTIONS)) & 0x02)
+        if (Memory::Peek(MAP(GPU_MODE_MSB)) & 0x01)
+            opt += "Letterbox";
+        else
+            opt += "Stretch / Overscan";
+        OutText(40, row++, opt, 0x80);
 
-        // instruction text
-        OutText(1, 51, "[SPACE] - SingleStep", 0x80);
-        OutText(1, 52, "[ALT-X] - Quit", 0x80);
-        OutText(1, 53, "[ALT-D] - Toggle Debug", 0x80);
-        OutText(1, 54, "[ALT-R] - Run / Stop", 0x80);
 
-        // TESTING ...
-            int mx, my;
-            int row = 47;
-            _correct_mouse_coords(mx, my);
+    // END: ... TESTING
 
-            std::string s = "Mouse          - X: " + std::to_string(mx) + " Y: " + std::to_string(my);
-            OutText(1, row++, s, 0x80);
 
-            std::string q = "Window -- width: " + std::to_string(_dbg_window_width) + " height: " + std::to_string(_dbg_window_height);
-            OutText(1, row++, q, 0x80);
+    // _clear_texture(_dbg_texture, rand()%15, rand()%15, rand()%15, 15);
+    _update_debug_screen();
+} // END: Debug::_ui_compose()
 
-            std::string r = "s_bSingleStep: " + std::to_string(s_bSingleStep);
-            OutText(1, row++, r, 0x80);
 
-            row = 47;
-            std::string p = "Width: " + std::to_string(Memory::Read_Word(MAP(GPU_HRES))) + " Height: " + std::to_string(Memory::Read_Word(MAP(GPU_VRES)));
-            OutText(40, row++, p, 0x80);
-            std::string t = "MX: " + std::to_string(Memory::Read_Word(MAP(CSR_XPOS))) + " MY: " + std::to_string(Memory::Read_Word(MAP(CSR_YPOS)));
-            OutText(40, row++, t, 0x80);
+bool Debug::OnTest()
+{
+    bool test_results = true;
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Breakpoints" + clr::RESET);
+
+    // a private table so the tests leave the user's breakpoints alone
+    Breakpoints bp;
+    std::string error;
+
+    // conditions peek at memory, so SYS_DBG_BRK_ADDR serves as the operand
+    std::vector<Byte> code;
+    Word operand = MAP(SYS_DBG_BRK_ADDR);
+    Word saved_addr = _dbg_brk_addr;
+    std::string cond = "{$" + _hex(operand, 4) + "} == $1234 && ($5A & 0x0F) == 10";
+    _dbg_brk_addr = 0x1234;
+    bool taken = Breakpoints::Compile(cond, code, error) && Breakpoints::Evaluate(code) != 0;
+    _dbg_brk_addr = 0x1235;
+    bool not_taken = Breakpoints::Evaluate(code) == 0;
+    if (!ASSERT_TRUE(taken && not_taken)) {
+        UnitTest::Log(this, clr::RED + "condition \"" + cond + "\" evaluated incorrectly " + error);
+        test_results = false;
+    }
+    if (!ASSERT_TRUE(!Breakpoints::Compile("X == ", code, error) && !Breakpoints::Compile("$10000", code, error) &&
+                     !Breakpoints::Compile("(A == 1", code, error) && !Breakpoints::Compile("Q", code, error))) {
+        UnitTest::Log(this, clr::RED + "invalid conditions were accepted");
+        test_results = false;
+    }
+
+    // the bitset, the ignore count and the hit count
+    bp.Set(0x1000, true);
+    bp.Set(0xFFFF, true);
+    bp.SetIgnore(0x1000, 2);
+    bool first = bp.Hit(0x1000), second = bp.Hit(0x1000), third = bp.Hit(0x1000);
+    Breakpoints::BREAKPOINT info;
+    bp.Info(0x1000, info);
+    if (!ASSERT_TRUE(bp.Test(0x1000) && bp.Test(0xFFFF) && !bp.Test(0x1001) &&
+                     !first && !second && third && info.hits == 3)) {
+        UnitTest::Log(this, clr::RED + "ignore or hit counts are wrong");
+        test_results = false;
+    }
+    // a false condition neither stops nor counts
+    bool cond_ok = bp.SetCondition(0xFFFF, "$01 == 2", error);
+    bool stopped = bp.Hit(0xFFFF);
+    bp.Info(0xFFFF, info);
+    if (!ASSERT_TRUE(cond_ok && !stopped && info.hits == 0 && !bp.SetCondition(0xFFFF, "1 ==", error))) {
+        UnitTest::Log(this, clr::RED + "conditional breakpoint failed");
+        test_results = false;
+    }
+    bp.Toggle(0x1000);
+    std::vector<Word> left = bp.Addresses();
+    bp.Clear();
+    if (!ASSERT_TRUE(left.size() == 1 && left[0] == 0xFFFF && !bp.Test(0xFFFF) && bp.Addresses().empty())) {
+        UnitTest::Log(this, clr::RED + "breakpoint toggle or clear failed");
+        test_results = false;
+    }
 
-            std::string opt = "GPU_OPTIONS: ";
-            // if (Memory::Read(MAP(GPU_OPTIONS)) & 0x02)
-            if (Memory::Read(MAP(GPU_MODE_MSB)) & 0x01)
-                opt += "Letterbox";
-            else
-                opt += "Stretch / Overscan";
-            OutText(40, row++, opt, 0x80);
 
+    // watched accesses still reach the device; accesses made off the CPU
+    // thread (like these) never stop it
+    Word reg = MAP(SYS_DBG_BRK_ADDR);
+    AddWatch(reg, reg + 1, Memory::WATCH_READ | Memory::WATCH_WRITE);
+    AddWatch(reg + 1, reg + 1, Memory::WATCH_CHANGE);
+    Memory::Write_Word(reg, (Word)0xBEEF);
+    Word read_back = Memory::Read_Word(reg);
+    Byte flags_lsb = Memory::Watched(reg + 1);
+    RemoveWatch(reg, reg + 1, Memory::WATCH_READ);
+    Byte flags_msb = Memory::Watched(reg);
+    ClearWatches();
+    WATCH_HIT hit;
+    if (!ASSERT_TRUE(read_back == 0xBEEF && _dbg_brk_addr == 0xBEEF &&
+                     flags_lsb == (Memory::WATCH_READ | Memory::WATCH_WRITE | Memory::WATCH_CHANGE) &&
+                     flags_msb == Memory::WATCH_WRITE && Memory::Watched(reg) == 0 &&
+                     !_watch_stop.load() && !LastWatchHit(hit))) {
+        UnitTest::Log(this, clr::RED + "watchpoint flags or the watched access path failed");
+        test_results = false;
+    }
 
-        // END: ... TESTING
+    // symbols: lookups on a private table, then the loaded kernel names
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Symbols" + clr::RESET);
+    Symbols sym;
+    sym.Add("TABLE", 0x2000, Symbols::SYM_LABEL);
+    sym.Add("PORT", 0xFE00, Symbols::SYM_ADDRESS);
+    sym.Add("PORT_DATA", 0xFE00, Symbols::SYM_ADDRESS);
+    sym.Add("COUNT", 0x0005, Symbols::SYM_CONST);
+    Word at = 0, count = 0, number = 0, bad = 0;
+    bool parsed = sym.Parse("TABLE + $10", at) && sym.Parse("COUNT", count) && sym.Parse("0x1234", number) &&
+                  !sym.Parse("NOPE", bad) && !sym.Parse("TABLE junk", bad);
+    if (!ASSERT_TRUE(parsed && at == 0x2010 && count == 5 && number == 0x1234 &&
+                     sym.Name(0x0005) == "" && sym.Name(0x2000) == "TABLE" &&
+                     sym.Name(0x2123) == "TABLE+$0123" && sym.Name(0xFE01) == "PORT_DATA+$01")) {
+        UnitTest::Log(this, clr::RED + "symbol lookup failed");
+        test_results = false;
+    }
+    bool named = Breakpoints::Compile("COUNT == 5 && TABLE > PORT", code, error, &sym) && Breakpoints::Evaluate(code) == 0 &&
+                 Breakpoints::Compile("COUNT == 5", code, error, &sym) && Breakpoints::Evaluate(code) != 0;
+    if (!ASSERT_TRUE(named && !Breakpoints::Compile("COUNT == 5", code, error))) {
+        UnitTest::Log(this, clr::RED + "symbols in breakpoint conditions failed " + error);
+        test_results = false;
+    }
+    Word krnl_start = 0, edit_buffer = 0;
+    if (_symbols.Value("KRNL_START", krnl_start))
+    {
+        const Symbols::SYMBOL* prompt = _symbols.Find(krnl_start + 3);
+        if (!ASSERT_TRUE(_symbols.Name(krnl_start) == "KRNL_START" && prompt && prompt->name == "KRNL_PROMPT0" &&
+                         _symbols.Value("EDT_BUFFER", edit_buffer) && _symbols.Name(edit_buffer + 2) == "EDT_BUFFER+$02" &&
+                         _symbols.Name(operand) == "SYS_DBG_BRK_ADDR" &&
+                         _symbolize(std::string(26, ' ') + "$05,X", 40) == std::string(26, ' ') + "$05,X")) {
+            UnitTest::Log(this, clr::RED + "the kernel listing or memory map loaded incorrectly");
+            test_results = false;
+        }
+    }
 
+    // gdb remote packets (without a connection)
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "GDB Remote Packets" + clr::RESET);
+    GdbStub gdb;
+    std::string regs, mem, brk, unbrk, mon;
+    _dbg_brk_addr = 0x6809;
+    gdb.Process("g", regs);
+    gdb.Process("m" + _hex(operand, 4) + ",2", mem);
+    gdb.Process("Z0,fff0,1", brk);
+    bool set = _breakpoints.Test(0xFFF0);
+    gdb.Process("z0,fff0,1", unbrk);
+    gdb.Process("qRcmd,73796d202446464630", mon);      // "monitor sym $FFF0"
+    // writes are refused unless the CPU is held (the same value is written back)
+    std::string poke;
+    gdb.Process("M" + _hex(operand, 4) + ",1:68", poke);
+    bool guarded = IsStopped() ? poke == "OK" : poke == "E01";
+    _dbg_brk_addr = saved_addr;
+    if (!ASSERT_TRUE(GdbStub::Frame("OK") == "$OK#9a" && regs.size() == GdbStub::REG_BYTES * 2 &&
+                     mem == "6809" && brk == "OK" && unbrk == "OK" && set && !_breakpoints.Test(0xFFF0) &&
+                     mon.rfind("2446464630", 0) == 0 && guarded)) {     // "$FFF0..."
+        UnitTest::Log(this, clr::RED + "gdb remote packet handling failed");
+        test_results = false;
+    }
 
-        // _clear_texture(_dbg_texture, rand()%15, rand()%15, rand()%15, 15);
+    // only cells that changed since the last update are redrawn
+    if (_dbg_texture)
+    {
+        UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Debug Screen" + clr::RESET);
+        D_GLYPH saved_cell = _db_bfr[0];
+        OutGlyph(0, 0, 0x8F, 0xA0);             // solid block in color $A
         _update_debug_screen();
-    } else {
-        // _clear_texture(_dbg_texture, 1, 2, 0, 15);
+        bool drawn = _db_pixels[0] == _debug_palette[0xA].color && _db_dirty[0].first == 0;
+        _upload_debug_screen();
+        _db_pixels[0] = 0;
+        _update_debug_screen();                 // unchanged, so the poked pixel stays
+        bool skipped = _db_pixels[0] == 0 && _db_dirty[0].second < 0;
+        _db_bfr[0] = saved_cell;
+        _update_debug_screen();
+        _upload_debug_screen();
+        if (!ASSERT_TRUE(drawn && skipped && _db_pixels[0] != 0)) {
+            UnitTest::Log(this, clr::RED + "debug screen cells were not redrawn incrementally");
+            test_results = false;
+        }
     }
-}
+
+    if (test_results)
+        UnitTest::Log(this, "Unit Tests PASSED");
+    else
+        UnitTest::Log(this, clr::RED + "Unit Tests FAILED");
+    return test_results;
+} // END: Debug::OnTest()
 
 
 void Debug::OnRender()
@@ -557,6 +793,11 @@ void Debug::OnRender()
 
     if (_dbg_renderer)
     {
+        // take the rows the UI thread has finished; while it is composing,
+        // present the previous ones
+        std::unique_lock<std::mutex> lock(_ui_mutex, std::try_to_lock);
+        if (lock.owns_lock()) { _upload_debug_screen(); }
+
         // clear the background
         SDL_SetRenderDrawColor(_dbg_renderer, 0, 0, 0, 255);
         SDL_RenderClear(_dbg_renderer);
@@ -666,74 +907,60 @@ void Debug::_clear_texture(SDL_Texture* texture, Byte r, Byte g, Byte b, Byte a)
 }
 
 
-void Debug::_setPixel_unlocked(void* pixels, int pitch, int x, int y, Byte palette_index)
-{
-    palette_index &= 0x0f;
-    Byte r = _debug_palette[palette_index].r;
-    Byte g = _debug_palette[palette_index].g;
-    Byte b = _debug_palette[palette_index].b;
-    Byte a = _debug_palette[palette_index].a;  
-    Uint16 *dst = (Uint16*)((Uint8*)pixels + (y * pitch) + (x*sizeof(Uint16)));
-    *dst = ( (a<<12) | (r<<8) | (g<<4) | (b<<0) );
-}
-
-
 void Debug::DrawCpu(int x, int y)
 {
-    C6809* cpu = Bus::GetC6809();
-
     int RamX = x, RamY = y;
     // Condition Codes
     RamX += OutText(RamX, RamY, "CC($", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getCC(), 2).c_str(), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.cc, 2).c_str(), 0xC0);
     RamX += OutText(RamX, RamY, "): ", 0xB0);
-    if (cpu->getCC_E())		RamX += OutText(RamX, RamY, "E", 0xC0);
+    if (_cpu.cc & 0x80)		RamX += OutText(RamX, RamY, "E", 0xC0);
     else RamX += OutText(RamX, RamY, "e", 0xB0);
-    if (cpu->getCC_F())		RamX += OutText(RamX, RamY, "F", 0xC0);
+    if (_cpu.cc & 0x40)		RamX += OutText(RamX, RamY, "F", 0xC0);
     else RamX += OutText(RamX, RamY, "f", 0xB0);
-    if (cpu->getCC_H())		RamX += OutText(RamX, RamY, "H", 0xC0);
+    if (_cpu.cc & 0x20)		RamX += OutText(RamX, RamY, "H", 0xC0);
     else RamX += OutText(RamX, RamY, "h", 0xB0);
-    if (cpu->getCC_I())		RamX += OutText(RamX, RamY, "I", 0xC0);
+    if (_cpu.cc & 0x10)		RamX += OutText(RamX, RamY, "I", 0xC0);
     else RamX += OutText(RamX, RamY, "i", 0xB0);
-    if (cpu->getCC_N())		RamX += OutText(RamX, RamY, "N", 0xC0);
+    if (_cpu.cc & 0x08)		RamX += OutText(RamX, RamY, "N", 0xC0);
     else RamX += OutText(RamX, RamY, "n", 0xB0);
-    if (cpu->getCC_Z())		RamX += OutText(RamX, RamY, "Z", 0xC0);
+    if (_cpu.cc & 0x04)		RamX += OutText(RamX, RamY, "Z", 0xC0);
     else RamX += OutText(RamX, RamY, "z", 0xB0);
-    if (cpu->getCC_V())		RamX += OutText(RamX, RamY, "V", 0xC0);
+    if (_cpu.cc & 0x02)		RamX += OutText(RamX, RamY, "V", 0xC0);
     else RamX += OutText(RamX, RamY, "v", 0xB0);
-    if (cpu->getCC_C())		RamX += OutText(RamX, RamY, "C", 0xC0);
+    if (_cpu.cc & 0x01)		RamX += OutText(RamX, RamY, "C", 0xC0);
     else RamX += OutText(RamX, RamY, "c", 0xB0);
     RamX = x; RamY++;	// carraige return(ish)
 
     // D = (A<<8) | B & 0x00FF
     RamX += OutText(RamX, RamY, " D:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getD(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.d(), 4), 0xC0);
     RamX += OutText(RamX, RamY, " A:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getA(), 2), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.a, 2), 0xC0);
     RamX += OutText(RamX, RamY, "   B:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getB(), 2), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.b, 2), 0xC0);
     // RamX += OutText(RamX, RamY, ")", 0xB0);
     RamX = x; RamY++;	// carraige return(ish)
 
     // X
     RamX += OutText(RamX, RamY, " X:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getX(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.x, 4), 0xC0);
     // Y
     RamX += OutText(RamX, RamY, " Y:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getY(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.y, 4), 0xC0);
     // U
     RamX += OutText(RamX, RamY, " U:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getU(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.u, 4), 0xC0);
     RamX = x; RamY++;	// carraige return(ish)
     // PC
     RamX += OutText(RamX, RamY, "PC:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getPC(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.pc, 4), 0xC0);
     // S
     RamX += OutText(RamX, RamY, " S:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getS(), 4), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.s, 4), 0xC0);
     // DP
     RamX += OutText(RamX, RamY, " DP:$", 0xB0);
-    RamX += OutText(RamX, RamY, _hex(cpu->getDP(), 2), 0xC0);
+    RamX += OutText(RamX, RamY, _hex(_cpu.dp, 2), 0xC0);
     RamX = x; RamY++;	// carraige return(ish)
 }
 
@@ -764,48 +991,104 @@ std::string Debug::_hex(Uint32 n, Uint8 d)
     return s;
 }
 
+/**
+ * Rasterizes the text buffer into _db_pixels (UI thread). Cells whose
+ * glyph and attribute match the shadow copy are skipped, and the span of
+ * changed cells on each text row is kept for _upload_debug_screen(). The
+ * glyph rows are cached as well; the font can be redefined through the
+ * GPU, and a change there redraws every cell.
+ */
 void Debug::_update_debug_screen() 
 {
-    void *pixels;
-    int pitch;
-
-    if (!SDL_LockTexture(_dbg_texture, NULL, &pixels, &pitch)) {
-        // SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't lock texture: %s\n", SDL_GetError());
-        Bus::Error(SDL_GetError(), __FILE__, __LINE__);
+    const int width = DEBUG_WIDTH / 8;
+    if (_db_shadow.size() != _db_bfr.size())
+    {
+        _db_shadow.assign(_db_bfr.size(), D_GLYPH{});
+        _db_pixels.assign(_dbg_width * _dbg_height, 0);
+        _db_dirty.assign(_db_bfr.size() / width, { width, -1 });
+        _db_redraw_all = true;
     }
-    else
+    for (int i = 0; i < 256 * 8; i++)
+    {
+        Byte gd = GPU::GetGlyphData(i >> 3, i & 7);
+        if (gd != _db_atlas[i]) {
+            _db_atlas[i] = gd;
+            _db_redraw_all = true;
+        }
+    }
+    Word lut[16];
+    for (int c = 0; c < 16; c++) { lut[c] = _debug_palette[c].color; }
+
+    int rows = (int)_db_bfr.size() / width;
+    for (int row = 0; row < rows; row++)
     {
-        Byte width = DEBUG_WIDTH / 8;
-        // int i=0;
-        Word i_size = _db_bfr.size();
-        for (Word i=0; i<i_size; i++)
+        int& first = _db_dirty[row].first;
+        int& last = _db_dirty[row].second;
+        for (int col = 0; col < width; col++)
         {
-            Byte ch = _db_bfr[i].chr;
-            Byte at = _db_bfr[i].attr;
-			Byte fg = at >> 4;
-			Byte bg = at & 0x0f;
-            int x = (i % width) * 8;
-            int y = (i / width) * 8;
-			for (int v = 0; v < 8; v++)
-			{
-				for (int h = 0; h < 8; h++)
-				{
-					int color = bg;
-                    Byte gd = GPU::GetGlyphData(ch, v);                    
-					if (gd & (1 << (7 - h)))
-						color = fg;
-					_setPixel_unlocked(pixels, pitch, x + h, y + v, color);
-				}
-			}
+            int i = row * width + col;
+            D_GLYPH& cell = _db_bfr[i];
+            D_GLYPH& shadow = _db_shadow[i];
+            if (!_db_redraw_all && cell.chr == shadow.chr && cell.attr == shadow.attr) { continue; }
+            shadow = cell;
+            first = std::min(first, col);
+            last = std::max(last, col);
+
+            Word fg = lut[cell.attr >> 4];
+            Word bg = lut[cell.attr & 0x0f];
+            const Byte* glyph = &_db_atlas[cell.chr * 8];
+            for (int v = 0; v < 8; v++)
+            {
+                Uint16* dst = &_db_pixels[(row * 8 + v) * _dbg_width + col * 8];
+                Byte gd = glyph[v];
+                for (int h = 0; h < 8; h++) {
+                    *dst++ = (gd & (0x80 >> h)) ? fg : bg;
+                }
+            }
         }
-        SDL_UnlockTexture(_dbg_texture); 
     }
-} 
+    _db_redraw_all = false;
+} // END: Debug::_update_debug_screen()
+
+
+// main thread, with _ui_mutex held: one sub-rect per changed text row
+void Debug::_upload_debug_screen()
+{
+    const int width = DEBUG_WIDTH / 8;
+    for (int row = 0; row < (int)_db_dirty.size(); row++)
+    {
+        auto& [first, last] = _db_dirty[row];
+        if (last < 0) { continue; }
+        SDL_Rect rect = { first * 8, row * 8, (last - first + 1) * 8, 8 };
+        if (!SDL_UpdateTexture(_dbg_texture, &rect, &_db_pixels[rect.y * _dbg_width + rect.x], _dbg_width * sizeof(Uint16))) {
+            Bus::Error(SDL_GetError(), __FILE__, __LINE__);
+        }
+        first = width;
+        last = -1;
+    }
+} // END: Debug::_upload_debug_screen()
+
+
+// main thread: window calls asked for by the register handlers and buttons
+void Debug::_apply_window_request()
+{
+    switch (_window_request.exchange(WINDOW_NONE))
+    {
+        case WINDOW_SHOW:
+            SDL_ShowWindow(Bus::GetGPU()->GetWindow());
+            SDL_ShowWindow(_dbg_window);
+            SDL_RaiseWindow(_dbg_window);
+            break;
+        case WINDOW_HIDE:
+            SDL_HideWindow(_dbg_window);
+            SDL_RaiseWindow(Bus::GetGPU()->GetWindow());
+            break;
+    }
+} // END: Debug::_apply_window_request()
 
 
 void Debug::DumpMemory(int col, int row, Word addr)
 {
-    const bool use_debug_read = false;
     int line = 0;
     int width = 8;
     for (int ofs = addr; ofs < addr + 0x40; ofs += 8)
@@ -813,7 +1096,7 @@ void Debug::DumpMemory(int col, int row, Word addr)
         int c = col;
         std::string out = _hex(ofs, 4) + " ";
         for (int b = 0; b < width; b++)
-            out += _hex(Memory::Read(ofs + b, use_debug_read), 2) + " ";
+            out += _hex(Memory::Peek(ofs + b), 2) + " ";
 
         c += OutText(col, row + line, out.c_str(), 0xe0);
 
@@ -823,7 +1106,7 @@ void Debug::DumpMemory(int col, int row, Word addr)
             for (int b = 0; b < width; b++)
             {
                 Byte data;
-                data = Memory::Read(ofs + b, use_debug_read);
+                data = Memory::Peek(ofs + b);
                 OutGlyph(c++, row + line, data, 0xd0);
             }
         }
@@ -859,7 +1142,7 @@ void Debug::MouseStuff()
     // C6809* cpu = Bus::GetC6809();
     int mx, my;
     _correct_mouse_coords(mx, my);
-    Uint32 btns = SDL_GetRelativeMouseState(NULL, NULL);
+    Uint32 btns = _input.buttons;
 
     // mouse wheel
     if (mouse_wheel)
@@ -884,7 +1167,7 @@ void Debug::MouseStuff()
             }
             s_bSingleStep = true;	// scrollwheel enters into single step mode
             nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
-            if ( (SDL_GetModState() & SDL_KMOD_CTRL) || (SDL_GetModState() & SDL_KMOD_SHIFT) )
+            if ( (_input.mod & SDL_KMOD_CTRL) || (_input.mod & SDL_KMOD_SHIFT) )
                 mousewheel_offset -= mouse_wheel * 1;	// fine scroll	
             else
                 mousewheel_offset -= mouse_wheel * 3;		// fast scroll
@@ -911,15 +1194,12 @@ void Debug::MouseStuff()
         {
             int index = (my - _bkp_window_ymin) + mw_brk_offset;
             // build a vector of active breakpoints
-            std::vector<Word> breakpoints;
-            for (auto& bp : mapBreakpoints)
-                if (bp.second)
-                    breakpoints.push_back(bp.first);
+            std::vector<Word> breakpoints = _breakpoints.Addresses();
             if (breakpoints.size() <= (size_t)_bkp_window_len ) { mw_brk_offset=0; }
             if ((unsigned)index < breakpoints.size())
             {
                 // printf("LEFT CLICK: $%04X\n", breakpoints[index]);
-                mapBreakpoints[breakpoints[index]] = false;
+                _breakpoints.Set(breakpoints[index], false);
             }
         }
         // click to select
@@ -973,9 +1253,7 @@ void Debug::MouseStuff()
             if (sDisplayedAsm[my - 7] >= 0)
             {
                 Word offset = sDisplayedAsm[my - 7];
-                (mapBreakpoints[offset]) ?
-                    mapBreakpoints[offset] = false :
-                    mapBreakpoints[offset] = true;
+                _breakpoints.Toggle(offset);
             }
         }
     }
@@ -989,14 +1267,11 @@ void Debug::MouseStuff()
         {
             int index = (my - 41) + mw_brk_offset;
             // build a vector of active breakpoints
-            std::vector<Word> breakpoints;
-            for (auto& bp : mapBreakpoints)
-                if (bp.second)
-                    breakpoints.push_back(bp.first);
+            std::vector<Word> breakpoints = _breakpoints.Addresses();
             if ((unsigned)index < breakpoints.size())
             {
                 //printf("RIGHT CLICK: $%04X\n", breakpoints[index]);
-                mapBreakpoints[breakpoints[index]] = false;
+                _breakpoints.Set(breakpoints[index], false);
             }
         }
 
@@ -1013,22 +1288,31 @@ void Debug::MouseStuff()
             if (sDisplayedAsm[my - 7] >= 0)
             {
                 Word offset = sDisplayedAsm[my - 7];
-                (mapBreakpoints[offset]) ?
-                    mapBreakpoints[offset] = false :
-                    mapBreakpoints[offset] = true;
-                if (mapBreakpoints[offset] == true)
+                _breakpoints.Toggle(offset);
+                if (_breakpoints.Test(offset))
                     s_bSingleStep = false;
             }
         }
     }
     last_RMB = (btns & 4);
+    // middle-click on code line runs to that line
+    static bool last_MMB = false;
+    if (btns & 2 && !last_MMB)
+    {
+        if (mx > 39 && mx < 73 && my > 6 && my < 36 && s_bSingleStep)
+        {
+            if (sDisplayedAsm[my - 7] >= 0)
+                RunTo(sDisplayedAsm[my - 7]);
+        }
+    }
+    last_MMB = (btns & 2);
 }
 
 void Debug::_correct_mouse_coords(int& mx, int& my)
 { 
-    float mouse_x, mouse_y;
-    SDL_GetMouseState(&mouse_x, &mouse_y);
-    SDL_GetWindowSize(_dbg_window, &_dbg_window_width, &_dbg_window_height);
+    float mouse_x = _input.mouse_x, mouse_y = _input.mouse_y;
+    _dbg_window_width = std::max(1, _input.window_width);
+    _dbg_window_height = std::max(1, _input.window_height);
     float ax = (float)_dbg_width / (float)_dbg_window_width;
     float ay =  (float)_dbg_height / (float)_dbg_window_height;
     mx = (int)(mouse_x * ax)/8;
@@ -1072,7 +1356,7 @@ void Debug::DrawCursor(float fElapsedTime)
             if (csr_y > 18 && csr_y < 27) { ofs -= 144; addr = mem_bank[2]; }
             if (csr_y > 27 && csr_y < 36) { ofs -= 216; addr = mem_bank[3]; }
 
-            Byte data = Memory::Read(addr + ofs);//, true);
+            Byte data = Memory::Peek(addr + ofs);
             if (digit == 0) num = (data & 0xf0) >> 4;
             if (digit == 1) num = (data & 0x0f) >> 0;
             ch = _hex(num, 1);
@@ -1103,8 +1387,7 @@ void Debug::DrawCode(int col, int row) {
         return;
     }
 
-    C6809* cpu = Bus::GetC6809();
-    Word nextAddress = cpu->getPC();
+    Word nextAddress = _cpu.pc;
 
     // Reset the displayed disassembly buffer
     for (auto &d : sDisplayedAsm) { d = -1; }
@@ -1129,15 +1412,15 @@ void Debug::_display_previous_instructions(int col, int& row)
     int ofs = 7;
     int threshold = 100;
     int count = 14;
-    int start_addr = (cpu->getPC()-1);              // + mousewheel_offset;
+    int start_addr = (_cpu.pc-1);              // + mousewheel_offset;
     for (int i = start_addr; i > 0; i--)
     {
         if (cpu->WasVisited_Memory(i))
         {
             bool atBreak = false;
-            if (mapBreakpoints[i])	atBreak = true;
+            if (_breakpoints.Test(i))	atBreak = true;
             Word throw_away;
-            std::string code = cpu->disasm(i, throw_away);
+            std::string code = _symbolize(cpu->disasm(i, throw_away), 40);
             sDisplayedAsm[row-ofs] = i;
             OutText(col, row--, code, atBreak ? 0x50 : 0x80);
             count--;
@@ -1156,12 +1439,40 @@ void Debug::_display_single_instruction(int col, int& row, Word &nextAddress)
     Word currentAddress = nextAddress;
 
     // display the current instruction
-    bool atBreak = mapBreakpoints[currentAddress];    
-    std::string code = cpu->disasm(currentAddress, nextAddress);   // this updates nextAddress 
+    bool atBreak = _breakpoints.Test(currentAddress);    
+    std::string code = _symbolize(cpu->disasm(currentAddress, nextAddress), 40);   // this updates nextAddress 
     sDisplayedAsm[row-ofs] = currentAddress;
     OutText(col, row++, code, atBreak ? 0xA0 : 0xF0);
 }
 
+/**
+ * Replaces an absolute operand ("$F1E2", "[$FFF0]" and branch targets)
+ * with the symbol covering it, and clips the line to the code window.
+ * Immediate and indexed operands are left as numbers.
+ */
+std::string Debug::_symbolize(const std::string& code, int width)
+{
+    constexpr size_t OPERAND = 26;      // C6809::disasm() operand column
+    std::string line = code;
+    if (line.size() > OPERAND)
+    {
+        std::string operand = line.substr(OPERAND);
+        bool indirect = operand.size() == 7 && operand[0] == '[' && operand[6] == ']';
+        std::string digits = indirect ? operand.substr(1, 5) : operand;
+        bool address = digits.size() == 5 && digits[0] == '$' &&
+                       std::all_of(digits.begin() + 1, digits.end(), [](char c) { return std::isxdigit((unsigned char)c) != 0; });
+        if (address)     // "$05,X" is an indexed offset
+        {
+            std::string name = _symbols.Name((Word)std::stoul(digits.substr(1), nullptr, 16));
+            if (!name.empty()) {
+                line = line.substr(0, OPERAND) + (indirect ? "[" + name + "]" : name);
+            }
+        }
+    }
+    if (line.size() > (size_t)width) { line.resize(width); }
+    return line;
+} // END: Debug::_symbolize()
+
 void Debug::_display_next_instructions(int col, int& row, Word& nextAddress) 
 {
     C6809* cpu = Bus::GetC6809();
@@ -1169,11 +1480,11 @@ void Debug::_display_next_instructions(int col, int& row, Word& nextAddress)
     // Display the next several instructions
     int count = 0;
     while (count < 14) {
-        bool atBreak = mapBreakpoints[nextAddress];
+        bool atBreak = _breakpoints.Test(nextAddress);
 
         // Disassemble the current instruction and update nextAddress to the next instruction
         Word currentAddress = nextAddress;
-        std::string code = cpu->disasm(nextAddress, nextAddress);
+        std::string code = _symbolize(cpu->disasm(nextAddress, nextAddress), 40);
 
         // Output the disassembled instruction
         //if (cpu->WasVisited_Memory(currentAddress)) {
@@ -1198,7 +1509,7 @@ void Debug::Old_DrawCode(int col, int row)
 
     if (bMouseWheelActive)
     {
-        Word cpu_PC = cpu->getPC();
+        Word cpu_PC = _cpu.pc;
         Word offset = cpu_PC + mousewheel_offset;
         int max_lines = 29;
         while (line < max_lines)
@@ -1206,7 +1517,7 @@ void Debug::Old_DrawCode(int col, int row)
             if (offset < cpu_PC)
             {
                 bool atBreak = false;
-                if (mapBreakpoints[offset])	atBreak = true;
+                if (_breakpoints.Test(offset))	atBreak = true;
                 sDisplayedAsm.push_back(offset);
                 code = cpu->disasm(offset, offset);
                 if (atBreak)
@@ -1218,7 +1529,7 @@ void Debug::Old_DrawCode(int col, int row)
             if (offset == cpu_PC && line < max_lines)
             {
                 bool atBreak = false;
-                if (mapBreakpoints[offset])	atBreak = true;
+                if (_breakpoints.Test(offset))	atBreak = true;
                 sDisplayedAsm.push_back(offset);
                 code = cpu->disasm(offset, offset);
                 if (atBreak)
@@ -1230,7 +1541,7 @@ void Debug::Old_DrawCode(int col, int row)
             if (offset > cpu_PC && line < max_lines)
             {
                 bool atBreak = false;
-                if (mapBreakpoints[offset])	atBreak = true;
+                if (_breakpoints.Test(offset))	atBreak = true;
                 sDisplayedAsm.push_back(offset);
                 code = cpu->disasm(offset, offset);
                 if (atBreak)
@@ -1248,10 +1559,10 @@ void Debug::Old_DrawCode(int col, int row)
         // draw the last several lines
         for (auto& a : asmHistory)
         {
-            if (a != cpu->getPC())
+            if (a != _cpu.pc)
             {
                 bool atBreak = false;
-                if (mapBreakpoints[a])	atBreak = true;
+                if (_breakpoints.Test(a))	atBreak = true;
                 sDisplayedAsm.push_back(a);
                 code = cpu->disasm(a, next);
                 if (atBreak)
@@ -1261,18 +1572,18 @@ void Debug::Old_DrawCode(int col, int row)
             }
         }
         // draw the current line
-        sDisplayedAsm.push_back(cpu->getPC());
-        code = cpu->disasm(cpu->getPC(), next);
-        if (mapBreakpoints[cpu->getPC()])
+        sDisplayedAsm.push_back(_cpu.pc);
+        code = cpu->disasm(_cpu.pc, next);
+        if (_breakpoints.Test(_cpu.pc))
             OutText(col, row + line++, code, 0xA0);              // 0xA0 red
         else
             OutText(col, row + line++, code, 0xF0);            // 0xF0 white
         // create a history of addresses to display in the future
-        static Word last = cpu->getPC();
-        if (last != cpu->getPC())
+        static Word last = _cpu.pc;
+        if (last != _cpu.pc)
         {
-            last = cpu->getPC();
-            asmHistory.push_back(cpu->getPC());
+            last = _cpu.pc;
+            asmHistory.push_back(_cpu.pc);
             while (asmHistory.size() > 12)
                 asmHistory.pop_front();
         }
@@ -1280,7 +1591,7 @@ void Debug::Old_DrawCode(int col, int row)
         while (line < 24)
         {
             bool atBreak = false;
-            if (mapBreakpoints[next])	atBreak = true;
+            if (_breakpoints.Test(next))	atBreak = true;
             sDisplayedAsm.push_back(next);
             code = cpu->disasm(next, next);
             if (atBreak)
@@ -1366,7 +1677,7 @@ void Debug::HandleButtons()
     // C6809* cpu = Bus::GetC6809();
     int mx, my;
     _correct_mouse_coords(mx, my);
-    Uint32 btns = SDL_GetRelativeMouseState(NULL, NULL);
+    Uint32 btns = _input.buttons;
 
     static bool last_LMB = false;
     if (btns & 1 && !last_LMB)
@@ -1382,6 +1693,73 @@ void Debug::HandleButtons()
     last_LMB = (btns & 1);
 }
 
+/**
+ * Shows the last host frame time, the frame time histogram and the
+ * frame skip state from the extended system registers. Each histogram
+ * cell is one 2 ms bucket, scaled against the fullest bucket.
+ */
+void Debug::DrawFrameTimes(int col, int row)
+{
+    SYS_EXT* sys = Bus::GetSYS_EXT();
+    if (!sys) { return; }
+
+    char ms[16];
+    std::snprintf(ms, sizeof(ms), "%6.2f", sys->FrameTime());
+    int x = col;
+    x += OutText(x, row, "Frame Time:", 0xB0);
+    x += OutText(x, row, ms, 0xC0);
+    OutText(x, row, " ms", 0xB0);
+    row++;
+
+    Word most = 1;
+    for (int b = 0; b < SYS_EXT::HIST_BUCKETS; b++) {
+        most = std::max(most, sys->FrameHistogram(b));
+    }
+    x = col;
+    x += OutText(x, row, "0ms ", 0xB0);
+    for (int b = 0; b < SYS_EXT::HIST_BUCKETS; b++)
+    {
+        Word count = sys->FrameHistogram(b);
+        Byte glyph = '.';                       // empty
+        if (count * 2 > most)       glyph = 0x8F;   // full block
+        else if (count * 8 > most)  glyph = 0x83;   // half block
+        else if (count > 0)         glyph = 0x80;   // small block
+        OutGlyph(x++, row, glyph, 0xC0);
+    }
+    OutText(x, row, " 30+", 0xB0);
+    row++;
+
+    char render[16];
+    std::snprintf(render, sizeof(render), "%6.2f", sys->RenderTime());
+    x = col;
+    x += OutText(x, row, "Render:", 0xB0);
+    x += OutText(x, row, render, 0xC0);
+    x += OutText(x, row, " ms  Skip:", 0xB0);
+    x += OutText(x, row, std::to_string(sys->SkipLevel()), 0xC0);
+    x += OutText(x, row, "/", 0xB0);
+    OutText(x, row, std::to_string(sys->SkipMax()), 0xC0);
+} // END: Debug::DrawFrameTimes()
+
+
+/**
+ * Shows the most recent watchpoint hit: the kind of access, the address
+ * with its old and new values and the instruction responsible.
+ */
+void Debug::DrawWatchHit(int col, int row)
+{
+    WATCH_HIT hit;
+    if (!LastWatchHit(hit)) { return; }
+    const char* kind = (hit.kind == Memory::WATCH_READ) ? "Read " :
+                       (hit.kind == Memory::WATCH_WRITE) ? "Write " : "Change ";
+    int x = col;
+    x += OutText(x, row, "Watch ", 0xB0);
+    x += OutText(x, row, kind, 0xC0);
+    x += OutText(x, row, "$" + _hex(hit.address, 4) + " $" + _hex(hit.old_data, 2) + "->$" + _hex(hit.data, 2), 0xC0);
+    x += OutText(x, row, " at ", 0xB0);
+    OutText(x, row, "$" + _hex(hit.pc, 4), 0xC0);
+} // END: Debug::DrawWatchHit()
+
+
 void Debug::DrawBreakpoints()
 {
     // C6809* cpu = Bus::GetC6809();
@@ -1391,10 +1769,7 @@ void Debug::DrawBreakpoints()
     // Uint8 ci = 0x0C;
 
     // build a vector of active breakpoints
-    std::vector<Word> breakpoints;
-    for (auto& bp : mapBreakpoints)
-        if (bp.second)
-            breakpoints.push_back(bp.first);
+    std::vector<Word> breakpoints = _breakpoints.Addresses();
 
     // standard display
     int length = _bkp_window_len;    // number of breakpoints to display
@@ -1503,16 +1878,16 @@ bool Debug::EditRegister(float fElapsedTime)
 
     Word data = 0;
     switch (nRegisterBeingEdited.reg) {
-        case EDIT_CC:	data = (Word)cpu->getCC() << 8; break;
-        case EDIT_D:	data = cpu->getD(); break;
-        case EDIT_A:	data = (Word)cpu->getA() << 8; break;
-        case EDIT_B:	data = (Word)cpu->getB() << 8; break;
-        case EDIT_X:	data = cpu->getX(); break;
-        case EDIT_Y:	data = cpu->getY(); break;
-        case EDIT_U:	data = cpu->getU(); break;
-        case EDIT_PC:	data = cpu->getPC(); s_bSingleStep = true;  break;
-        case EDIT_S:	data = cpu->getS(); break;
-        case EDIT_DP:	data = (Word)cpu->getDP() << 8; break;
+        case EDIT_CC:	data = (Word)_cpu.cc << 8; break;
+        case EDIT_D:	data = _cpu.d(); break;
+        case EDIT_A:	data = (Word)_cpu.a << 8; break;
+        case EDIT_B:	data = (Word)_cpu.b << 8; break;
+        case EDIT_X:	data = _cpu.x; break;
+        case EDIT_Y:	data = _cpu.y; break;
+        case EDIT_U:	data = _cpu.u; break;
+        case EDIT_PC:	data = _cpu.pc; s_bSingleStep = true;  break;
+        case EDIT_S:	data = _cpu.s; break;
+        case EDIT_DP:	data = (Word)_cpu.dp << 8; break;
         case EDIT_BREAK: data = new_breakpoint; break;
         case EDIT_NONE: break;
     }
@@ -1594,7 +1969,7 @@ bool Debug::EditRegister(float fElapsedTime)
             {
                 if (nRegisterBeingEdited.reg == EDIT_REGISTER::EDIT_BREAK)
                 {
-                    mapBreakpoints[new_breakpoint] = true;
+                    _breakpoints.Set(new_breakpoint, true);
                     nRegisterBeingEdited.reg = EDIT_REGISTER::EDIT_NONE;
                     bEditingBreakpoint = false;
                 }
@@ -1669,10 +2044,10 @@ void Debug::KeyboardStuff()
             if (csr_y >  9 && csr_y < 18) { ofs -= 72 ; addr = mem_bank[1]; }
             if (csr_y > 18 && csr_y < 27) { ofs -= 144; addr = mem_bank[2]; }
             if (csr_y > 27 && csr_y < 36) { ofs -= 216; addr = mem_bank[3]; }
-            Byte data = Memory::Read(addr + ofs);//,true);
+            Byte data = Memory::Peek(addr + ofs);
             if (digit == 0)		data = (data & 0x0f) | (ch << 4);
             if (digit == 1)		data = (data & 0xf0) | (ch << 0);
-            Memory::Write(addr + ofs, data);
+            Memory::Poke(addr + ofs, data);
             if (csr_x < 28)		while (!CoordIsValid(++csr_x, csr_y));
             break;
         }
@@ -1691,11 +2066,131 @@ bool Debug::SingleStep()
     return true;
 }
 
+/**
+ * Watchpoints live in Memory's flag table; each range simply sets or
+ * clears flag bits, so overlapping ranges combine.
+ */
+void Debug::AddWatch(Word first, Word last, Byte flags)
+{
+    for (int a = first; a <= last; a++) {
+        Memory::Watch((Word)a, Memory::Watched((Word)a) | flags);
+    }
+}
+
+void Debug::RemoveWatch(Word first, Word last, Byte flags)
+{
+    for (int a = first; a <= last; a++) {
+        Memory::Watch((Word)a, Memory::Watched((Word)a) & ~flags);
+    }
+}
+
+void Debug::ClearWatches()
+{
+    for (int a = 0; a <= 0xFFFF; a++) { Memory::Watch((Word)a, 0); }
+    std::lock_guard<std::mutex> lock(_watch_mutex);
+    _watch_hit_valid = false;
+}
+
+/**
+ * Called by Memory for a watched access. Only the CPU's own accesses
+ * count (the debugger display reads memory too). The hit is recorded
+ * and the CPU stops once the instruction making it has completed.
+ */
+void Debug::WatchHit(Word address, Byte kind, Byte old_data, Byte data)
+{
+    if (!Bus::IsCpuThread()) { return; }
+    {
+        std::lock_guard<std::mutex> lock(_watch_mutex);
+        _watch_hit = { Bus::GetC6809()->getOpPC(), address, kind, old_data, data, _watch_hit.count + 1 };
+        _watch_hit_valid = true;
+    }
+    _watch_stop.store(true, std::memory_order_relaxed);
+}
+
+bool Debug::LastWatchHit(WATCH_HIT& hit)
+{
+    std::lock_guard<std::mutex> lock(_watch_mutex);
+    hit = _watch_hit;
+    return _watch_hit_valid;
+}
+
+
+/**
+ * Step over treats JSR, BSR, LBSR and SWI/SWI2/SWI3 as one step. Rather
+ * than a temporary breakpoint at the following address, the run ends at
+ * the first instruction that leaves S back at its depth before the call:
+ * the kernel's SWI2 calls return past an inline command byte, and a
+ * recursive call passes through the return address at a deeper level.
+ */
+void Debug::StepOver()
+{
+    C6809* cpu = Bus::GetC6809();
+    Word pc = cpu->getPC();
+    Byte op = Memory::Peek(pc);
+    bool call = op == 0x8D || op == 0x9D || op == 0xAD || op == 0xBD ||    // BSR, JSR
+                op == 0x17 || op == 0x3F ||                                 // LBSR, SWI
+                ((op == 0x10 || op == 0x11) && Memory::Peek(pc + 1) == 0x3F);  // SWI2, SWI3
+    if (call) { _run_until(RUN_OVER, 0); }
+    else { cbStepIn(); }
+}
+
+/**
+ * Step out runs until a return (RTS, RTI or PULS ...,PC) lifts S above its
+ * depth when the step began; returns from deeper calls do not reach it.
+ */
+void Debug::StepOut() { _run_until(RUN_OUT, 0); }
+
+void Debug::RunTo(Word address) { _run_until(RUN_TO, address); }
+
+void Debug::_run_until(Byte mode, Word address)
+{
+    C6809* cpu = Bus::GetC6809();
+    _run_from = cpu->getPC();
+    _run_addr = address;
+    _run_stack = cpu->getS();
+    _run_mode.store(mode, std::memory_order_release);
+    nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
+    bMouseWheelActive = false;
+    s_bSingleStep = false;
+    s_bIsStepPaused = false;
+}
+
+// called on the CPU thread after each instruction while a run is active
+bool Debug::_run_reached(C6809* cpu)
+{
+    switch (_run_mode.load(std::memory_order_relaxed))
+    {
+        case RUN_TO:
+            return cpu->getPC() == _run_addr;
+        case RUN_OVER:
+            // an interrupt taken before the call returns to the call itself
+            return cpu->getS() >= _run_stack && cpu->getPC() != _run_from;
+        case RUN_OUT:
+        {
+            Word op = cpu->opcode;
+            bool ret = op == 0x39 || op == 0x3B ||      // RTS, RTI
+                       (op == 0x35 && (Memory::Peek(cpu->getOpPC() + 1) & 0x80));  // PULS PC
+            return ret && cpu->getS() > _run_stack;
+        }
+    }
+    return false;
+}
+
+
 void Debug::ContinueSingleStep() {
     // C6809* cpu = Bus::Inst().m_cpu;
     C6809* cpu = Bus::GetC6809();
     // if breakpoint reached... enable singlestep
-    if (mapBreakpoints[cpu->getPC()] == true)
+    Word pc = cpu->getPC();
+    bool watched = _watch_stop.load(std::memory_order_relaxed);
+    if (watched) { _watch_stop.store(false, std::memory_order_relaxed); }
+    bool stop = watched || (_breakpoints.Test(pc) && _breakpoints.Hit(pc));
+    if (_run_mode.load(std::memory_order_acquire) != RUN_NONE && (stop || _run_reached(cpu)))
+    {
+        _run_mode.store(RUN_NONE, std::memory_order_relaxed);
+        stop = true;
+    }
+    if (stop)
     {
         s_bIsDebugActive = true;
         s_bSingleStep = true;
@@ -1712,8 +2207,7 @@ void Debug::ContinueSingleStep() {
 
 void Debug::cbClearBreaks()
 {
-    if (mapBreakpoints.size() > 0)
-        mapBreakpoints.clear();
+    _breakpoints.Clear();
 }
 void Debug::cbReset()
 {
@@ -1760,7 +2254,7 @@ void Debug::cbHide()
 
     s_bIsDebugActive = false;
     // SDL_MinimizeWindow(_dbg_window);
-    SDL_HideWindow(_dbg_window);
+    _window_request = WINDOW_HIDE;
 }void Debug::cbExit()
 {
     nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
@@ -1775,10 +2269,11 @@ void Debug::cbStepIn()  //F11
 }
 void Debug::cbStepOver() //F10
 {
-    s_bSingleStep = true;
-    s_bIsStepPaused = false;
-    nRegisterBeingEdited.reg = Debug::EDIT_REGISTER::EDIT_NONE;	// cancel any register edits
-    bMouseWheelActive = false;
+    StepOver();
+}
+void Debug::cbStepOut() //SHIFT-F11
+{
+    StepOut();
 }
 void Debug::cbAddBrk()
 {
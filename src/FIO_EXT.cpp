@@ -0,0 +1,115 @@
+/*** FIO_EXT.cpp *******************************************
+ *    ______ _____ ____        ________   _________
+ *   |  ____|_   _/ __ \      |  ____\ \ / /__   __|
+ *   | |__    | || |  | |     | |__   \ V /   | |        ___ _ __  _ __
+ *   |  __|   | || |  | |     |  __|   > <    | |       / __| '_ \| '_ \
+ *   | |     _| || |__| |     | |____ / . \   | |   _  | (__| |_) | |_) |
+ *   |_|    |_____\____/      |______/_/ \_\  |_|  (_)  \___| .__/| .__/
+ *                      ______                              | |   | |
+ *                     |______|                             |_|   |_|
+ *
+ * Extended File I/O Registers. Block transfer parameters for the
+ * FileIO device.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include "FIO_EXT.hpp"
+#include "Memory.hpp"
+
+
+/***************************
+* Constructor / Destructor *
+***************************/
+
+FIO_EXT::FIO_EXT()
+{
+    std::cout << clr::indent_push() << clr::CYAN << "FIO_EXT Created" << clr::RETURN;
+    _device_name = "FIO_EXT_DEVICE";
+} // END: FIO_EXT()
+
+FIO_EXT::~FIO_EXT()
+{
+    std::cout << clr::indent_pop() << clr::CYAN << "FIO_EXT Destroyed" << clr::RETURN;
+} // END: ~FIO_EXT()
+
+
+
+/******************
+* Virtual Methods *
+******************/
+
+
+int  FIO_EXT::OnAttach(int nextAddr)
+{
+    SetBaseAddress(nextAddr);
+    Word old_address=nextAddr;
+    this->heading = "Extended File I/O Hardware Registers";
+
+
+    ////////////////////////////////////////////////
+    // (Word) FIO_BLK_ADDR
+    //      CPU Address of the Block to Read / Write
+    /////
+    mapped_register.push_back({ "FIO_BLK_ADDR", nextAddr,
+        [this](Word) { return (_blk_addr >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blk_addr = (_blk_addr & 0x00FF) | (data << 8); },
+        {
+            "(Word) CPU Address of the Block to Read / Write",
+            "  Note: Used by FC_READBLOCK and FC_WRITEBLOCK.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blk_addr & 0xFF; },
+        [this](Word, Byte data) { _blk_addr = (_blk_addr & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) FIO_BLK_LEN
+    //      Block Length / Bytes Transferred
+    /////
+    mapped_register.push_back({ "FIO_BLK_LEN", nextAddr,
+        [this](Word) { return (_blk_len >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blk_len = (_blk_len & 0x00FF) | (data << 8); },
+        {
+            "(Word) Block Length in Bytes",
+            "  Note: Replaced by the number of bytes",
+            "       actually transferred.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blk_len & 0xFF; },
+        [this](Word, Byte data) { _blk_len = (_blk_len & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) FIO_EXT_END
+    //      End of Extended File I/O Register Space
+    /////
+    nextAddr--;
+    mapped_register.push_back({ "FIO_EXT_END", nextAddr,
+        nullptr, nullptr,  { "End of Extended File I/O Register Space"} });
+    nextAddr++;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) FIO_EXT_TOP
+    //      Top of Extended File I/O Register Space
+    //      (start of the next device)
+    /////
+    mapped_register.push_back({ "FIO_EXT_TOP", nextAddr,
+    nullptr, nullptr,  { "Top of Extended File I/O Register Space", "---"}});
+
+    _size = nextAddr - old_address;
+    return _size;
+} // END: FIO_EXT::OnAttach()
+
+
+
+// END: FIO_EXT.cpp
@@ -18,6 +18,7 @@
  ************************************/
 
 
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 
@@ -140,6 +141,8 @@ int  FileIO::OnAttach(int nextAddr)
             else if ( data == MAP(FC_SEEK_END  ) )  { _cmd_seek_end();                   }
             else if ( data == MAP(FC_SET_SEEK  ) )  { _cmd_set_seek_position();          }
             else if ( data == MAP(FC_GET_SEEK  ) )  { _cmd_get_seek_position();          }
+            else if ( data == MAP(FC_READBLOCK ) )  { _cmd_read_block();                 }
+            else if ( data == MAP(FC_WRITEBLOCK) )  { _cmd_write_block();                }
         },   
         { "(Byte) Execute a File Command (FC_<cmd>)",""} });
     nextAddr++;
@@ -170,7 +173,9 @@ int  FileIO::OnAttach(int nextAddr)
     mapped_register.push_back({ "FC_SEEK_START", enumID++, nullptr, nullptr,  { "    Seek Start                            "} });
     mapped_register.push_back({ "FC_SEEK_END"  , enumID++, nullptr, nullptr,  { "    Seek End                              "} });
     mapped_register.push_back({ "FC_SET_SEEK"  , enumID++, nullptr, nullptr,  { "    Set Seek Position (from FIO_IOWORD)   "} });
-    mapped_register.push_back({ "FC_GET_SEEK"  , enumID  , nullptr, nullptr,  { "    Get Seek Position (into FIO_IOWORD)   "} });
+    mapped_register.push_back({ "FC_GET_SEEK"  , enumID++, nullptr, nullptr,  { "    Get Seek Position (into FIO_IOWORD)   "} });
+    mapped_register.push_back({ "FC_READBLOCK" , enumID++, nullptr, nullptr,  { "    Read Block (into FIO_BLK_ADDR)        "} });
+    mapped_register.push_back({ "FC_WRITEBLOCK", enumID  , nullptr, nullptr,  { "    Write Block (from FIO_BLK_ADDR)       "} });
     mapped_register.push_back({ "FC_LAST"      , enumID  , nullptr, nullptr,  { "  End FIO_COMMAND enumeration             ",""} });
 
 
@@ -305,7 +310,8 @@ int  FileIO::OnAttach(int nextAddr)
                 path_char_pos++;
             }
         },  
-        { "(Byte) Data at the Character Position of the Primary Path",""} });
+        { "(Byte) Data at the Character Position of the Primary Path",""},
+        [this](Word) { return (path_char_pos < filePath.size()) ? (Byte)filePath[path_char_pos] : (Byte)0; } });
     nextAddr++;
 
 
@@ -384,7 +390,8 @@ int  FileIO::OnAttach(int nextAddr)
                 path_alt_char_pos++;
             }
         },  
-        { "(Byte) Data at the Character Position of the Alternate Path",""} });
+        { "(Byte) Data at the Character Position of the Alternate Path",""},
+        [this](Word) { return (path_alt_char_pos < altFilePath.size()) ? (Byte)altFilePath[path_alt_char_pos] : (Byte)0; } });
     nextAddr++;
 
 
@@ -432,7 +439,8 @@ int  FileIO::OnAttach(int nextAddr)
             "    following a List Directory command. The read-position",
             "    is automatically advanced on read from this register.",
             "    Each filename is $0A-terminated. The list itself is",
-            "    null-terminated.",""} }); 
+            "    null-terminated.",""},
+        [this](Word) { return (dir_data_pos < (int)dir_data.size()) ? (Byte)dir_data[dir_data_pos] : (Byte)0; } }); 
     nextAddr++;
 
 
@@ -504,6 +512,84 @@ void FileIO::OnQuit()
 }
 
 
+/**
+ * Runs a block write out to a temporary file and a block read back in,
+ * checking the data and the reported counts. User RAM and the file
+ * state are restored afterwards.
+ */
+bool FileIO::OnTest()
+{
+    bool test_results = true;
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Block Transfers" + clr::RESET);
+
+    const Word src = MAP(USER_RAM);
+    const Word dst = src + 0x1000;
+    const Word length = 0x300;
+    std::vector<Byte> saved(0x1000 + length);
+    for (size_t i = 0; i < saved.size(); i++)
+        saved[i] = Memory::Read((Word)(src + i));
+    std::string saved_path = filePath;
+    Byte saved_handle = _fileHandle;
+    Byte saved_error = Memory::Read(MAP(FIO_ERROR));
+    filePath = (std::filesystem::temp_directory_path() / "fio_block_test.bin").string();
+
+    for (Word i = 0; i < length; i++) {
+        Memory::Write((Word)(src + i), (Byte)(i * 7 + 3));
+        Memory::Write((Word)(dst + i), (Byte)0);
+    }
+    Memory::Write(MAP(FIO_ERROR), (Byte)FE_NOERROR);
+
+    // write the block out
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_OPENWRITE));
+    Memory::Write_Word(MAP(FIO_BLK_ADDR), (Word)src);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)length);
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_WRITEBLOCK));
+    Word written = Memory::Read_Word(MAP(FIO_BLK_LEN));
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_CLOSEFILE));
+    if (!ASSERT_TRUE(written == length && Memory::Read(MAP(FIO_ERROR)) == FE_NOERROR)) {
+        UnitTest::Log(this, clr::RED + "FC_WRITEBLOCK did not write the whole block");
+        test_results = false;
+    }
+
+    // read it back, asking for more than the file holds
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_OPENREAD));
+    Memory::Write_Word(MAP(FIO_BLK_ADDR), (Word)dst);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)(length + 0x10));
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_READBLOCK));
+    Word read = Memory::Read_Word(MAP(FIO_BLK_LEN));
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_CLOSEFILE));
+    bool same = true;
+    for (Word i = 0; i < length; i++)
+        same = same && Memory::Read((Word)(dst + i)) == Memory::Read((Word)(src + i));
+    if (!ASSERT_TRUE(read == length && same && Memory::Read(MAP(FIO_ERROR)) == FE_EOF)) {
+        UnitTest::Log(this, clr::RED + "FC_READBLOCK did not read the block back");
+        test_results = false;
+    }
+
+    // no open stream
+    Memory::Write(MAP(FIO_ERROR), (Byte)FE_NOERROR);
+    Memory::Write(MAP(FIO_COMMAND), (Byte)MAP(FC_READBLOCK));
+    if (!ASSERT_TRUE(Memory::Read(MAP(FIO_ERROR)) == FE_NOTOPEN && Memory::Read_Word(MAP(FIO_BLK_LEN)) == 0)) {
+        UnitTest::Log(this, clr::RED + "FC_READBLOCK without an open file was not reported");
+        test_results = false;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(filePath, ec);
+    for (size_t i = 0; i < saved.size(); i++)
+        Memory::Write((Word)(src + i), saved[i]);
+    filePath = saved_path;
+    _fileHandle = saved_handle;
+    Memory::Write(MAP(FIO_ERROR), saved_error);
+
+    if (test_results)
+        UnitTest::Log(this, "Unit Tests PASSED");
+    else
+        UnitTest::Log(this, clr::RED + "Unit Tests FAILED");
+    return test_results;
+} // END: FileIO::OnTest()
+
+
 /**
  * _cmd_reset() is called when the FIO_COMMAND for a reset
  * (FC_RESET) is received. It sends a reset command to the
@@ -678,6 +764,72 @@ void FileIO::_cmd_write_byte()
 }
 
 
+/**
+ * Reads up to FIO_BLK_LEN bytes from the file stream associated with the
+ * FIO_HANDLE into CPU memory starting at FIO_BLK_ADDR, with one fread()
+ * for the whole block. The block stops at the top of the address space.
+ * FIO_BLK_LEN is replaced by the number of bytes actually read.
+ * If the file is not open, it sets the FIO_ERROR to FE_NOTOPEN.
+ * If the end of file cut the block short, it sets the FIO_ERROR to FE_EOF.
+ */
+void FileIO::_cmd_read_block()
+{
+    Word address = Memory::Read_Word(MAP(FIO_BLK_ADDR));
+    Word length = _blk_length(address);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)0);
+    if (_fileHandle == 0 || _vecFileStreams[_fileHandle] == nullptr)
+    {
+        Memory::Write(MAP(FIO_ERROR), (Byte)FILE_ERROR::FE_NOTOPEN);
+        return;
+    }
+    std::vector<Byte> buffer(length);
+    size_t count = fread(buffer.data(), 1, length, _vecFileStreams[_fileHandle]);
+    // written through the bus so banked windows and watchpoints still apply
+    for (size_t i = 0; i < count; i++)
+        Memory::Write((Word)(address + i), buffer[i]);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)count);
+    if (count < length)
+        Memory::Write(MAP(FIO_ERROR), (Byte)(feof(_vecFileStreams[_fileHandle]) ? FILE_ERROR::FE_EOF : FILE_ERROR::FE_BADSTREAM));
+}
+
+
+/**
+ * Writes FIO_BLK_LEN bytes of CPU memory starting at FIO_BLK_ADDR to the
+ * file stream associated with the FIO_HANDLE, with one fwrite() for the
+ * whole block. FIO_BLK_LEN is replaced by the number of bytes written.
+ * If the file is not open, it sets the FIO_ERROR to FE_NOTOPEN.
+ * If the stream took fewer bytes, it sets the FIO_ERROR to FE_BADSTREAM.
+ */
+void FileIO::_cmd_write_block()
+{
+    Word address = Memory::Read_Word(MAP(FIO_BLK_ADDR));
+    Word length = _blk_length(address);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)0);
+    if (_fileHandle == 0 || _vecFileStreams[_fileHandle] == nullptr)
+    {
+        Memory::Write(MAP(FIO_ERROR), (Byte)FILE_ERROR::FE_NOTOPEN);
+        return;
+    }
+    std::vector<Byte> buffer(length);
+    for (Word i = 0; i < length; i++)
+        buffer[i] = Memory::Read((Word)(address + i));
+    size_t count = fwrite(buffer.data(), 1, length, _vecFileStreams[_fileHandle]);
+    Memory::Write_Word(MAP(FIO_BLK_LEN), (Word)count);
+    if (count < length)
+        Memory::Write(MAP(FIO_ERROR), (Byte)FILE_ERROR::FE_BADSTREAM);
+}
+
+
+/**
+ * Returns FIO_BLK_LEN clipped so a block starting at address ends at
+ * $FFFF rather than wrapping around to the bottom of memory.
+ */
+Word FileIO::_blk_length(Word address)
+{
+    return (Word)std::min<int>(Memory::Read_Word(MAP(FIO_BLK_LEN)), 0x10000 - address);
+}
+
+
 /**
  * Checks if a file exists.
  *
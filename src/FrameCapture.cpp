@@ -0,0 +1,208 @@
+/*** FrameCapture.cpp ****************************
+ *    ______                         _____            _
+ *   |  ____|                       / ____|          | |
+ *   | |__ _ __ __ _ _ __ ___   ___| |     __ _ _ __ | |_ _   _ _ __ ___    ___ _ __  _ __
+ *   |  __| '__/ _` | '_ ` _ \ / _ \ |    / _` | '_ \| __| | | | '__/ _ \  / __| '_ \| '_ \
+ *   | |  | | | (_| | | | | | |  __/ |___| (_| | |_) | |_| |_| | | |  __/_| (__| |_) | |_) |
+ *   |_|  |_|  \__,_|_| |_| |_|\___|\_____\__,_| .__/ \__|\__,_|_|  \___(_)\___| .__/| .__/
+ *                                             | |                            | |   | |
+ *                                             |_|                            |_|   |_|
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+#include <cstring>
+#include "FrameCapture.hpp"
+
+
+/**
+ * Opens the capture file, writes the stream header (Y4M only) and starts
+ * the writer thread. Any capture already in progress is stopped first.
+ *
+ * @return false if the file could not be created.
+ */
+bool FrameCapture::Start(const std::string& filename, FORMAT format, int width, int height, int fps)
+{
+    Stop();
+    _file = std::fopen(filename.c_str(), "wb");
+    if (!_file) { return false; }
+    _format = format;
+    _width = width;
+    _height = height;
+    _written = 0;
+    _repeated = 0;
+    _dropped = 0;
+    _last.reset();
+    _encoded.clear();
+    if (_format == FORMAT_Y4M) {
+        // 4:4:4 keeps single pixel detail intact in the chroma planes
+        std::fprintf(_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", _width, _height, fps);
+    }
+    _quit = false;
+    _active = true;
+    _writer = std::thread(&FrameCapture::_writer_proc, this);
+    return true;
+}
+
+
+void FrameCapture::Stop()
+{
+    if (!_active) { return; }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _cv.notify_one();
+    _writer.join();
+    std::fclose(_file);
+    _file = nullptr;
+    _queue.clear();
+    _pool.clear();
+    _last.reset();
+    _active = false;
+}
+
+
+bool FrameCapture::Submit(const Uint16* frame, int width, int height, int pitch)
+{
+    if (!_active) { return true; }
+    if (width != _width || height != _height) { return false; }
+    size_t row = (size_t)width * sizeof(Uint16);
+    auto src = [&](int y) { return (const Uint16*)((const Uint8*)frame + (y * pitch)); };
+
+    // unchanged frames only bump the repeat count of the newest entry;
+    // the last queued frame is only read here and by the writer
+    if (_last)
+    {
+        int y = 0;
+        while (y < height && std::memcmp(&(*_last)[y * width], src(y), row) == 0) { y++; }
+        if (y == height)
+        {
+            Repeat();
+            return true;
+        }
+    }
+
+    FRAME pixels;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ((int)_queue.size() >= GPU_CAPTURE_QUEUE)
+        {
+            // never wait on the disk: hold the previous frame instead
+            _queue.back().repeats++;
+            _dropped++;
+            return true;
+        }
+        if (!_pool.empty()) {
+            pixels = std::move(_pool.back());
+            _pool.pop_back();
+        }
+    }
+    if (!pixels) { pixels = std::make_shared<std::vector<Uint16>>(); }
+    pixels->resize((size_t)width * height);
+    for (int y = 0; y < height; y++) {
+        std::memcpy(&(*pixels)[y * width], src(y), row);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(ENTRY{pixels, 0});
+        _release(_last);
+        _last = std::move(pixels);
+    }
+    _cv.notify_one();
+    return true;
+}
+
+
+void FrameCapture::Repeat()
+{
+    if (!_active) { return; }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_queue.empty()) {
+        _queue.push_back(ENTRY{});
+    }
+    _queue.back().repeats++;
+    _cv.notify_one();
+}
+
+
+void FrameCapture::_writer_proc()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv.wait(lock, [this] { return _quit || !_queue.empty(); });
+        if (_queue.empty()) { break; }      // _quit with nothing left to write
+        ENTRY entry = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+
+        if (entry.pixels) {
+            _encode(*entry.pixels);
+            _written++;
+        }
+        if (!_encoded.empty())
+        {
+            for (int i = 0; i < entry.repeats; i++) {
+                if (_format == FORMAT_Y4M) { std::fputs("FRAME\n", _file); }
+                std::fwrite(_encoded.data(), 1, _encoded.size(), _file);
+            }
+            _repeated += entry.repeats;
+        }
+
+        lock.lock();
+        _release(entry.pixels);
+    }
+    std::fflush(_file);
+}
+
+
+// drops one reference to a frame, recycling it if it was the last (under _mutex)
+void FrameCapture::_release(FRAME& frame)
+{
+    if (frame && frame.use_count() == 1) {
+        _pool.push_back(std::move(frame));
+    }
+    frame.reset();
+}
+
+
+/**
+ * Converts one ARGB4444 frame into _encoded and writes it. Each 4-bit
+ * channel is widened to 8 bits (0xF -> 0xFF). Y4M frames are planar Y,
+ * Cb, Cr using BT.601 studio range; raw frames are packed RGB24.
+ */
+void FrameCapture::_encode(const std::vector<Uint16>& pixels)
+{
+    size_t count = pixels.size();
+    _encoded.resize(count * 3);
+    if (_format == FORMAT_Y4M)
+    {
+        Byte* y_plane = _encoded.data();
+        Byte* u_plane = y_plane + count;
+        Byte* v_plane = u_plane + count;
+        for (size_t i = 0; i < count; i++)
+        {
+            int r = ((pixels[i] >> 8) & 0x0F) * 0x11;
+            int g = ((pixels[i] >> 4) & 0x0F) * 0x11;
+            int b = ((pixels[i] >> 0) & 0x0F) * 0x11;
+            y_plane[i] = (Byte)((( 66 * r + 129 * g +  25 * b + 128) >> 8) +  16);
+            u_plane[i] = (Byte)(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+            v_plane[i] = (Byte)(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+        }
+        std::fputs("FRAME\n", _file);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            _encoded[i * 3 + 0] = (Byte)(((pixels[i] >> 8) & 0x0F) * 0x11);
+            _encoded[i * 3 + 1] = (Byte)(((pixels[i] >> 4) & 0x0F) * 0x11);
+            _encoded[i * 3 + 2] = (Byte)(((pixels[i] >> 0) & 0x0F) * 0x11);
+        }
+    }
+    std::fwrite(_encoded.data(), 1, _encoded.size(), _file);
+}
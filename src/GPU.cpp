@@ -16,8 +16,15 @@
  * 
  ************************************/
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
 #include "Bus.hpp"
 #include "GPU.hpp"
+#include "GPU_EXT.hpp"
+#include "SYS_EXT.hpp"
 #include "Memory.hpp"
 
 
@@ -368,43 +375,44 @@ void GPU::OnInit()
             Bus::Error(SDL_GetError(), __FILE__, __LINE__);
         }
 
-        // create the main window
-        pWindow = SDL_CreateWindow("SDL3 Retro_6809", initial_width, initial_height, window_flags); 
-        SDL_ShowWindow(pWindow);
-
-
-        // create the renderer
-        pRenderer = SDL_CreateRenderer(pWindow, NULL);
+        // the layers are drawn and composed on the host
+        for (auto& layer : _soft_layer) {
+            layer.resize(((int)_screen_width/2) * ((int)_screen_height/2));
+        }
+        _composite.resize(((int)_screen_width/2) * ((int)_screen_height/2));
+        if (!GPU_HEADLESS)
+        {
+            // create the main window
+            pWindow = SDL_CreateWindow("SDL3 Retro_6809", initial_width, initial_height, window_flags); 
+            SDL_ShowWindow(pWindow);
 
-        SDL_SetRenderLogicalPresentation(pRenderer, (int)_screen_width, (int)_screen_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
 
-        // build the textures
-        pExt_Texture = SDL_CreateTexture(pRenderer, 
-                SDL_PIXELFORMAT_ARGB4444, 
-                SDL_TEXTUREACCESS_STREAMING, 
-                (int)_screen_width/2, (int)_screen_height/2);
-        SDL_SetTextureScaleMode(pExt_Texture, SDL_SCALEMODE_NEAREST);            
+            // create the renderer
+            pRenderer = SDL_CreateRenderer(pWindow, NULL);
 
-        pStd_Texture = SDL_CreateTexture(pRenderer, 
-                SDL_PIXELFORMAT_ARGB4444, 
-                SDL_TEXTUREACCESS_STREAMING, 
-                (int)_screen_width/2, (int)_screen_height/2);
-        SDL_SetTextureScaleMode(pStd_Texture, SDL_SCALEMODE_NEAREST);            
+            SDL_SetRenderLogicalPresentation(pRenderer, (int)_screen_width, (int)_screen_height, SDL_LOGICAL_PRESENTATION_LETTERBOX);
 
-        pForeground_Texture = SDL_CreateTexture(pRenderer, 
-                SDL_PIXELFORMAT_ARGB4444, 
-                SDL_TEXTUREACCESS_STREAMING, 
-                (int)_screen_width/2, (int)_screen_height/2);
-        SDL_SetTextureScaleMode(pForeground_Texture, SDL_SCALEMODE_NEAREST); 
+            // build the display texture (the layers are composed into it)
+            pComposite_Texture = SDL_CreateTexture(pRenderer, 
+                    SDL_PIXELFORMAT_ARGB4444, 
+                    SDL_TEXTUREACCESS_STREAMING, 
+                    (int)_screen_width/2, (int)_screen_height/2);
+            SDL_SetTextureScaleMode(pComposite_Texture, SDL_SCALEMODE_NEAREST);
+            SDL_SetTextureBlendMode(pComposite_Texture, SDL_BLENDMODE_NONE);
+        }
 
     } // END OF SDL3 Initialization
 
     // Build The Color Palette
     _build_palette();
 
-    // Reserve 64k for the extended video buffer
-    int bfr_size = 64*1024;
-    _ext_video_buffer.reserve(bfr_size);
+    // the line renderers run for every display row
+    _video_start = MAP(VIDEO_START);
+    _video_end = MAP(VIDEO_END);
+
+    // Allocate 64k per page for the extended video buffer
+    int bfr_size = EXT_PAGES*64*1024;
+    _ext_video_buffer.resize(bfr_size);
   
     // initialize the font glyph buffer
     for (int i=0; i<256; i++)
@@ -422,22 +430,17 @@ void GPU::OnInit()
 void GPU::OnQuit()
 {
     std::cout << clr::indent() << clr::CYAN << "GPU::OnQuit() Entry" << clr::RETURN;
+
+    // flush and close any capture in progress
+    StopCapture();
     
     { // BEGIN OF SDL3 Shutdown
 
-        // destroy the textures
-        if (pExt_Texture) { 
-            SDL_DestroyTexture(pExt_Texture);
-            pExt_Texture = nullptr;
+        // destroy the display texture
+        if (pComposite_Texture) { 
+            SDL_DestroyTexture(pComposite_Texture);
+            pComposite_Texture = nullptr;
         }
-        if (pStd_Texture) { 
-            SDL_DestroyTexture(pStd_Texture);
-            pStd_Texture = nullptr;
-        }
-        if (pForeground_Texture) { 
-            SDL_DestroyTexture(pForeground_Texture);
-            pForeground_Texture = nullptr;
-        }   
      
         if (pRenderer)
         { // destroy the renderer
@@ -465,6 +468,8 @@ void GPU::OnActivate()
     // clear out the extended video buffer
     Word d=0;
     for (int i=0; i<(64*1024); i++) { _ext_video_buffer[i] = d++; }
+    _ext_draw = 0;
+    _ext_display = 0;
 
     // std::cout << clr::indent() << clr::CYAN << "GPU::OnActivate() Exit" << clr::RETURN;
 } // END: GPU::OnActivate()
@@ -590,6 +595,17 @@ void GPU::OnEvent(SDL_Event* evnt)
                         Memory::Write_Word(t, atch);
                     }    
 				}
+                // [R] Frame Capture Toggle
+                if (evnt->key.key == SDLK_R)
+                {
+                    if (_capture.IsActive()) {
+                        StopCapture();
+                    } else if (SDL_GetModState() & SDL_KMOD_SHIFT) {
+                        StartCapture(FrameCapture::FORMAT_RAW);     // [SHIFT] + [R] raw RGB24
+                    } else {
+                        StartCapture(FrameCapture::FORMAT_Y4M);
+                    }
+                }
                 if (evnt->key.key == SDLK_UP)
                 {
                     // toggle VSYNC
@@ -647,44 +663,71 @@ void GPU::OnUpdate(float fElapsedTime)
     if (runningTime > deltaTime + 0.01f) {
         deltaTime = fElapsedTime;
         runningTime = fElapsedTime;
-        SDL_SetWindowTitle(pWindow, Bus::GetTitle().c_str());
+        if (pWindow) { SDL_SetWindowTitle(pWindow, Bus::GetTitle().c_str()); }
         // std::cout << "FPS: " << Bus::FPS() << std::endl;
     }
     runningTime += fElapsedTime;   
 
+    // the scanline renderer on the CPU thread waits while the palette
+    // is rotated and this frame is composed
+    GPU_EXT* ext = Bus::GetGPU_EXT();
+    std::unique_lock<std::mutex> compose;
+    if (ext) { compose = std::unique_lock<std::mutex>(ext->ComposeMutex()); }
+
+    // palette cycling steps queued by the raster on the CPU thread
+    if (ext) { ext->ApplyPaletteCycles(); }
+
+    // sprite collisions are reported for skipped frames as well
+    if (ext) { ext->UpdateSprites(); }
+
+    // nothing is composed while the frame is skipped
+    if (Bus::GetSYS_EXT()->IsSkipping()) { return; }
+
     // GPU device runs before all other devices. 
     if (true) // Mouse Cursor and/or Foreground Sprites
     {
         // Clear the foreground texture 
-        _clear_texture(pForeground_Texture, 0x0, 0x0, 0x0, 0x0);
+        _clear_layer(LAYER_FG, 0x0, 0x0, 0x0, 0x0);
+        // render the hardware sprites
+        _update_sprite_buffer();
     }
 
-    // is extended graphics enabled?
-    // if (_gpu_options & 0b0001'0000)
-    if (_gpu_mode & 0b10000000'0000'0000)
+    // the scanline renderer composes the standard and extended
+    // displays on the CPU thread one line at a time as the raster
+    // advances; otherwise both are composed here once per frame
+    if (ext && ext->ScanlineMode())
     {
-        _render_extended_graphics(); 
-//std::cout << "GPU::OnRender() ---> Rendering Extended Texture" << std::endl;
+        _update_scanline_buffers();
     }
     else
     {
-        _clear_texture(pExt_Texture, 15, red(0), grn(0), blu(0));
-// std::cout << "GPU::OnRender() ---> Clearing Extended Texture" << std::endl;
-    }
+        // is extended graphics enabled?
+        // if (_gpu_options & 0b0001'0000)
+        if (_gpu_mode & 0b10000000'0000'0000)
+        {
+            _render_extended_graphics(); 
+    //std::cout << "GPU::OnRender() ---> Rendering Extended Texture" << std::endl;
+        }
+        else
+        {
+            _clear_layer(LAYER_EXT, 15, red(0), grn(0), blu(0));
+    // std::cout << "GPU::OnRender() ---> Clearing Extended Texture" << std::endl;
+        }
 
 
-    // is standard graphics enabled?
-    // if (_gpu_options & 0b0000'0001)
-    if (_gpu_mode & 0b0000'0000'1000'0000)
-    {
-        _render_standard_graphics();
-// std::cout << "GPU::OnRender() ---> Rendering Standard Texture" << std::endl;
+        // is standard graphics enabled?
+        // if (_gpu_options & 0b0000'0001)
+        if (_gpu_mode & 0b0000'0000'1000'0000)
+        {
+            _render_standard_graphics();
+    // std::cout << "GPU::OnRender() ---> Rendering Standard Texture" << std::endl;
+        }
+        else
+        {
+            _clear_layer(LAYER_STD, 0, 0, 0, 0);
+    // std::cout << "GPU::OnRender() ---> Clearing Standard Texture" << std::endl;
+        }    
     }
-    else
-    {
-        _clear_texture(pStd_Texture, 0, 0, 0, 0);
-// std::cout << "GPU::OnRender() ---> Clearing Standard Texture" << std::endl;
-    }    
 
     //std::cout << clr::indent() << clr::CYAN << "GPU::OnUpdate() Exit" << clr::RETURN;
 } // END: GPU::OnUpdate()
@@ -693,16 +736,22 @@ void GPU::OnUpdate(float fElapsedTime)
 void GPU::OnRender()
 {
     //std::cout << clr::indent() << clr::CYAN << "GPU::OnRender() Entry" << clr::RETURN;
-    SDL_FRect r{0.0f, 0.0f, _ext_width, _ext_height};
-
-    // render Extended Graphics
-    SDL_RenderTexture(pRenderer, pExt_Texture, &r, NULL);
+    if (GPU_HEADLESS) { 
+        _headless_frame(); 
+        return; 
+    }
 
-    // render Standard Graphics 
-    SDL_RenderTexture(pRenderer, pStd_Texture, &r, NULL);
+    // blend the extended, standard and foreground layers on the host and
+    // upload the result as one texture instead of blending three of them
+    _compose_layers();
+    SDL_Rect area{0, 0, (int)_ext_width, (int)_ext_height};
+    if (!SDL_UpdateTexture(pComposite_Texture, &area, _composite.data(), ((int)_screen_width/2) * sizeof(Uint16))) {
+        Bus::Error(SDL_GetError(), __FILE__, __LINE__);
+    }
+    SDL_FRect r{0.0f, 0.0f, _ext_width, _ext_height};
+    SDL_RenderTexture(pRenderer, pComposite_Texture, &r, NULL);
 
-    // render Foreground Graphics 
-    SDL_RenderTexture(pRenderer, pForeground_Texture, &r, NULL);
+    _capture_frame();
 
     //std::cout << clr::indent() << clr::CYAN << "GPU::OnRender() Exit" << clr::RETURN;
 } // END: GPU::OnRender()
@@ -712,394 +761,629 @@ void GPU::OnRender()
 void GPU::_render_extended_graphics()
 {    
     //    GPU_EXT_MODE          = 0xFE02, // (Byte) Extended Graphics Mode
-    int _width = _ext_width;
-    int _height = _ext_height;
 
-    // clear the extended texture
-    _clear_texture(pExt_Texture, 0, red(0), grn(0), blu(0));
+    // is the extended display enabled
+    if ((_gpu_mode & 0b1000'0000'0000'0000)==0)
+    {
+        _clear_layer(LAYER_EXT, 0, red(0), grn(0), blu(0));
+        return; 
+    }
+
+    // compose the display one line at a time
+    int pitch;
+    void* pixels = _layer_pixels(LAYER_EXT, &pitch);
+    for (int y = 0; y < (int)_ext_height; y++) {
+        _render_ext_line((Uint16*)((Uint8*)pixels + (y * pitch)), y);
+    }
+} // END: GPU::_render_extended_graphics()
+
+void GPU::_render_standard_graphics()
+{
+    // compose the display one line at a time
+    int pitch;
+    void* pixels = _layer_pixels(LAYER_STD, &pitch);
+    for (int y = 0; y < (int)_std_height; y++) {
+        _render_std_line((Uint16*)((Uint8*)pixels + (y * pitch)), y);
+    }
+} // END: GPU::_render_standard_graphics()
+
+
+/**
+ * Renders one pixel row of the extended display (tilemap or bitmap) into
+ * an ARGB4444 line. Used for whole frames by _render_extended_graphics()
+ * on the main thread and, one line at a time as the raster advances, by
+ * the scanline renderer on the CPU thread. Either caller holds the
+ * GPU_EXT compose mutex, so the two never share the tile cache even
+ * while GPU_RASTER_CTRL switches between them.
+ *
+ * @param dst The destination line (at least _ext_width pixels).
+ * @param y The display row to render.
+ */
+void GPU::_render_ext_line(Uint16* dst, int y)
+{
+    int width = (int)_ext_width;
+    Word blank = (red(0)<<8) | (grn(0)<<4) | blu(0);
 
     // is the extended display enabled
     if ((_gpu_mode & 0b1000'0000'0000'0000)==0)
-        return; // nope, just return
+    {
+        std::fill(dst, dst + width, 0xF000 | blank);
+        return;
+    }
 
     // IS Extended Display In Tiled Mode?
     if ( (_gpu_mode & 0b0000'1000'0000'0000) == 0)
     { 
-        // TODO: render tiled graphics
-        //std::cout << "GPU::_render_extended_graphics() ---> Displaying extended tilemap buffer" << std::endl;
-        _update_tile_buffer();
-    } else {
-        // extended bitmap mode
-        int bpp = 0;
-        // switch((_gpu_options & 0b0110'0000)>>5)
-        switch( ((_gpu_mode & 0b0011'0000'0000'0000)>>12)& 0x03 )    // extended color mode bits
+        std::fill(dst, dst + width, blank);
+        GPU_EXT* ext = Bus::GetGPU_EXT();
+        if (ext) { ext->RenderTilemapLine(dst, width, y); }
+        return;
+    }
+
+    // extended bitmap mode (1, 2, 4 or 8 bits per pixel)
+    int bpp = 1 << (((_gpu_mode & 0b0011'0000'0000'0000)>>12) & 0x03);
+    int ppb = 8 / bpp;                  // pixels per byte
+    Byte mask = (1 << bpp) - 1;
+    y = (y + _ext_scroll_y) % (int)_ext_height;
+    int pixel_index = y * ((width * bpp) / 8);
+    const Byte* vram = _ext_display_page();
+    for (int x = 0; x < width; )
+    {
+        Byte data = vram[pixel_index++];
+        for (int b = 0; b < ppb; b++)
         {
-            case 0x00: bpp = 1; break;
-            case 0x01: bpp = 2; break;
-            case 0x02: bpp = 4; break;
-            case 0x03: bpp = 8; break;
+            Byte index = (data >> (8 - bpp * (b + 1))) & mask;
+            dst[x++] = index ? (0xF000 | (_palette[index].color & 0x0FFF)) : 0x0000;
         }
-        // display the extended bitmap buffer
-        Word pixel_index = 0x0000;
-        void *pixels;
-        int pitch;
-        if (!SDL_LockTexture(pExt_Texture, NULL, (void **)&pixels, &pitch))
-            Bus::Error(SDL_GetError());	
-        else
-        {
-            for (int y = 0; y < _height; y++)
-            {
-                for (int x = 0; x < _width; )
-                {
-                    // 256 color mode
-                    if (bpp == 8)
-                    {
-                        Byte index = _ext_video_buffer[pixel_index++];
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 16 color mode
-                    else if (bpp == 4)
-                    {
-                        Byte data = _ext_video_buffer[pixel_index++];
-                        Byte index = (data >> 4);
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data & 0x0f);
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 4 color mode
-                    else if (bpp == 2)
-                    {
-                        Byte data = _ext_video_buffer[pixel_index++];
-                        Byte index = (data >> 6) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 4) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 2) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 0) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 2 color mode
-                    else if (bpp == 1)
-                    {
-                        Byte data = _ext_video_buffer[pixel_index++];
-                        Byte index = (data >> 7) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true); 
-                        index = (data >> 6) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 5) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 4) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 3) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 2) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 1) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 0) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    if (pixel_index >  _ext_video_buffer.capacity()) {
-                        // std::string err = "Pixel index out of range: " + std::to_string(pixel_index);
-                        // Bus::Error(err.c_str());
-                        SDL_UnlockTexture(pExt_Texture);
-                        return;
-                    }
-                }
-            }
-            SDL_UnlockTexture(pExt_Texture); 
-        }        
     }
-} // END: GPU::_render_extended_graphics()
+    int sx = _ext_scroll_x % width;
+    if (sx) { std::rotate(dst, dst + sx, dst + width); }
+} // END: GPU::_render_ext_line()
 
-void GPU::_render_standard_graphics()
+
+/**
+ * Renders one pixel row of the standard display into an ARGB4444 line,
+ * offset by GPU_STD_SCROLL_X and GPU_STD_SCROLL_Y. The display wraps
+ * around in both directions, so scrolling never moves video memory.
+ *
+ * @param dst The destination line (at least _std_width pixels).
+ * @param y The display row to render.
+ */
+void GPU::_render_std_line(Uint16* dst, int y)
 {
-    // clear the standard texture
-    _clear_texture(pStd_Texture, 0, 0, 0, 0);
+    int width = (int)_std_width;
+    _render_std_row(dst, (y + _std_scroll_y) % (int)_std_height);
+    int sx = _std_scroll_x % width;
+    if (sx) { std::rotate(dst, dst + sx, dst + width); }
+} // END: GPU::_render_std_line()
+
+
+/**
+ * Renders one unscrolled pixel row of the standard display (text or
+ * bitmap). Text colors are scaled by their palette alpha, as if
+ * blended over black, and written opaque.
+ */
+void GPU::_render_std_row(Uint16* dst, int y)
+{
+    int width = (int)_std_width;
 
     // is the standard display enabled
-    // if ((_gpu_options & 0b0000'0001)==0)
     if ((_gpu_mode & 0b0000'0000'1000'0000)==0)
+    {
+        std::fill(dst, dst + width, 0x0000);
         return;
-
-    // Render the Standard Display Buffer
-    // if ( (_gpu_mode & 0b1000'0000) == 0) 
+    }
 
     // IS Standard Display Rendering Text?
     if ( (_gpu_mode & 0b0000'0000'0000'1000) == 0) 
     { 
-        _update_text_buffer();        
-    } 
-    else
-    { // Standard Display Rendering Graphics
-        int bpp = 0;
-        int div = 0;
-        // int std_color_mode = (_gpu_mode & 0b0110'0000) >> 5;
-        int std_color_mode = ((_gpu_mode & 0b0000'0000'0011'0000) >> 4) & 0x03;
-        int buffer_size;
-
-        // Reduce the standard color mode if necessary. This
-        // should already fit, but this is a safety check.
-        do
+        // the 16 text colors blended over the cleared texture
+        Word lut[16];
+        for (int c = 0; c < 16; c++)
         {
-            switch(std_color_mode)
-            {
-                case 0x00: div = 8; bpp = 1; break;
-                case 0x01: div = 4; bpp = 2; break;
-                case 0x02: div = 2; bpp = 4; break;
-                case 0x03: div = 1; bpp = 8; break;
-            }            
-            buffer_size = (_std_width * _std_height)/div;
-            std_color_mode--;
-        } while (buffer_size > 8000);
-
-        // display the standard bitmap buffer
-        Word pixel_index = MAP(VIDEO_START);
-        void *pixels;
-        int pitch;
-        if (!SDL_LockTexture(pStd_Texture, NULL, (void **)&pixels, &pitch))
-            Bus::Error(SDL_GetError());	
-        else
+            Byte a = alf(c);
+            lut[c] = (a == 0) ? 0x0000 : (0xF000 |
+                (((red(c) * (a+1)) >> 4) << 8) |
+                (((grn(c) * (a+1)) >> 4) << 4) |
+                 ((blu(c) * (a+1)) >> 4));
+        }
+        int cols = width / 8;
+        int v = y % 8;
+        Word addr = _video_start + ((y / 8) * cols * 2);
+        for (int col = 0; col < cols; col++, addr += 2)
         {
-            for (int y = 0; y < _std_height; y++)
-            {
-                for (int x = 0; x < _std_width; )
-                {
-                    // 256 color mode
-                    if (bpp == 8)
-                    {
-                        Byte index = Memory::Read(pixel_index++);
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 16 color mode
-                    else if (bpp == 4)
-                    {
-                        Byte data = Memory::Read(pixel_index++);
-                        Byte index = (data >> 4);
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data & 0x0f);
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 4 color mode
-                    else if (bpp == 2)
-                    {
-                        Byte data = Memory::Read(pixel_index++);
-                        Byte index = (data >> 6) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 4) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 2) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 0) & 0x03;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-                    // 2 color mode
-                    else if (bpp == 1)
-                    {
-                        Byte data = Memory::Read(pixel_index++);
-                        Byte index = (data >> 7) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true); 
-                        index = (data >> 6) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 5) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 4) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 3) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 2) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 1) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                        index = (data >> 0) & 1;
-                        _setPixel_unlocked(pixels, pitch, x++, y, index, true);   
-                    }
-
-                    if (pixel_index > MAP(VIDEO_END)) {
-                        std::string err = "Pixel index out of range: $" + clr::hex(pixel_index, 4);
-                        Bus::Error(err.c_str(), __FILE__, __LINE__);
-                        SDL_UnlockTexture(pStd_Texture); 
-                        return;
-                    }
-                }
+            Byte at = Memory::Read(addr+0, true);
+            Byte ch = Memory::Read(addr+1, true);
+            Byte gd = GetGlyphData(ch, v);
+            Word bg = lut[at >> 4];
+            Word fg = lut[at & 0x0f];
+            for (int h = 0; h < 8; h++) {
+                *dst++ = (gd & (0x80 >> h)) ? fg : bg;
             }
-            SDL_UnlockTexture(pStd_Texture); 
-        }        
+        }
+        return;
     }
-} // END: GPU::_render_standard_graphics()
 
-void GPU::_update_text_buffer() {
+    // Standard Display Rendering Graphics
+    int bpp = 0;
+    int div = 0;
+    int std_color_mode = ((_gpu_mode & 0b0000'0000'0011'0000) >> 4) & 0x03;
+    int buffer_size;
+
+    // Reduce the standard color mode if necessary. This
+    // should already fit, but this is a safety check.
+    do
+    {
+        switch(std_color_mode)
+        {
+            case 0x00: div = 8; bpp = 1; break;
+            case 0x01: div = 4; bpp = 2; break;
+            case 0x02: div = 2; bpp = 4; break;
+            case 0x03: div = 1; bpp = 8; break;
+        }            
+        buffer_size = (_std_width * _std_height)/div;
+        std_color_mode--;
+    } while (buffer_size > 8000);
+
+    int ppb = 8 / bpp;                  // pixels per byte
+    Byte mask = (1 << bpp) - 1;
+    int row_bytes = (width * bpp) / 8;
+    int pixel_index = _video_start + (y * row_bytes);
+    if (pixel_index + row_bytes - 1 > _video_end) { return; }
+    for (int x = 0; x < width; )
+    {
+        Byte data = Memory::Read(pixel_index++, true);
+        for (int b = 0; b < ppb; b++)
+        {
+            Byte index = (data >> (8 - bpp * (b + 1))) & mask;
+            dst[x++] = index ? (0xF000 | (red(index)<<8) | (grn(index)<<4) | blu(index)) : 0x0000;
+        }
+    }
+} // END: GPU::_render_std_row()
+
+
+void GPU::_update_sprite_buffer()
+{
+    // the sprites are rendered by the extended graphics device
+    GPU_EXT* ext = Bus::GetGPU_EXT();
+    if (ext == nullptr) { return; }
 
-    bool ignore_alpha = false;
-    void *pixels;
     int pitch;
+    void* pixels = _layer_pixels(LAYER_FG, &pitch);
+    ext->RenderSprites(pixels, pitch, (int)_std_width, (int)_std_height);
+} // END: GPU::_update_sprite_buffer()
+
+
+void GPU::_update_scanline_buffers()
+{
+    // copy the last frame completed by the scanline renderer
+    int std_pitch, ext_pitch;
+    void* std_pixels = _layer_pixels(LAYER_STD, &std_pitch);
+    void* ext_pixels = _layer_pixels(LAYER_EXT, &ext_pitch);
+    Bus::GetGPU_EXT()->CopyScanlines(std_pixels, std_pitch, ext_pixels, ext_pitch);
+} // END: GPU::_update_scanline_buffers()
+
+
+/**
+ * Returns the host buffer of a display layer. The layers are plain
+ * memory; OnRender() uploads the composed result as one texture.
+ */
+void* GPU::_layer_pixels(int layer, int* pitch)
+{
+    *pitch = ((int)_screen_width/2) * sizeof(Uint16);
+    return _soft_layer[layer].data();
+} // END: GPU::_layer_pixels()
+
+
 
-    // lock the standard texture
-    if (!SDL_LockTexture(pStd_Texture, NULL, &pixels, &pitch)) {
-        Bus::Error(SDL_GetError());
+/**********************
+* Software Compositor *
+**********************/
+
+
+/**
+ * Blends an ARGB4444 source pixel over an opaque destination pixel. The
+ * three color channels are spread into 16 bit lanes of one 64 bit word
+ * ($000R'000G'000B) and blended together, dividing by 15 with rounding
+ * as (v * 17 + 128) >> 8. The result is always opaque.
+ */
+Uint16 GPU::BlendPixel(Uint16 dst, Uint16 src)
+{
+    auto spread = [](Uint16 p) -> uint64_t {
+        return ((uint64_t)(p & 0x0F00) << 24) | ((uint64_t)(p & 0x00F0) << 12) | (p & 0x000F);
+    };
+    uint64_t a = src >> 12;
+    uint64_t v = spread(src) * a + spread(dst) * (15 - a);
+    v = ((v * 17 + 0x0080'0080'0080) >> 8) & 0x000F'000F'000F;
+    return (Uint16)(0xF000 | ((v >> 24) & 0x0F00) | ((v >> 12) & 0x00F0) | (v & 0x000F));
+} // END: GPU::BlendPixel()
+
+
+/**
+ * Blends one row of a layer over the composed row. Four pixels are tested
+ * at a time: fully transparent quads are skipped and fully opaque quads
+ * are copied, so only the edges of translucent areas are blended.
+ */
+void GPU::_compose_span(Uint16* dst, const Uint16* src, int count)
+{
+    constexpr uint64_t ALPHA4 = 0xF000'F000'F000'F000;
+    int x = 0;
+    while (x < count)
+    {
+        if (x + 4 <= count)
+        {
+            uint64_t quad;
+            std::memcpy(&quad, src + x, sizeof(quad));
+            if ((quad & ALPHA4) == 0) { x += 4; continue; }
+            if ((quad & ALPHA4) == ALPHA4) {
+                std::memcpy(dst + x, src + x, sizeof(quad));
+                x += 4;
+                continue;
+            }
+        }
+        Uint16 p = src[x];
+        if ((p & 0xF000) == 0xF000) { dst[x] = p; }
+        else if (p & 0xF000) { dst[x] = BlendPixel(dst[x], p); }
+        x++;
     }
-    else
-    { // Render the text
-        Byte col = _std_width / 8;
-        Byte row = _std_height / 8;
-        Word end = ((col*row)*2) + MAP(VIDEO_START);
-        // Word end  = VIDEO_START+128;
-		Word addr = MAP(VIDEO_START);
-		for (; addr < end; addr += 2)
-		{
-			// Byte at = Memory::Read(addr+0, true);
-			// Byte ch = Memory::Read(addr+1, true);
-			Byte at = Memory::Read(addr+0, true);
-			Byte ch = Memory::Read(addr+1, true);
-			Byte bg = at >> 4;
-			Byte fg = at & 0x0f;
-			Word index = addr - MAP(VIDEO_START);
-			Byte width = _std_width / 8;
-			int x = ((index / 2) % width) * 8;
-			int y = ((index / 2) / width) * 8;
-			for (int v = 0; v < 8; v++)
-			{
-				for (int h = 0; h < 8; h++)
-				{
-					int color = bg;
-                    Byte gd = GetGlyphData(ch, v);
-					if (gd & (1 << (7 - h)))
-						color = fg;
-					_setPixel_unlocked(pixels, pitch, x + h, y + v, color, ignore_alpha);
-				}
-			}
-		}
-        SDL_UnlockTexture(pStd_Texture); 
+} // END: GPU::_compose_span()
+
+
+/**
+ * Composes the extended, standard and foreground layers, in that order,
+ * over black into _composite (ARGB4444, _ext_width x _ext_height).
+ */
+void GPU::_compose_layers()
+{
+    int width = (int)_ext_width;
+    int height = (int)_ext_height;
+    int stride = (int)_screen_width/2;
+    for (int y = 0; y < height; y++)
+    {
+        Uint16* dst = &_composite[y * stride];
+        std::fill(dst, dst + width, 0xF000);
+        for (int l = 0; l < LAYER_COUNT; l++) {
+            _compose_span(dst, &_soft_layer[l][y * stride], width);
+        }
     }
-} 
+} // END: GPU::_compose_layers()
 
 
-void GPU::_update_tile_buffer()
+// widen the composed layers to an ARGB8888 frame
+void GPU::_expand_composite(std::vector<Uint32>& frame)
 {
-    // for now just color cycle the extended video buffer
-    static Byte clr = 1;
-    static int delta = 1;
-    static Byte r = 0;
-    static Byte g = 0;
-    static Byte b = 0;
-    Byte a = 15;
-
-    static Uint64 _last_time = SDL_GetTicks();
-    if (SDL_GetTicks() - _last_time > 25) {
-        _last_time = SDL_GetTicks();
-    
-        if (clr & 0b0000'0100)  r+=delta;
-        if (clr & 0b0000'0010)  g+=delta;
-        if (clr & 0b0000'0001)  b+=delta;
-
-        // reverse delta
-        if (r == 8 || g == 8 || b == 8) { delta *= -1; }
-        if (r == 0 || g == 0 || b == 0) {
-            delta *= -1;
-            clr ++;
-            if (clr > 15)
-                clr = 1;
+    int width = (int)_ext_width;
+    int height = (int)_ext_height;
+    int stride = (int)_screen_width/2;
+    frame.resize(width * height);
+    for (int y = 0; y < height; y++)
+    {
+        const Uint16* src = &_composite[y * stride];
+        Uint32* out = &frame[y * width];
+        for (int x = 0; x < width; x++)
+        {
+            Uint32 p = src[x];
+            out[x] = 0xFF000000 | (((p >> 8) & 0x0f) * 0x110000) | (((p >> 4) & 0x0f) * 0x1100) | ((p & 0x0f) * 0x11);
         }
     }
-    _clear_texture(pExt_Texture, a, r, g, b);
-}
+} // END: GPU::_expand_composite()
 
 
 /**
- * Sets a pixel in the given surface without locking the surface.
+ * Composes the extended, standard and foreground layers exactly as they
+ * are displayed.
  *
- * This function combines the pixel color with the color index, using the alpha channel
- * of the color index as the alpha value for the combination. If bIgnoreAlpha is true,
- * the alpha value is ignored and the pixel color is set to the color index if the color
- * index is not transparent.
- *
- * @param pixels The surface to draw on.
- * @param pitch The pitch of the surface.
- * @param x The x coordinate of the pixel.
- * @param y The y coordinate of the pixel.
- * @param color_index The color index to use.
- * @param bIgnoreAlpha If true, the alpha value is ignored.
+ * @param frame Receives _ext_width x _ext_height ARGB8888 pixels.
+ */
+void GPU::ComposeFrame(std::vector<Uint32>& frame)
+{
+    _compose_layers();
+    _expand_composite(frame);
+} // END: GPU::ComposeFrame()
+
+
+/**
+ * Writes an ARGB8888 frame as a binary (P6) portable pixmap.
  */
-void GPU::_setPixel_unlocked(void* pixels, int pitch, int x, int y, Byte color_index, bool bIgnoreAlpha)
+bool GPU::WritePPM(const std::string& filename, const std::vector<Uint32>& frame, int width, int height)
 {
-    Uint16 *dst = (Uint16*)((Uint8*)pixels + (y * pitch) + (x*sizeof(Uint16)));		// because data size is two bytes 
-
-    bool cls = false;
-    if (color_index ==0 && bIgnoreAlpha)
-        cls = true;
-
-    if (!bIgnoreAlpha)
-    {       
-        // int ret = ((p1 * (256-a))) + (p2 * (a+1)) >> 8;
-        Uint16 pixel = *dst;	// 0xARGB
-		Byte r1 = (pixel & 0x0f00) >> 8;
-		Byte g1 = (pixel & 0x00f0) >> 4;
-		Byte b1 = (pixel & 0x000f) >> 0;
-		//
-        Byte a2 = alf(color_index);
-        Byte r2 = red(color_index);
-        Byte g2 = grn(color_index);
-        Byte b2 = blu(color_index);
-        // if (bIgnoreAlpha)
-        //     a2 = 15;
-		//
-        Byte r = (((r1 * (16-a2))) + (r2 * (a2+1))) >> 4;
-        Byte g = (((g1 * (16-a2))) + (g2 * (a2+1))) >> 4;
-        Byte b = (((b1 * (16-a2))) + (b2 * (a2+1))) >> 4;
-
-        if (alf(color_index) != 0) // || bIgnoreAlpha)
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs.is_open()) { return false; }
+    ofs << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<char> row(width * 3);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
         {
-            *dst = (
-                0xF000 | 
-                (r<<8) | 
-                (g<<4) | 
-                (b)
-            );                
-		}	
+            Uint32 p = frame[y * width + x];
+            row[x * 3 + 0] = (char)((p >> 16) & 0xFF);
+            row[x * 3 + 1] = (char)((p >>  8) & 0xFF);
+            row[x * 3 + 2] = (char)((p >>  0) & 0xFF);
+        }
+        ofs.write(row.data(), row.size());
     }
-    else
-    {        
-        if (cls)
+    return ofs.good();
+} // END: GPU::WritePPM()
+
+
+/**
+ * Reads a binary (P6) portable pixmap with 8-bit channels into an
+ * ARGB8888 frame.
+ */
+bool GPU::ReadPPM(const std::string& filename, std::vector<Uint32>& frame, int& width, int& height)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs.is_open()) { return false; }
+    // header fields are separated by whitespace and may be followed by # comments
+    auto field = [&ifs]() -> std::string {
+        std::string tok;
+        while (ifs >> tok && tok[0] == '#') { std::getline(ifs, tok); }
+        return tok;
+    };
+    if (field() != "P6") { return false; }
+    width = std::atoi(field().c_str());
+    height = std::atoi(field().c_str());
+    if (width <= 0 || height <= 0 || std::atoi(field().c_str()) != 255) { return false; }
+    ifs.get();      // the single whitespace before the pixel data
+    std::vector<unsigned char> data(width * height * 3);
+    if (!ifs.read((char*)data.data(), data.size())) { return false; }
+    frame.resize(width * height);
+    for (int i = 0; i < width * height; i++) {
+        frame[i] = 0xFF000000 | (data[i * 3] << 16) | (data[i * 3 + 1] << 8) | data[i * 3 + 2];
+    }
+    return true;
+} // END: GPU::ReadPPM()
+
+
+int GPU::CompareFrames(const std::vector<Uint32>& a, const std::vector<Uint32>& b, int tolerance)
+{
+    if (a.size() != b.size()) { return -1; }
+    int mismatched = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (int shift = 0; shift < 24; shift += 8)
         {
-            *dst = 0x0000;
+            int d = (int)((a[i] >> shift) & 0xFF) - (int)((b[i] >> shift) & 0xFF);
+            if (std::abs(d) > tolerance) { mismatched++; break; }
         }
-        else
+    }
+    return mismatched;
+} // END: GPU::CompareFrames()
+
+
+void GPU::_headless_frame()
+{
+    ComposeFrame(_frame);
+    _capture_frame();
+    _frame_count++;
+    int width = (int)_ext_width;
+    int height = (int)_ext_height;
+
+    if (_dump_requested || (GPU_DUMP_EVERY > 0 && _frame_count % GPU_DUMP_EVERY == 0))
+    {
+        _dump_requested = false;
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06d.ppm", _frame_count);
+        std::filesystem::create_directories(GPU_DUMP_PATH);
+        std::string file = std::string(GPU_DUMP_PATH) + name;
+        if (!WritePPM(file, _frame, width, height)) {
+            Bus::Error("Unable to write " + file, __FILE__, __LINE__);
+        }
+
+        // compare against a golden image of the same name, if there is one
+        std::string golden = std::string(GPU_GOLDEN_PATH) + name;
+        if (std::filesystem::exists(golden))
         {
-            *dst = 
-            (
-                0xF000 |
-                (red(color_index)<<8) |
-                (grn(color_index)<<4) |
-                 blu(color_index)
-            );    
+            std::vector<Uint32> expected;
+            int w = 0, h = 0;
+            int bad = -1;
+            if (ReadPPM(golden, expected, w, h) && w == width && h == height) {
+                bad = CompareFrames(_frame, expected, GPU_GOLDEN_TOLERANCE);
+            }
+            if (bad == 0) {
+                UnitTest::Log(this, std::string(name) + " matches its golden image");
+            } else {
+                UnitTest::Log(this, clr::RED + name + " golden image compare FAILED (" +
+                    (bad < 0 ? std::string("size mismatch") : std::to_string(bad) + " pixels") + ")");
+            }
         }
     }
-} // END: GPU::_setPixel_unlocked()
 
-void GPU::_clear_texture(SDL_Texture* texture, Byte a, Byte r, Byte g, Byte b)
+    if (GPU_HEADLESS_FRAMES > 0 && _frame_count >= GPU_HEADLESS_FRAMES) {
+        Bus::IsRunning(false);
+    }
+} // END: GPU::_headless_frame()
+
+
+/**
+ * Starts streaming composed frames to the next free capture_NNN file in
+ * GPU_CAPTURE_PATH. Raw RGB24 files carry their dimensions in the name.
+ */
+bool GPU::StartCapture(FrameCapture::FORMAT format)
+{
+    _capture_started = true;
+    int width = (int)_ext_width;
+    int height = (int)_ext_height;
+    std::filesystem::create_directories(GPU_CAPTURE_PATH);
+    std::string file;
+    for (int n = 0; file.empty() || std::filesystem::exists(file); n++)
+    {
+        char name[64];
+        if (format == FrameCapture::FORMAT_Y4M) {
+            std::snprintf(name, sizeof(name), "capture_%03d.y4m", n);
+        } else {
+            std::snprintf(name, sizeof(name), "capture_%03d_%dx%d.rgb", n, width, height);
+        }
+        file = std::string(GPU_CAPTURE_PATH) + name;
+    }
+    if (!_capture.Start(file, format, width, height, GPU_EXT::RASTER_HZ)) {
+        std::cout << clr::indent() << clr::ORANGE << "Unable to create " << file << clr::RETURN;
+        return false;
+    }
+    std::cout << clr::indent() << clr::CYAN << "Capturing to " << file << clr::RETURN;
+    return true;
+} // END: GPU::StartCapture()
+
+
+void GPU::StopCapture()
+{
+    if (!_capture.IsActive()) { return; }
+    _capture.Stop();
+    std::cout << clr::indent() << clr::CYAN << "Capture stopped: " 
+              << _capture.Written() << " frames, " 
+              << _capture.Repeated() << " repeats, " 
+              << _capture.Dropped() << " dropped" << clr::RETURN;
+} // END: GPU::StopCapture()
+
+
+void GPU::_capture_frame()
+{
+    if (GPU_CAPTURE && !_capture_started) {
+        StartCapture(GPU_CAPTURE == 2 ? FrameCapture::FORMAT_RAW : FrameCapture::FORMAT_Y4M);
+    }
+    if (!_capture.IsActive()) { return; }
+    // the writer thread converts the composed ARGB4444 layers; a display
+    // mode change ends the capture, the stream has a fixed size
+    int pitch = ((int)_screen_width/2) * sizeof(Uint16);
+    if (!_capture.Submit(_composite.data(), (int)_ext_width, (int)_ext_height, pitch)) {
+        StopCapture();
+    }
+} // END: GPU::_capture_frame()
+
+
+bool GPU::OnTest()
+{
+    bool test_results = true;
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Software Compositor" + clr::RESET);
+
+    int width = (int)_ext_width;
+    int height = (int)_ext_height;
+    int stride = (int)_screen_width/2;
+    std::vector<Uint16> saved[LAYER_COUNT];
+    for (int l = 0; l < LAYER_COUNT; l++) { 
+        saved[l] = _soft_layer[l]; 
+        std::fill(_soft_layer[l].begin(), _soft_layer[l].end(), 0x0000);
+    }
+
+    // an opaque extended pixel under a half transparent standard pixel;
+    // the next pixel shows black through all three transparent layers
+    _soft_layer[LAYER_EXT][0] = 0xF123;
+    _soft_layer[LAYER_STD][0] = 0x8FFF;
+    _soft_layer[LAYER_FG][stride] = 0xF0F0;
+    std::vector<Uint32> frame;
+    ComposeFrame(frame);
+    if (!ASSERT_TRUE(frame.size() == (size_t)(width * height) && frame[0] == 0xFF889999 && frame[1] == 0xFF000000 && frame[width] == 0xFF00FF00)) {
+        UnitTest::Log(this, clr::RED + "layers were not blended correctly");
+        test_results = false;
+    }
+
+    // the span fast paths must match blending every pixel on its own:
+    // an opaque quad, a transparent quad, a mixed quad and a short tail
+    Uint16 span_src[14] = { 0xF111, 0xF222, 0xF333, 0xF444, 0, 0, 0, 0,
+                            0x8FFF, 0x0000, 0xF0F0, 0x4F00, 0x8888, 0xF00F };
+    Uint16 span_dst[14], span_ref[14];
+    for (int x = 0; x < 14; x++) { span_dst[x] = span_ref[x] = (Uint16)(0xF000 | (x * 0x111)); }
+    _compose_span(span_dst, span_src, 14);
+    for (int x = 0; x < 14; x++) {
+        if (span_src[x] & 0xF000) { span_ref[x] = BlendPixel(span_ref[x], span_src[x]); }
+    }
+    if (!ASSERT_TRUE(std::equal(span_dst, span_dst + 14, span_ref) && BlendPixel(0xF123, 0xFABC) == 0xFABC && BlendPixel(0xF000, 0x8FFF) == 0xF888)) {
+        UnitTest::Log(this, clr::RED + "compositor spans do not match the per pixel blend");
+        test_results = false;
+    }
+
+    // round trip through a PPM file and compare with a tolerance
+    std::string file = (std::filesystem::temp_directory_path() / "retro_6809_gpu_test.ppm").string();
+    std::vector<Uint32> loaded;
+    int w = 0, h = 0;
+    if (!ASSERT_TRUE(WritePPM(file, frame, width, height) && ReadPPM(file, loaded, w, h) && w == width && h == height && loaded == frame)) {
+        UnitTest::Log(this, clr::RED + "PPM frame dump did not read back identically");
+        test_results = false;
+    }
+    std::filesystem::remove(file);
+    loaded = frame;
+    loaded[0] += 0x00000002;
+    if (!ASSERT_TRUE(CompareFrames(frame, loaded, 2) == 0 && CompareFrames(frame, loaded, 1) == 1)) {
+        UnitTest::Log(this, clr::RED + "frame compare tolerance is incorrect");
+        test_results = false;
+    }
+
+    for (int l = 0; l < LAYER_COUNT; l++) { _soft_layer[l] = saved[l]; }
+
+    // a scrolled row is the wrapped row below it, rotated left; the last
+    // display row wraps around to the first
+    int std_width = (int)_std_width;
+    int std_height = (int)_std_height;
+    std::vector<Uint16> plain(std_width), scrolled(std_width);
+    _std_scroll_x = (Word)(std_width + 13);
+    _std_scroll_y = 11;
+    _render_std_row(plain.data(), (std_height - 1 + 11) % std_height);
+    std::rotate(plain.begin(), plain.begin() + 13, plain.end());
+    _render_std_line(scrolled.data(), std_height - 1);
+    _std_scroll_x = 0;
+    _std_scroll_y = 0;
+    if (!ASSERT_TRUE(plain == scrolled)) {
+        UnitTest::Log(this, clr::RED + "GPU_STD_SCROLL_X/Y did not wrap the display");
+        test_results = false;
+    }
+
+    // capture three identical frames (the second differs only in its row
+    // padding, the last one is skipped rather than composed) and a changed
+    // one: two frames are encoded, the others are written as repeats of
+    // the first
+    FrameCapture capture;
+    file = (std::filesystem::temp_directory_path() / "retro_6809_gpu_test.y4m").string();
+    Uint16 white_black[3] = { 0xFFFF, 0xF000, 0x0123 };      // the last pixel is row padding
+    Uint16 white_black2[3] = { 0xFFFF, 0xF000, 0x0456 };
+    Uint16 black_white[3] = { 0xF000, 0xFFFF, 0x0123 };
+    int pitch = 3 * sizeof(Uint16);
+    std::string stream;
+    if (capture.Start(file, FrameCapture::FORMAT_Y4M, 2, 1, GPU_EXT::RASTER_HZ))
+    {
+        capture.Submit(white_black, 2, 1, pitch);
+        capture.Submit(white_black2, 2, 1, pitch);
+        capture.Repeat();
+        capture.Submit(black_white, 2, 1, pitch);
+        capture.Stop();
+        std::ifstream ifs(file, std::ios::binary);
+        stream.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    std::filesystem::remove(file);
+    std::string header = "YUV4MPEG2 W2 H1 F70:1 Ip A1:1 C444\n";
+    std::string frame_wb = std::string("FRAME\n") + "\xEB\x10\x80\x80\x80\x80";
+    std::string frame_bw = std::string("FRAME\n") + "\x10\xEB\x80\x80\x80\x80";
+    if (!ASSERT_TRUE(stream == header + frame_wb + frame_wb + frame_wb + frame_bw && 
+                     capture.Written() == 2 && capture.Repeated() == 2 && capture.Dropped() == 0)) {
+        UnitTest::Log(this, clr::RED + "frame capture stream is incorrect");
+        test_results = false;
+    }
+
+    if (test_results)
+        UnitTest::Log(this, "Unit Tests PASSED");
+    else
+        UnitTest::Log(this, clr::RED + "Unit Tests FAILED");
+    return test_results;
+} // END: GPU::OnTest()
+
+
+void GPU::_clear_layer(int layer, Byte a, Byte r, Byte g, Byte b)
 {
     a&=0x0f; r&=0x0f; g&=0x0f; b&=0x0f;
-    void *pixels;
     int pitch;
-    if (!SDL_LockTexture(texture, NULL, &pixels, &pitch)) {
-        Bus::Error(SDL_GetError());
-    } else {
-        for (int y = 0; y < _std_height; y++)
+    void* pixels = _layer_pixels(layer, &pitch);
+    for (int y = 0; y < _std_height; y++)
+    {
+        for (int x = 0; x < _std_width; x++)
         {
-            for (int x = 0; x < _std_width; x++)
-            {
-                Uint16 *dst = (Uint16*)((Uint8*)pixels + (y * pitch) + (x*sizeof(Uint16)));
-                *dst = (
-                    (a<<12) | 
-                    (r<<8)  | 
-                    (g<<4)  | 
-                    (b<<0) );          
+            Uint16 *dst = (Uint16*)((Uint8*)pixels + (y * pitch) + (x*sizeof(Uint16)));
+            *dst = (
+                (a<<12) | 
+                (r<<8)  | 
+                (g<<4)  | 
+                (b<<0) );          
 
-            }
         }
-        SDL_UnlockTexture(texture); 
-    }    
+    }
 }
 
 /**
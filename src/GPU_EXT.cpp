@@ -0,0 +1,2500 @@
+/*** GPU_EXT.cpp *******************************************
+ *     _____ _____  _    _     ________   _________
+ *    / ____|  __ \| |  | |   |  ____\ \ / /__   __|
+ *   | |  __| |__) | |  | |   | |__   \ V /   | |        ___ _ __  _ __
+ *   | | |_ |  ___/| |  | |   |  __|   > <    | |       / __| '_ \| '_ \
+ *   | |__| | |    | |__| |   | |____ / . \   | |   _  | (__| |_) | |_) |
+ *    \_____|_|     \____/    |______/_/ \_\  |_|  (_)  \___| .__/| .__/
+ *                        ______                            | |   | |
+ *                       |______|                           |_|   |_|
+ *
+ * Extended Graphics Registers. This device exposes the hardware engines
+ * that work on the GPU's 64k extended video buffer and the blitter that
+ * moves data between it and the standard video buffer.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "GPU.hpp"
+#include "GPU_EXT.hpp"
+#include "Memory.hpp"
+
+
+/***************************
+* Constructor / Destructor *
+***************************/
+
+GPU_EXT::GPU_EXT()
+{
+    std::cout << clr::indent_push() << clr::CYAN << "GPU_EXT Created" << clr::RETURN;
+    _device_name = "GPU_EXT_DEVICE";
+} // END: GPU_EXT()
+
+GPU_EXT::~GPU_EXT()
+{
+    std::cout << clr::indent_pop() << clr::CYAN << "GPU_EXT Destroyed" << clr::RETURN;
+} // END: ~GPU_EXT()
+
+
+
+/******************
+* Virtual Methods *
+******************/
+
+
+int  GPU_EXT::OnAttach(int nextAddr)
+{
+    SetBaseAddress(nextAddr);
+    Word old_address=nextAddr;
+    this->heading = "Extended Graphics Hardware Registers";
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_TMAP_LAYER
+    //      Tilemap Layer Select
+    /////
+    mapped_register.push_back({ "GPU_TMAP_LAYER", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _tmap_layer; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _tmap_layer = data % TMAP_LAYERS; },
+        {
+            "(Byte) Tilemap Layer Select (0-1)",
+            "  Note: Selects the tilemap layer referenced",
+            "       by the GPU_TMAP_* and GPU_TILE_* registers.",
+            "       Layer 1 is drawn over layer 0 and treats",
+            "       color index 0 as transparent.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_TMAP_FLAGS
+    //      Tilemap Layer Flags
+    /////
+    mapped_register.push_back({ "GPU_TMAP_FLAGS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].flags; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            TILE_LAYER& layer = _layers[_tmap_layer];
+            data &= (TMAP_ENABLE | TMAP_TILE_16 | TMAP_DEPTH);
+            if ((data ^ layer.flags) & (TMAP_TILE_16 | TMAP_DEPTH)) {
+                _invalidate_tiles(layer);
+            }
+            layer.flags = data;
+        },
+        {
+            "(Byte) Tilemap Layer Flags",
+            "- bit  7   = Layer Display Enable",
+            "- bit  6   = Tile Size (0: 8x8, 1: 16x16)",
+            "- bits 2-5 = (reserved)",
+            "- bits 0-1 = Tile Color Depth:",
+            "              00: 2-Colors",
+            "              01: 4-Colors",
+            "              10: 16-Colors",
+            "              11: 256-Colors",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_TMAP_WIDTH
+    //      Tilemap Width (in tiles)
+    /////
+    mapped_register.push_back({ "GPU_TMAP_WIDTH", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].width; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _layers[_tmap_layer].width = data ? data : 1; },
+        { "(Byte) Tilemap Width (in tiles, 1-255)", "" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_TMAP_HEIGHT
+    //      Tilemap Height (in tiles)
+    /////
+    mapped_register.push_back({ "GPU_TMAP_HEIGHT", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].height; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _layers[_tmap_layer].height = data ? data : 1; },
+        { "(Byte) Tilemap Height (in tiles, 1-255)", "" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_TMAP_XPOS
+    //      Tilemap Horizontal Scroll
+    /////
+    mapped_register.push_back({ "GPU_TMAP_XPOS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_layers[_tmap_layer].xpos >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].xpos;
+            w = (w & 0x00FF) | (data << 8);
+        },
+        {
+            "(Word) Tilemap Horizontal Scroll (in pixels)",
+            "  Note: Pixel column of the tilemap shown at the",
+            "       left edge of the display. The map wraps",
+            "       around at its right edge.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].xpos & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].xpos;
+            w = (w & 0xFF00) | data;
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_TMAP_YPOS
+    //      Tilemap Vertical Scroll
+    /////
+    mapped_register.push_back({ "GPU_TMAP_YPOS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_layers[_tmap_layer].ypos >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].ypos;
+            w = (w & 0x00FF) | (data << 8);
+        },
+        {
+            "(Word) Tilemap Vertical Scroll (in pixels)",
+            "  Note: Pixel row of the tilemap shown at the",
+            "       top edge of the display. The map wraps",
+            "       around at its bottom edge.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].ypos & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].ypos;
+            w = (w & 0xFF00) | data;
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_TMAP_ADDR
+    //      Tile Index Map Address (extended memory)
+    /////
+    mapped_register.push_back({ "GPU_TMAP_ADDR", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_layers[_tmap_layer].map_addr >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].map_addr;
+            w = (w & 0x00FF) | (data << 8);
+        },
+        {
+            "(Word) Tile Index Map Address",
+            "  Note: Extended memory address of the tile",
+            "       index map. One byte per map cell, stored",
+            "       row by row (GPU_TMAP_WIDTH bytes per row).",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].map_addr & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _layers[_tmap_layer].map_addr;
+            w = (w & 0xFF00) | data;
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_TILE_ADDR
+    //      Tile Graphics Address (extended memory)
+    /////
+    mapped_register.push_back({ "GPU_TILE_ADDR", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_layers[_tmap_layer].tile_addr >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            TILE_LAYER& layer = _layers[_tmap_layer];
+            layer.tile_addr = (layer.tile_addr & 0x00FF) | (data << 8);
+            _invalidate_tiles(layer);
+        },
+        {
+            "(Word) Tile Graphics Address",
+            "  Note: Extended memory address of the first",
+            "       of 256 tile images. Each tile is 8, 16,",
+            "       32 or 64 bytes (8x8) and 32, 64, 128 or",
+            "       256 bytes (16x16) at 2, 4, 16 and 256",
+            "       colors respectively.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _layers[_tmap_layer].tile_addr & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            TILE_LAYER& layer = _layers[_tmap_layer];
+            layer.tile_addr = (layer.tile_addr & 0xFF00) | data;
+            _invalidate_tiles(layer);
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_DYN_ADDR
+    //      Extended Memory Address Port
+    /////
+    mapped_register.push_back({ "GPU_DYN_ADDR", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_dyn_addr >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _dyn_addr = (_dyn_addr & 0x00FF) | (data << 8); },
+        {
+            "(Word) Extended Memory Address",
+            "  Note: Auto-increments on each read or",
+            "       write of GPU_DYN_DATA.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _dyn_addr & 0xFF; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _dyn_addr = (_dyn_addr & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_DYN_DATA
+    //      Extended Memory Data Port
+    /////
+    mapped_register.push_back({ "GPU_DYN_DATA", nextAddr,
+        [this](Word) {
+            Byte data = _gpu->_ext_draw_page()[_dyn_addr];
+            _dyn_addr += _dyn_step(1);
+            return data;
+        },
+        [this](Word, Byte data) {
+            _dyn_write(_dyn_addr, data);
+            _dyn_addr += _dyn_step(1);
+        },
+        {
+            "(Byte) Extended Memory Data (Read/Write)",
+            "  Note: GPU_DYN_ADDR advances by the",
+            "       GPU_DYN_CTRL step after each access.",
+            ""
+        },
+        [this](Word) { return _gpu->_ext_draw_page()[_dyn_addr]; }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_DYN_DATA16
+    //      Extended Memory 16-Bit Data Port
+    /////
+    mapped_register.push_back({ "GPU_DYN_DATA16", nextAddr,
+        [this](Word) { return _gpu->_ext_draw_page()[_dyn_addr]; },
+        [this](Word, Byte data) { _dyn_latch = data; },
+        {
+            "(Word) Extended Memory 16-Bit Data (Read/Write)",
+            "  Note: Transfers the word at GPU_DYN_ADDR",
+            "       (MSB first) and advances the address",
+            "       once per word, after the LSB. Steps of",
+            "       1 and 2 both move to the next word.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) {
+            Byte data = _gpu->_ext_draw_page()[(Word)(_dyn_addr + 1)];
+            _dyn_addr += _dyn_step(2);
+            return data;
+        },
+        [this](Word, Byte data) {
+            _dyn_write(_dyn_addr, _dyn_latch);
+            _dyn_write(_dyn_addr + 1, data);
+            _dyn_addr += _dyn_step(2);
+        },
+        {""},
+        [this](Word) { return _gpu->_ext_draw_page()[(Word)(_dyn_addr + 1)]; } }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_DYN_CTRL
+    //      Extended Memory Port Control
+    /////
+    mapped_register.push_back({ "GPU_DYN_CTRL", nextAddr,
+        [this](Word) { return _dyn_ctrl; },
+        [this](Word, Byte data) { _dyn_ctrl = data & DYN_STEP; },
+        {
+            "(Byte) Extended Memory Port Control",
+            "- bits 2-7 = (reserved)",
+            "- bits 0-1 = Address Step:",
+            "              00: 1 byte",
+            "              01: 2 bytes",
+            "              10: GPU_DYN_PITCH bytes",
+            "              11: none (fixed address)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_DYN_PITCH
+    //      Extended Memory Port Row Pitch
+    /////
+    mapped_register.push_back({ "GPU_DYN_PITCH", nextAddr,
+        [this](Word) { return (_dyn_pitch >> 8) & 0xFF; },
+        [this](Word, Byte data) { _dyn_pitch = (_dyn_pitch & 0x00FF) | (data << 8); },
+        {
+            "(Word) Address Step for Column Access",
+            "  Note: Usually the width of a bitmap or",
+            "       tilemap row in bytes.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _dyn_pitch & 0xFF; },
+        [this](Word, Byte data) { _dyn_pitch = (_dyn_pitch & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_SPR_MAX
+    //      Maximum Sprite Index (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_SPR_MAX", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (Byte)(SPR_COUNT - 1); },
+        nullptr, { "(Byte) Maximum Sprite Index (Read Only)", "" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_SPR_IDX
+    //      Sprite Index
+    /////
+    mapped_register.push_back({ "GPU_SPR_IDX", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _spr_idx; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _spr_idx = data % SPR_COUNT; },
+        {
+            "(Byte) Sprite Index (0-63)",
+            "  Note: Selects the sprite referenced by",
+            "       the GPU_SPR_* registers.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (SInt16) GPU_SPR_XPOS
+    //      Sprite X Position
+    /////
+    mapped_register.push_back({ "GPU_SPR_XPOS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return ((Word)_sprites[_spr_idx].xpos >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Sint16& v = _sprites[_spr_idx].xpos;
+            v = (Sint16)(((Word)v & 0x00FF) | (data << 8));
+        },
+        { "(SInt16) Sprite X Position (left edge)", "" }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (Word)_sprites[_spr_idx].xpos & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Sint16& v = _sprites[_spr_idx].xpos;
+            v = (Sint16)(((Word)v & 0xFF00) | data);
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (SInt16) GPU_SPR_YPOS
+    //      Sprite Y Position
+    /////
+    mapped_register.push_back({ "GPU_SPR_YPOS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return ((Word)_sprites[_spr_idx].ypos >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Sint16& v = _sprites[_spr_idx].ypos;
+            v = (Sint16)(((Word)v & 0x00FF) | (data << 8));
+        },
+        { "(SInt16) Sprite Y Position (top edge)", "" }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (Word)_sprites[_spr_idx].ypos & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Sint16& v = _sprites[_spr_idx].ypos;
+            v = (Sint16)(((Word)v & 0xFF00) | data);
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_SPR_ADDR
+    //      Sprite Image Address (extended memory)
+    /////
+    mapped_register.push_back({ "GPU_SPR_ADDR", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return (_sprites[_spr_idx].img_addr >> 8) & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _sprites[_spr_idx].img_addr;
+            w = (w & 0x00FF) | (data << 8);
+        },
+        {
+            "(Word) Sprite Image Address",
+            "  Note: Extended memory address of the 16x16",
+            "       sprite image; 32, 64, 128 or 256 bytes",
+            "       at 2, 4, 16 and 256 colors respectively.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _sprites[_spr_idx].img_addr & 0xFF; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            Word& w = _sprites[_spr_idx].img_addr;
+            w = (w & 0xFF00) | data;
+        }, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_SPR_PAL
+    //      Sprite Palette Offset
+    /////
+    mapped_register.push_back({ "GPU_SPR_PAL", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _sprites[_spr_idx].pal; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _sprites[_spr_idx].pal = data; },
+        {
+            "(Byte) Sprite Palette Offset",
+            "  Note: Added to every non-zero color index",
+            "       of the sprite image. Index 0 is always",
+            "       transparent.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_SPR_PRIORITY
+    //      Sprite Display Priority
+    /////
+    mapped_register.push_back({ "GPU_SPR_PRIORITY", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _sprites[_spr_idx].priority; },
+        [this](Word nextAddr, Byte data) { (void)nextAddr; _sprites[_spr_idx].priority = data; },
+        {
+            "(Byte) Sprite Display Priority",
+            "  Note: Higher priorities are drawn on top.",
+            "       Equal priorities draw the higher",
+            "       sprite index on top.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_SPR_FLAGS
+    //      Sprite Flags
+    /////
+    mapped_register.push_back({ "GPU_SPR_FLAGS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _sprites[_spr_idx].flags; },
+        [this](Word nextAddr, Byte data) {
+            (void)nextAddr;
+            _sprites[_spr_idx].flags = data & (SPR_ENABLE | SPR_COLLIDE | SPR_FLIP_V | SPR_FLIP_H | SPR_DEPTH);
+        },
+        {
+            "(Byte) Sprite Flags",
+            "- bit  7   = Display Enable",
+            "- bit  6   = Collision Enable",
+            "- bit  5   = Flip Vertical",
+            "- bit  4   = Flip Horizontal",
+            "- bits 2-3 = (reserved)",
+            "- bits 0-1 = Sprite Color Depth:",
+            "              00: 2-Colors",
+            "              01: 4-Colors",
+            "              10: 16-Colors",
+            "              11: 256-Colors",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (8-Bytes) GPU_SPR_HITS
+    //      Sprite Collision Bits (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_SPR_HITS", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _read_u64(_spr_hits[_spr_idx], 0); },
+        nullptr, {
+            "(8-Bytes) Sprite Collision Bits (Read Only)",
+            "  Note: One bit for each sprite that overlapped",
+            "       an opaque pixel of the selected sprite",
+            "       during the last frame. The first byte",
+            "       holds sprites 63-56, the last 7-0.",
+            ""
+        }}); nextAddr+=1;
+    for (Word i = 1; i < 8; i++) {
+        mapped_register.push_back( { "", nextAddr,
+            [this, i](Word nextAddr) { (void)nextAddr; return _read_u64(_spr_hits[_spr_idx], i); },
+            nullptr, {""}}); nextAddr+=1;
+    }
+
+
+    ////////////////////////////////////////////////
+    // (8-Bytes) GPU_COLL_MAP
+    //      Collided Sprites (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_COLL_MAP", nextAddr,
+        [this](Word nextAddr) { (void)nextAddr; return _read_u64(_coll_map, 0); },
+        nullptr, {
+            "(8-Bytes) Collided Sprites (Read Only)",
+            "  Note: One bit for each sprite that collided",
+            "       with any other sprite during the last",
+            "       frame. The first byte holds sprites",
+            "       63-56, the last 7-0.",
+            ""
+        }}); nextAddr+=1;
+    for (Word i = 1; i < 8; i++) {
+        mapped_register.push_back( { "", nextAddr,
+            [this, i](Word nextAddr) { (void)nextAddr; return _read_u64(_coll_map, i); },
+            nullptr, {""}}); nextAddr+=1;
+    }
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_SRC
+    //      Blitter Source Address
+    /////
+    mapped_register.push_back({ "GPU_BLT_SRC", nextAddr,
+        [this](Word) { return (_blt.src >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.src = (_blt.src & 0x00FF) | (data << 8); },
+        {
+            "(Word) Blitter Source Address",
+            "  Note: Extended memory, or CPU memory when",
+            "       GPU_BLT_FLAGS bit 3 is set. SCROLL uses",
+            "       it as signed offsets (MSB: bytes, LSB: rows).",
+            "       DRAW_LINE uses it as the starting X.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.src & 0xFF; },
+        [this](Word, Byte data) { _blt.src = (_blt.src & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_DST
+    //      Blitter Destination Address
+    /////
+    mapped_register.push_back({ "GPU_BLT_DST", nextAddr,
+        [this](Word) { return (_blt.dst >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.dst = (_blt.dst & 0x00FF) | (data << 8); },
+        {
+            "(Word) Blitter Destination Address",
+            "  Note: Extended memory, or CPU memory when",
+            "       GPU_BLT_FLAGS bit 4 is set. CPU memory",
+            "       is limited to VIDEO_START-VIDEO_END.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.dst & 0xFF; },
+        [this](Word, Byte data) { _blt.dst = (_blt.dst & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_WIDTH
+    //      Blitter Width (in bytes)
+    /////
+    mapped_register.push_back({ "GPU_BLT_WIDTH", nextAddr,
+        [this](Word) { return (_blt.width >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.width = (_blt.width & 0x00FF) | (data << 8); },
+        {
+            "(Word) Blitter Width (in bytes)",
+            "  Note: COPY uses it as the byte count.",
+            "       DRAW_LINE uses it as the ending X.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.width & 0xFF; },
+        [this](Word, Byte data) { _blt.width = (_blt.width & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_HEIGHT
+    //      Blitter Height (in rows)
+    /////
+    mapped_register.push_back({ "GPU_BLT_HEIGHT", nextAddr,
+        [this](Word) { return (_blt.height >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.height = (_blt.height & 0x00FF) | (data << 8); },
+        {
+            "(Word) Blitter Height (in rows)",
+            "  Note: DRAW_LINE uses it as the ending Y.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.height & 0xFF; },
+        [this](Word, Byte data) { _blt.height = (_blt.height & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_SPITCH
+    //      Blitter Source Stride
+    /////
+    mapped_register.push_back({ "GPU_BLT_SPITCH", nextAddr,
+        [this](Word) { return (_blt.spitch >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.spitch = (_blt.spitch & 0x00FF) | (data << 8); },
+        {
+            "(Word) Blitter Source Stride (bytes per row)",
+            "  Note: DRAW_LINE uses it as the starting Y.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.spitch & 0xFF; },
+        [this](Word, Byte data) { _blt.spitch = (_blt.spitch & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_BLT_DPITCH
+    //      Blitter Destination Stride
+    /////
+    mapped_register.push_back({ "GPU_BLT_DPITCH", nextAddr,
+        [this](Word) { return (_blt.dpitch >> 8) & 0xFF; },
+        [this](Word, Byte data) { _blt.dpitch = (_blt.dpitch & 0x00FF) | (data << 8); },
+        { "(Word) Blitter Destination Stride (bytes per row)", "" }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _blt.dpitch & 0xFF; },
+        [this](Word, Byte data) { _blt.dpitch = (_blt.dpitch & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_BLT_COLOR
+    //      Blitter Fill Color
+    /////
+    mapped_register.push_back({ "GPU_BLT_COLOR", nextAddr,
+        [this](Word) { return _blt.color; },
+        [this](Word, Byte data) { _blt.color = data; },
+        {
+            "(Byte) Blitter Fill Color",
+            "  Note: Byte value for CLEAR, SCROLL and",
+            "       FILL_RECT; color index for DRAW_LINE.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_BLT_KEY
+    //      Blitter Color Key
+    /////
+    mapped_register.push_back({ "GPU_BLT_KEY", nextAddr,
+        [this](Word) { return _blt.key; },
+        [this](Word, Byte data) { _blt.key = data; },
+        { "(Byte) Blitter Color Key (source bytes skipped by BLIT)", "" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_BLT_ROP
+    //      Blitter Raster Operation
+    /////
+    mapped_register.push_back({ "GPU_BLT_ROP", nextAddr,
+        [this](Word) { return _blt.rop; },
+        [this](Word, Byte data) { _blt.rop = (data < ROP_LAST) ? data : (Byte)ROP_COPY; },
+        {
+            "(Byte) Blitter Raster Operation",
+            "   $00 = COPY (dst = src)",
+            "   $01 = AND  (dst = dst & src)",
+            "   $02 = OR   (dst = dst | src)",
+            "   $03 = XOR  (dst = dst ^ src)",
+            "   $04 = NOT  (dst = ~src)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_BLT_FLAGS
+    //      Blitter Flags
+    /////
+    mapped_register.push_back({ "GPU_BLT_FLAGS", nextAddr,
+        [this](Word) { return _blt.flags; },
+        [this](Word, Byte data) {
+            Byte done = (_blt.flags & BLT_DONE) & ~data;           // write 1 to acknowledge
+            _blt.flags = (_blt.flags & BLT_BUSY) | done | (data & (BLT_IRQ | BLT_KEY | BLT_DST_CPU | BLT_SRC_CPU | BLT_DEPTH));
+        },
+        {
+            "(Byte) Blitter Flags",
+            "- bit  7   = Busy (Read Only)",
+            "- bit  6   = IRQ on Command Completion",
+            "- bit  5   = Color Key Enable (BLIT)",
+            "- bit  4   = Destination in CPU Memory",
+            "- bit  3   = Source in CPU Memory",
+            "- bit  2   = Completion IRQ Pending",
+            "              (write 1 to acknowledge)",
+            "- bits 0-1 = DRAW_LINE Color Depth:",
+            "              00: 2-Colors",
+            "              01: 4-Colors",
+            "              10: 16-Colors",
+            "              11: 256-Colors",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_COMMAND
+    //      Graphics Processing Unit Command
+    /////
+    mapped_register.push_back({ "GPU_COMMAND", nextAddr,
+        [this](Word) { return _gpu_command; },
+        [this](Word, Byte data) { _do_command(data); },
+        {
+            "(Byte) Graphics Processing Unit Command:",
+            "  Note: Commands complete before the write",
+            "       returns. Rectangles are GPU_BLT_WIDTH",
+            "       bytes by GPU_BLT_HEIGHT rows.",
+            "       TEXT_SCROLL works in text cells: DST is",
+            "       the top left (MSB: column, LSB: row),",
+            "       WIDTH x HEIGHT the region, SRC the signed",
+            "       offsets as for SCROLL, and COLOR the",
+            "       attribute of the blank cells it exposes."
+        }}); nextAddr++;
+    // ADD COMMAND ENUMERATION:
+    Byte cmd = 0;
+    for (const auto& command : _gpu_command_list)
+    {
+        std::vector<std::string> comment = { "   $" + clr::hex(cmd, 2) + " = " + command.description };
+        if (command.key == "GPU_CMD_SIZE")
+        {
+            comment.push_back("");  // Adding an extra empty string to add a blank line
+        }
+        mapped_register.push_back({ command.key, cmd++, nullptr, nullptr, comment });
+    }
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_ERROR
+    //      Graphics Processing Unit Error Code (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_ERROR", nextAddr,
+        [this](Word) { return _gpu_error; },
+        nullptr,
+        { "(Byte) Graphics Processing Unit Error Code:   (Read Only)" }}); nextAddr++;
+    // ADD ERROR CODE ENUMERATION:
+    Byte err = 0;
+    for (const auto& error : _gpu_error_list)
+    {
+        std::vector<std::string> comments = { "   $" + clr::hex(err, 2) + " = " + error.second };
+        if (error.first == "GPU_ERR_SIZE")
+        {
+            comments.push_back("");  // Adding an extra empty string to add a blank line
+        }
+        mapped_register.push_back({ error.first, err++, nullptr, nullptr, comments });
+    }
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_RASTER_LINE
+    //      Current Raster Line (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_RASTER_LINE", nextAddr,
+        [this](Word) { return (_raster_line >> 8) & 0xFF; },
+        nullptr,
+        {
+            "(Word) Current Raster Line (Read Only)",
+            "  Note: 525 lines per frame at 70 Hz, timed",
+            "       from the CPU clock. Lines 0-399 are",
+            "       visible, 400-524 are vertical blank.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _raster_line & 0xFF; },
+        nullptr, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_RASTER_CMP
+    //      Raster Compare Line
+    /////
+    mapped_register.push_back({ "GPU_RASTER_CMP", nextAddr,
+        [this](Word) { return (_raster_cmp >> 8) & 0xFF; },
+        [this](Word, Byte data) { _raster_cmp = (_raster_cmp & 0x00FF) | (data << 8); },
+        {
+            "(Word) Raster Compare Line",
+            "  Note: GPU_RASTER_CTRL bit 0 is set, and an",
+            "       IRQ raised if enabled, when the raster",
+            "       reaches this line.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _raster_cmp & 0xFF; },
+        [this](Word, Byte data) { _raster_cmp = (_raster_cmp & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_RASTER_CTRL
+    //      Raster Control
+    /////
+    mapped_register.push_back({ "GPU_RASTER_CTRL", nextAddr,
+        [this](Word) { return _raster_ctrl; },
+        [this](Word, Byte data) {
+            Byte match = (_raster_ctrl & RASTER_MATCH) & ~data;     // write 1 to acknowledge
+            _raster_ctrl = (data & (RASTER_SCANLINE | RASTER_IRQ)) | match;
+        },
+        {
+            "(Byte) Raster Control",
+            "- bit  7   = Scanline Renderer Enable",
+            "              (palette, scroll and mode changes",
+            "              take effect on the next line)",
+            "- bit  6   = IRQ on Compare Match",
+            "- bits 1-5 = (reserved)",
+            "- bit  0   = Compare Matched (write 1 to clear)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_VBL_CTRL
+    //      Vertical Blank Control / Status
+    /////
+    mapped_register.push_back({ "GPU_VBL_CTRL", nextAddr,
+        [this](Word) {
+            return (Byte)(_vbl_ctrl | ((_raster_line >= RASTER_ACTIVE) ? VBL_VSYNC : 0));
+        },
+        [this](Word, Byte data) {
+            Byte pending = (_vbl_ctrl & VBL_PENDING) & ~data;      // write 1 to acknowledge
+            _vbl_ctrl = (data & (VBL_ENABLE | VBL_FIRQ)) | pending;
+        },
+        {
+            "(Byte) Vertical Blank Control / Status",
+            "- bit  7   = Vertical Blank Interrupt Enable",
+            "- bit  6   = Interrupt Line (0: IRQ, 1: FIRQ)",
+            "- bits 2-5 = (reserved)",
+            "- bit  1   = VSYNC: Raster in Vertical Blank",
+            "              (Read Only)",
+            "- bit  0   = Vertical Blank Pending",
+            "              (write 1 to acknowledge)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_VBL_FRAME
+    //      Frame Counter (Read Only)
+    /////
+    mapped_register.push_back({ "GPU_VBL_FRAME", nextAddr,
+        [this](Word) { return (_vbl_frame >> 8) & 0xFF; },
+        nullptr,
+        {
+            "(Word) Frame Counter (Read Only)",
+            "  Note: Increments at the start of each",
+            "       vertical blank (70 times per second",
+            "       of emulated CPU time).",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _vbl_frame & 0xFF; },
+        nullptr, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_PAGE_DISPLAY
+    //      Displayed Extended Video Page
+    /////
+    mapped_register.push_back({ "GPU_PAGE_DISPLAY", nextAddr,
+        [this](Word) { return (Byte)(_gpu->_ext_display | (_page_flip ? PAGE_PENDING : 0)); },
+        [this](Word, Byte data) {
+            _page_request = data & PAGE_MASK;
+            _page_flip = true;
+        }, {
+            "(Byte) Displayed Extended Video Page",
+            "  Write: page shown from the next vertical blank",
+            "  Read:  bits 0-1: page being displayed",
+            "         bit 7:    flip pending (until the vertical blank)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_PAGE_DRAW
+    //      Extended Video Page Accessed by the CPU
+    /////
+    mapped_register.push_back({ "GPU_PAGE_DRAW", nextAddr,
+        [this](Word) { return (Byte)_gpu->_ext_draw; },
+        [this](Word, Byte data) { _gpu->_ext_draw = data & PAGE_MASK; },
+        {
+            "(Byte) Extended Video Page Accessed by the CPU",
+            "  The GPU_DYN_* ports and the blitter read and",
+            "  write this page (0-3); takes effect immediately.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_STD_SCROLL_X
+    //      Standard Display Horizontal Scroll
+    /////
+    mapped_register.push_back({ "GPU_STD_SCROLL_X", nextAddr,
+        [this](Word) { return (_gpu->_std_scroll_x >> 8) & 0xFF; },
+        [this](Word, Byte data) { _gpu->_std_scroll_x = (_gpu->_std_scroll_x & 0x00FF) | (data << 8); },
+        {
+            "(Word) Standard Display Horizontal Scroll (in pixels)",
+            "  Note: Text and bitmap modes. Pixel column shown",
+            "       at the left edge; text scrolls by whole and",
+            "       partial characters. The display wraps around.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _gpu->_std_scroll_x & 0xFF; },
+        [this](Word, Byte data) { _gpu->_std_scroll_x = (_gpu->_std_scroll_x & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_STD_SCROLL_Y
+    //      Standard Display Vertical Scroll
+    /////
+    mapped_register.push_back({ "GPU_STD_SCROLL_Y", nextAddr,
+        [this](Word) { return (_gpu->_std_scroll_y >> 8) & 0xFF; },
+        [this](Word, Byte data) { _gpu->_std_scroll_y = (_gpu->_std_scroll_y & 0x00FF) | (data << 8); },
+        {
+            "(Word) Standard Display Vertical Scroll (in pixels)",
+            "  Note: Pixel row shown at the top of the display.",
+            "       The display wraps around at its bottom edge.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _gpu->_std_scroll_y & 0xFF; },
+        [this](Word, Byte data) { _gpu->_std_scroll_y = (_gpu->_std_scroll_y & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_EXT_SCROLL_X
+    //      Extended Bitmap Horizontal Scroll
+    /////
+    mapped_register.push_back({ "GPU_EXT_SCROLL_X", nextAddr,
+        [this](Word) { return (_gpu->_ext_scroll_x >> 8) & 0xFF; },
+        [this](Word, Byte data) { _gpu->_ext_scroll_x = (_gpu->_ext_scroll_x & 0x00FF) | (data << 8); },
+        {
+            "(Word) Extended Bitmap Horizontal Scroll (in pixels)",
+            "  Note: Extended bitmap modes only; the tilemaps use",
+            "       GPU_TMAP_XPOS and GPU_TMAP_YPOS.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _gpu->_ext_scroll_x & 0xFF; },
+        [this](Word, Byte data) { _gpu->_ext_scroll_x = (_gpu->_ext_scroll_x & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) GPU_EXT_SCROLL_Y
+    //      Extended Bitmap Vertical Scroll
+    /////
+    mapped_register.push_back({ "GPU_EXT_SCROLL_Y", nextAddr,
+        [this](Word) { return (_gpu->_ext_scroll_y >> 8) & 0xFF; },
+        [this](Word, Byte data) { _gpu->_ext_scroll_y = (_gpu->_ext_scroll_y & 0x00FF) | (data << 8); },
+        {
+            "(Word) Extended Bitmap Vertical Scroll (in pixels)",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _gpu->_ext_scroll_y & 0xFF; },
+        [this](Word, Byte data) { _gpu->_ext_scroll_y = (_gpu->_ext_scroll_y & 0xFF00) | data; },
+        {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_CYCLE_IDX
+    //      Palette Cycling Range Index
+    /////
+    mapped_register.push_back({ "GPU_CYCLE_IDX", nextAddr,
+        [this](Word) { return _cycle_idx; },
+        [this](Word, Byte data) { _cycle_idx = data % CYCLE_RANGES; },
+        {
+            "(Byte) Palette Cycling Range Index (0-7)",
+            "  Note: Selects the range GPU_CYCLE_START through",
+            "       GPU_CYCLE_FLAGS refer to.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_CYCLE_START
+    //      First Palette Entry of the Range
+    /////
+    mapped_register.push_back({ "GPU_CYCLE_START", nextAddr,
+        [this](Word) { return _cycles[_cycle_idx].start; },
+        [this](Word, Byte data) { _cycles[_cycle_idx].start = data; },
+        { "(Byte) First Palette Entry of the Range" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_CYCLE_END
+    //      Last Palette Entry of the Range
+    /////
+    mapped_register.push_back({ "GPU_CYCLE_END", nextAddr,
+        [this](Word) { return _cycles[_cycle_idx].end; },
+        [this](Word, Byte data) { _cycles[_cycle_idx].end = data; },
+        { "(Byte) Last Palette Entry of the Range" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_CYCLE_RATE
+    //      Vertical Blanks per Cycling Step
+    /////
+    mapped_register.push_back({ "GPU_CYCLE_RATE", nextAddr,
+        [this](Word) { return _cycles[_cycle_idx].rate; },
+        [this](Word, Byte data) { _cycles[_cycle_idx].rate = data ? data : 1; },
+        { "(Byte) Vertical Blanks per Cycling Step (1-255)" }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) GPU_CYCLE_FLAGS
+    //      Palette Cycling Range Flags
+    /////
+    mapped_register.push_back({ "GPU_CYCLE_FLAGS", nextAddr,
+        [this](Word) { return _cycles[_cycle_idx].flags; },
+        [this](Word, Byte data) {
+            _cycles[_cycle_idx].flags = data & (CYCLE_ENABLE | CYCLE_REVERSE);
+            _cycles[_cycle_idx].count = 0;
+        },
+        {
+            "(Byte) Palette Cycling Range Flags",
+            "   - bit  7   = Range Cycling Enable",
+            "   - bits 1-6 = Reserved",
+            "   - bit  0   = Direction (0: colors move up, 1: down)",
+            "  Note: Enabled ranges rotate the palette entries",
+            "       START through END one place every RATE",
+            "       vertical blanks without any CPU time.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) GPU_EXT_END
+    //      End of Extended Graphics Register Space
+    /////
+    nextAddr--;
+    mapped_register.push_back({ "GPU_EXT_END", nextAddr,
+        nullptr, nullptr,  { "End of Extended Graphics Register Space"} });
+    nextAddr++;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) GPU_EXT_TOP
+    //      Top of Extended Graphics Register Space
+    //      (start of the next device)
+    /////
+    mapped_register.push_back({ "GPU_EXT_TOP", nextAddr,
+    nullptr, nullptr,  { "Top of Extended Graphics Register Space", "---"}});
+
+    _size = nextAddr - old_address;
+    return _size;
+} // END: GPU_EXT::OnAttach()
+
+
+void GPU_EXT::OnInit()
+{
+    std::cout << clr::indent() << clr::CYAN << "GPU_EXT::OnInit() Entry" << clr::RETURN;
+
+    _gpu = Bus::GetGPU();
+    if (_gpu == nullptr) {
+        Bus::Error("GPU_EXT requires the GPU device to be attached first!", __FILE__, __LINE__);
+    }
+    for (auto& layer : _layers) {
+        layer.cache.resize(TMAP_TILES * 16 * 16);
+        _invalidate_tiles(layer);
+    }
+    _video_start = MAP(VIDEO_START);
+    _video_end = MAP(VIDEO_END);
+    for (int i = 0; i < 2; i++) {
+        _scan_std[i].resize(SCAN_WIDTH * SCAN_HEIGHT);
+        _scan_ext[i].resize(SCAN_WIDTH * SCAN_HEIGHT);
+    }
+
+    std::cout << clr::indent() << clr::CYAN << "GPU_EXT::OnInit() Exit" << clr::RETURN;
+} // END: GPU_EXT::OnInit()
+
+
+void GPU_EXT::OnActivate()
+{
+    // the GPU rewrites the extended video buffer when it activates
+    for (auto& layer : _layers) { _invalidate_tiles(layer); }
+} // END: GPU_EXT::OnActivate()
+
+
+bool GPU_EXT::OnTest()
+{
+    bool test_results = true;
+
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Tilemap Layers" + clr::RESET);
+    if (!_test_tilemap()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Extended Memory Port" + clr::RESET);
+    if (!_test_dyn_port()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Sprites" + clr::RESET);
+    if (!_test_sprites()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Blitter Commands" + clr::RESET);
+    if (!_test_blitter()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Raster Beam" + clr::RESET);
+    if (!_test_raster()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Vertical Blank" + clr::RESET);
+    if (!_test_vblank()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Video Pages" + clr::RESET);
+    if (!_test_pages()) {
+        test_results = false;
+    }
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Palette Cycling" + clr::RESET);
+    if (!_test_cycle()) {
+        test_results = false;
+    }
+
+    // display the result of the tests
+    if (test_results)
+        UnitTest::Log(this, "Unit Tests PASSED");
+    else
+        UnitTest::Log(this, clr::RED + "Unit Tests FAILED");
+    return test_results;
+} // END: GPU_EXT::OnTest()
+
+
+
+/*********************
+* Extended Video RAM *
+*********************/
+
+
+/**
+ * Writes one byte through the data ports. Instead of checking every tile
+ * layer on each byte, the write only widens the pending dirty span;
+ * _dyn_flush() drops the cached tiles under it in one pass before the
+ * tilemaps are next drawn.
+ */
+void GPU_EXT::_dyn_write(Word address, Byte data)
+{
+    _gpu->_ext_draw_page()[address] = data;
+    uint32_t span = _dyn_dirty.load();
+    while (true)
+    {
+        Word lo = span & 0xFFFF;
+        Word hi = span >> 16;
+        if (address >= lo && address <= hi) { return; }
+        uint32_t wider = ((uint32_t)std::max(hi, address) << 16) | std::min(lo, address);
+        if (lo > hi) { wider = ((uint32_t)address << 16) | address; }     // was clean
+        if (_dyn_dirty.compare_exchange_weak(span, wider)) { return; }
+    }
+} // END: GPU_EXT::_dyn_write()
+
+
+void GPU_EXT::_dyn_flush()
+{
+    uint32_t span = _dyn_dirty.exchange(DYN_CLEAN);
+    Word lo = span & 0xFFFF;
+    Word hi = span >> 16;
+    if (lo > hi) { return; }
+
+    int length = hi - lo + 1;
+    for (auto& layer : _layers)
+    {
+        int tile_bytes = _tile_bytes(layer);
+        int region = TMAP_TILES * tile_bytes;
+        int first = (Word)(lo - layer.tile_addr);   // span start within the tile set
+        int last = first + length - 1;
+        if (first >= region)
+        {
+            // starts past the tile set; may still wrap around into it
+            if (last < 0x10000) { continue; }
+            first = 0;
+            last -= 0x10000;
+        }
+        last = std::min(last, region - 1);
+        for (int t = first / tile_bytes; t <= last / tile_bytes; t++) {
+            layer.valid.reset(t);
+        }
+    }
+} // END: GPU_EXT::_dyn_flush()
+
+
+Word GPU_EXT::_dyn_step(int size)
+{
+    switch (_dyn_ctrl & DYN_STEP)
+    {
+        case DYN_STEP_1:     return size;
+        case DYN_STEP_2:     return 2;
+        case DYN_STEP_PITCH: return _dyn_pitch;
+        default:             return 0;
+    }
+} // END: GPU_EXT::_dyn_step()
+
+
+
+/*****************
+* Tilemap Engine *
+*****************/
+
+
+/**
+ * Returns the decoded (one color index per pixel) image of a tile,
+ * decoding it from extended memory only when the cached copy is stale.
+ */
+const Byte* GPU_EXT::_fetch_tile(TILE_LAYER& layer, Byte tile)
+{
+    int ts = _tile_size(layer);
+    Byte* dst = &layer.cache[tile * ts * ts];
+    if (layer.valid.test(tile)) {
+        return dst;
+    }
+
+    int bpp = _tile_bpp(layer);
+    int ppb = 8 / bpp;                  // pixels per byte
+    Byte mask = (1 << bpp) - 1;
+    Word src = layer.tile_addr + tile * _tile_bytes(layer);
+    const Byte* vram = _gpu->_ext_display_page();
+    for (int p = 0; p < ts * ts; p += ppb)
+    {
+        Byte data = vram[src++];
+        for (int b = 0; b < ppb; b++)
+        {
+            int shift = 8 - bpp * (b + 1);
+            dst[p + b] = (data >> shift) & mask;
+        }
+    }
+    layer.valid.set(tile);
+    return dst;
+} // END: GPU_EXT::_fetch_tile()
+
+
+void GPU_EXT::_tile_lut(Word* lut)
+{
+    // convert the palette to opaque ARGB4444; index 0 is transparent
+    lut[0] = 0x0000;
+    for (int i = 1; i < 256; i++) {
+        lut[i] = 0xF000 | (_gpu->_palette[i].color & 0x0FFF);
+    }
+} // END: GPU_EXT::_tile_lut()
+
+
+void GPU_EXT::_render_tile_line(Uint16* dst, int width, int y, const Word* lut)
+{
+    const Byte* vram = _gpu->_ext_display_page();
+    for (int l = 0; l < TMAP_LAYERS; l++)
+    {
+        TILE_LAYER& layer = _layers[l];
+        if ((layer.flags & TMAP_ENABLE) == 0) { continue; }
+        Uint32 gen = _tile_gen[l].load(std::memory_order_acquire);
+        if (gen != layer.valid_gen) {
+            layer.valid.reset();
+            layer.valid_gen = gen;
+        }
+
+        bool transparent = (l > 0);
+        int ts = _tile_size(layer);
+        int map_w = layer.width * ts;
+        int map_h = layer.height * ts;
+        int wy = (y + layer.ypos) % map_h;
+        Word row = layer.map_addr + (wy / ts) * layer.width;
+        int py = (wy % ts) * ts;
+        int wx = layer.xpos % map_w;
+        for (int x = 0; x < width; )
+        {
+            int px = wx % ts;
+            const Byte* src = _fetch_tile(layer, vram[(Word)(row + wx / ts)]) + py;
+            int run = std::min(ts - px, width - x);
+            for (int i = 0; i < run; i++)
+            {
+                Byte index = src[px + i];
+                if (transparent && index == 0) { continue; }
+                dst[x + i] = lut[index];
+            }
+            x += run;
+            wx = (wx + run) % map_w;
+        }
+    }
+} // END: GPU_EXT::_render_tile_line()
+
+
+void GPU_EXT::RenderTilemap(void* pixels, int pitch, int width, int height)
+{
+    _dyn_flush();
+    // convert the palette once for the whole frame
+    Word lut[256];
+    _tile_lut(lut);
+    for (int y = 0; y < height; y++) {
+        _render_tile_line((Uint16*)((Uint8*)pixels + (y * pitch)), width, y, lut);
+    }
+} // END: GPU_EXT::RenderTilemap()
+
+
+void GPU_EXT::RenderTilemapLine(Uint16* dst, int width, int y)
+{
+    _dyn_flush();
+    // the palette may have changed since the previous line
+    Word lut[256];
+    _tile_lut(lut);
+    _render_tile_line(dst, width, y, lut);
+} // END: GPU_EXT::RenderTilemapLine()
+
+
+
+/****************
+* Sprite Engine *
+****************/
+
+
+/**
+ * Decodes a 16x16 sprite image from extended memory into one color index
+ * per pixel with the flips applied, and builds its collision mask.
+ */
+void GPU_EXT::_decode_sprite(const SPRITE& spr, SPRITE_IMAGE& img)
+{
+    int bpp = 1 << (spr.flags & SPR_DEPTH);
+    int ppb = 8 / bpp;                  // pixels per byte
+    Byte mask = (1 << bpp) - 1;
+    Word src = spr.img_addr;
+    const Byte* vram = _gpu->_ext_display_page();
+    for (int y = 0; y < SPR_SIZE; y++)
+    {
+        int dy = (spr.flags & SPR_FLIP_V) ? (SPR_SIZE - 1 - y) : y;
+        Byte* row = &img.pixel[dy * SPR_SIZE];
+        Word bits = 0;
+        for (int x = 0; x < SPR_SIZE; x += ppb)
+        {
+            Byte data = vram[src++];
+            for (int b = 0; b < ppb; b++)
+            {
+                int dx = (spr.flags & SPR_FLIP_H) ? (SPR_SIZE - 1 - (x + b)) : (x + b);
+                Byte index = (data >> (8 - bpp * (b + 1))) & mask;
+                row[dx] = index;
+                if (index) { bits |= 0x8000 >> dx; }
+            }
+        }
+        img.mask[dy] = bits;
+    }
+} // END: GPU_EXT::_decode_sprite()
+
+
+/**
+ * Pixel exact collision test between two decoded sprites. The rows of
+ * one mask are shifted into the coordinate space of the other and the
+ * overlapping rows are ANDed a whole row (16 pixels) at a time.
+ */
+bool GPU_EXT::_sprite_hit(int a, int b)
+{
+    const SPRITE& sa = _sprites[a];
+    const SPRITE& sb = _sprites[b];
+    int dx = sb.xpos - sa.xpos;
+    int dy = sb.ypos - sa.ypos;
+    if (dx <= -SPR_SIZE || dx >= SPR_SIZE || dy <= -SPR_SIZE || dy >= SPR_SIZE) {
+        return false;       // bounding boxes do not overlap
+    }
+    const Word* ma = _spr_image[a].mask;
+    const Word* mb = _spr_image[b].mask;
+    int first = std::max(0, dy);
+    int last = std::min(SPR_SIZE, SPR_SIZE + dy);
+    Word hit = 0;
+    for (int r = first; r < last; r++)
+    {
+        DWord row = mb[r - dy];
+        row = (dx >= 0) ? (row >> dx) : (row << -dx);
+        hit |= ma[r] & (Word)row;
+    }
+    return hit != 0;
+} // END: GPU_EXT::_sprite_hit()
+
+
+void GPU_EXT::_update_collisions()
+{
+    _spr_hits.fill(0);
+    _coll_map = 0;
+    for (int a = 0; a < SPR_COUNT; a++)
+    {
+        if ((_sprites[a].flags & (SPR_ENABLE | SPR_COLLIDE)) != (SPR_ENABLE | SPR_COLLIDE)) { continue; }
+        for (int b = a + 1; b < SPR_COUNT; b++)
+        {
+            if ((_sprites[b].flags & (SPR_ENABLE | SPR_COLLIDE)) != (SPR_ENABLE | SPR_COLLIDE)) { continue; }
+            if (_sprite_hit(a, b))
+            {
+                _spr_hits[a] |= 1ull << b;
+                _spr_hits[b] |= 1ull << a;
+            }
+        }
+        if (_spr_hits[a]) { _coll_map |= 1ull << a; }
+    }
+} // END: GPU_EXT::_update_collisions()
+
+
+/**
+ * Decodes the enabled sprites and updates the collision registers. This
+ * runs every frame, including the frames skipped by SYS_EXT, so the
+ * guest sees each hit even when the frame is never drawn.
+ */
+void GPU_EXT::UpdateSprites()
+{
+    for (int i = 0; i < SPR_COUNT; i++)
+    {
+        if (_sprites[i].flags & SPR_ENABLE) {
+            _decode_sprite(_sprites[i], _spr_image[i]);
+        }
+    }
+    _update_collisions();
+} // END: GPU_EXT::UpdateSprites()
+
+
+void GPU_EXT::RenderSprites(void* pixels, int pitch, int width, int height)
+{
+    // collect the displayed sprites in drawing order
+    int order[SPR_COUNT];
+    int count = 0;
+    for (int i = 0; i < SPR_COUNT; i++)
+    {
+        if (_sprites[i].flags & SPR_ENABLE) {
+            order[count++] = i;
+        }
+    }
+    std::stable_sort(order, order + count, [this](int a, int b) {
+        return _sprites[a].priority < _sprites[b].priority;
+    });
+
+    for (int n = 0; n < count; n++)
+    {
+        const SPRITE& spr = _sprites[order[n]];
+        const SPRITE_IMAGE& img = _spr_image[order[n]];
+        for (int y = 0; y < SPR_SIZE; y++)
+        {
+            int sy = spr.ypos + y;
+            if (sy < 0 || sy >= height || img.mask[y] == 0) { continue; }
+            Uint16* dst = (Uint16*)((Uint8*)pixels + (sy * pitch));
+            for (int x = 0; x < SPR_SIZE; x++)
+            {
+                int sx = spr.xpos + x;
+                Byte index = img.pixel[y * SPR_SIZE + x];
+                if (index == 0 || sx < 0 || sx >= width) { continue; }
+                Byte color = index + spr.pal;
+                dst[sx] = 0xF000 | (_gpu->_palette[color].color & 0x0FFF);
+            }
+        }
+    }
+} // END: GPU_EXT::RenderSprites()
+
+
+/*******************
+* Blitter Commands *
+*******************/
+
+
+void GPU_EXT::_do_command(Byte command)
+{
+    _gpu_command = command;
+    if (command >= _gpu_command_list.size()) {
+        _gpu_error = MAP(GPU_ERR_COMMAND);
+        return;
+    }
+    _gpu_error = MAP(GPU_ERR_NONE);
+    _blt.flags |= BLT_BUSY;
+    _gpu_command_list[command].action();
+    _blt.flags &= ~BLT_BUSY;
+    if (_blt.flags & BLT_IRQ) {
+        _blt.flags |= BLT_DONE;         // held by _hold_interrupts()
+    }
+} // END: GPU_EXT::_do_command()
+
+
+/**
+ * Validates a rectangle of width bytes by height rows against the address
+ * space it lives in: the whole 64k extended buffer, or only the standard
+ * video buffer for CPU memory (the blitter never touches other devices).
+ */
+bool GPU_EXT::_blt_in_range(bool cpu, Word addr, int width, int height, int pitch)
+{
+    if (width <= 0 || height <= 0) {
+        _gpu_error = MAP(GPU_ERR_ARGUMENT);
+        return false;
+    }
+    int last = addr + (height - 1) * pitch + width - 1;
+    int lo = cpu ? _video_start : 0x0000;
+    int hi = cpu ? _video_end : 0xFFFF;
+    if (addr < lo || last > hi) {
+        _gpu_error = MAP(GPU_ERR_ADDRESS);
+        return false;
+    }
+    return true;
+} // END: GPU_EXT::_blt_in_range()
+
+
+Byte GPU_EXT::_blt_read(bool cpu, Word addr)
+{
+    return cpu ? memory(addr) : _gpu->_ext_draw_page()[addr];
+} // END: GPU_EXT::_blt_read()
+
+
+void GPU_EXT::_blt_write(bool cpu, Word addr, Byte data)
+{
+    // extended memory is written directly; _blt_done() drops the tile cache once
+    if (cpu) { memory(addr, data); }
+    else     { _gpu->_ext_draw_page()[addr] = data; }
+} // END: GPU_EXT::_blt_write()
+
+
+Byte GPU_EXT::_blt_rop(Byte src, Byte dst)
+{
+    switch (_blt.rop)
+    {
+        case ROP_AND: return dst & src;
+        case ROP_OR:  return dst | src;
+        case ROP_XOR: return dst ^ src;
+        case ROP_NOT: return ~src;
+        default:      return src;
+    }
+} // END: GPU_EXT::_blt_rop()
+
+
+void GPU_EXT::_blt_done(bool dst_cpu)
+{
+    if (!dst_cpu) {
+        for (auto& layer : _layers) { _invalidate_tiles(layer); }
+    }
+} // END: GPU_EXT::_blt_done()
+
+
+bool GPU_EXT::_do_clear()
+{
+    bool cpu = _blt.flags & BLT_DST_CPU;
+    if (cpu) {
+        for (int a = _video_start; a <= _video_end; a++) { memory(a, _blt.color); }
+    } else {
+        std::fill_n(_gpu->_ext_draw_page(), 0x10000, _blt.color);
+    }
+    _blt_done(cpu);
+    return true;
+} // END: GPU_EXT::_do_clear()
+
+
+bool GPU_EXT::_do_copy()
+{
+    bool src_cpu = _blt.flags & BLT_SRC_CPU;
+    bool dst_cpu = _blt.flags & BLT_DST_CPU;
+    int count = _blt.width;
+    if (!_blt_in_range(src_cpu, _blt.src, count, 1, 0) || !_blt_in_range(dst_cpu, _blt.dst, count, 1, 0)) {
+        return false;
+    }
+    // stage through the temp buffer so overlapping ranges behave like memmove()
+    _blt_temp.resize(count);
+    for (int i = 0; i < count; i++) { _blt_temp[i] = _blt_read(src_cpu, _blt.src + i); }
+    for (int i = 0; i < count; i++) { _blt_write(dst_cpu, _blt.dst + i, _blt_temp[i]); }
+    _blt_done(dst_cpu);
+    return true;
+} // END: GPU_EXT::_do_copy()
+
+
+bool GPU_EXT::_do_blit()
+{
+    bool src_cpu = _blt.flags & BLT_SRC_CPU;
+    bool dst_cpu = _blt.flags & BLT_DST_CPU;
+    bool keyed = _blt.flags & BLT_KEY;
+    int w = _blt.width, h = _blt.height;
+    if (!_blt_in_range(src_cpu, _blt.src, w, h, _blt.spitch) || !_blt_in_range(dst_cpu, _blt.dst, w, h, _blt.dpitch)) {
+        return false;
+    }
+    _blt_temp.resize(w * h);
+    for (int y = 0; y < h; y++) {
+        Word src = _blt.src + y * _blt.spitch;
+        for (int x = 0; x < w; x++) { _blt_temp[y * w + x] = _blt_read(src_cpu, src + x); }
+    }
+    for (int y = 0; y < h; y++) {
+        Word dst = _blt.dst + y * _blt.dpitch;
+        for (int x = 0; x < w; x++) {
+            Byte data = _blt_temp[y * w + x];
+            if (keyed && data == _blt.key) { continue; }
+            _blt_write(dst_cpu, dst + x, _blt_rop(data, _blt_read(dst_cpu, dst + x)));
+        }
+    }
+    _blt_done(dst_cpu);
+    return true;
+} // END: GPU_EXT::_do_blit()
+
+
+bool GPU_EXT::_do_scroll()
+{
+    bool cpu = _blt.flags & BLT_DST_CPU;
+    int w = _blt.width, h = _blt.height;
+    int dx = (Sint8)(_blt.src >> 8);        // bytes, positive scrolls right
+    int dy = (Sint8)(_blt.src & 0xFF);      // rows, positive scrolls down
+    if (!_blt_in_range(cpu, _blt.dst, w, h, _blt.dpitch)) {
+        return false;
+    }
+    _blt_temp.resize(w * h);
+    for (int y = 0; y < h; y++) {
+        Word row = _blt.dst + y * _blt.dpitch;
+        for (int x = 0; x < w; x++) { _blt_temp[y * w + x] = _blt_read(cpu, row + x); }
+    }
+    for (int y = 0; y < h; y++) {
+        Word row = _blt.dst + y * _blt.dpitch;
+        int sy = y - dy;
+        for (int x = 0; x < w; x++) {
+            int sx = x - dx;
+            bool inside = (sx >= 0 && sx < w && sy >= 0 && sy < h);
+            _blt_write(cpu, row + x, inside ? _blt_temp[sy * w + sx] : _blt.color);
+        }
+    }
+    _blt_done(cpu);
+    return true;
+} // END: GPU_EXT::_do_scroll()
+
+
+/**
+ * Scrolls a rectangle of the text screen by whole cells, moving the
+ * attribute and character bytes together and filling the exposed cells
+ * with spaces in the GPU_BLT_COLOR attribute. Only cells inside the
+ * region are touched, so the rest of the screen is left as is.
+ */
+bool GPU_EXT::_do_text_scroll()
+{
+    int cols = _gpu->_gpu_tcols;
+    int rows = _gpu->_gpu_trows;
+    int left = _blt.dst >> 8;
+    int top = _blt.dst & 0xFF;
+    int w = _blt.width, h = _blt.height;
+    int dx = (Sint8)(_blt.src >> 8);        // cells, positive scrolls right
+    int dy = (Sint8)(_blt.src & 0xFF);      // rows, positive scrolls down
+    if (w <= 0 || h <= 0) {
+        _gpu_error = MAP(GPU_ERR_ARGUMENT);
+        return false;
+    }
+    if (left + w > cols || top + h > rows || _video_start + cols * rows * 2 - 1 > _video_end) {
+        _gpu_error = MAP(GPU_ERR_ADDRESS);
+        return false;
+    }
+    _blt_temp.resize(w * h * 2);
+    for (int y = 0; y < h; y++) {
+        Word row = _video_start + ((top + y) * cols + left) * 2;
+        for (int x = 0; x < w * 2; x++) { _blt_temp[y * w * 2 + x] = memory(row + x); }
+    }
+    for (int y = 0; y < h; y++) {
+        Word row = _video_start + ((top + y) * cols + left) * 2;
+        int sy = y - dy;
+        for (int x = 0; x < w; x++) {
+            int sx = x - dx;
+            if (sx >= 0 && sx < w && sy >= 0 && sy < h) {
+                memory(row + x * 2 + 0, _blt_temp[(sy * w + sx) * 2 + 0]);
+                memory(row + x * 2 + 1, _blt_temp[(sy * w + sx) * 2 + 1]);
+            } else {
+                memory(row + x * 2 + 0, _blt.color);
+                memory(row + x * 2 + 1, ' ');
+            }
+        }
+    }
+    return true;
+} // END: GPU_EXT::_do_text_scroll()
+
+
+/**
+ * Bresenham line on a packed pixel surface at GPU_BLT_DST with
+ * GPU_BLT_DPITCH bytes per row, from (SRC, SPITCH) to (WIDTH, HEIGHT).
+ * Pixels falling outside of the address space are clipped and
+ * reported as GPU_ERR_ADDRESS once the line is complete.
+ */
+bool GPU_EXT::_do_draw_line()
+{
+    bool cpu = _blt.flags & BLT_DST_CPU;
+    int bpp = 1 << (_blt.flags & BLT_DEPTH);
+    int ppb = 8 / bpp;                  // pixels per byte
+    Byte mask = (1 << bpp) - 1;
+    Byte color = _blt.color & mask;
+    int lo = cpu ? _video_start : 0x0000;
+    int hi = cpu ? _video_end : 0xFFFF;
+
+    int x0 = _blt.src, y0 = _blt.spitch;
+    int x1 = _blt.width, y1 = _blt.height;
+    int dx = std::abs(x1 - x0), sx = (x0 < x1) ? 1 : -1;
+    int dy = -std::abs(y1 - y0), sy = (y0 < y1) ? 1 : -1;
+    int e = dx + dy;
+    bool clipped = false;
+    while (true)
+    {
+        int addr = _blt.dst + y0 * _blt.dpitch + x0 / ppb;
+        if (addr >= lo && addr <= hi) {
+            int shift = 8 - bpp * (x0 % ppb + 1);
+            Byte data = _blt_read(cpu, addr);
+            data = (data & ~(mask << shift)) | (color << shift);
+            _blt_write(cpu, addr, data);
+        } else {
+            clipped = true;
+        }
+        if (x0 == x1 && y0 == y1) { break; }
+        int e2 = 2 * e;
+        if (e2 >= dy) { e += dy; x0 += sx; }
+        if (e2 <= dx) { e += dx; y0 += sy; }
+    }
+    _blt_done(cpu);
+    if (clipped) {
+        _gpu_error = MAP(GPU_ERR_ADDRESS);
+        return false;
+    }
+    return true;
+} // END: GPU_EXT::_do_draw_line()
+
+
+bool GPU_EXT::_do_fill_rect()
+{
+    bool cpu = _blt.flags & BLT_DST_CPU;
+    int w = _blt.width, h = _blt.height;
+    if (!_blt_in_range(cpu, _blt.dst, w, h, _blt.dpitch)) {
+        return false;
+    }
+    for (int y = 0; y < h; y++) {
+        Word row = _blt.dst + y * _blt.dpitch;
+        for (int x = 0; x < w; x++) {
+            _blt_write(cpu, row + x, _blt_rop(_blt.color, _blt_read(cpu, row + x)));
+        }
+    }
+    _blt_done(cpu);
+    return true;
+} // END: GPU_EXT::_do_fill_rect()
+
+
+
+/**************
+* Raster Beam *
+**************/
+
+
+/**
+ * Called once per emulated CPU clock cycle. The beam covers
+ * RASTER_LINES * RASTER_HZ lines per second of emulated CPU time, so
+ * the accumulator counts in units of 1/cpu_hz of a line.
+ */
+void GPU_EXT::RasterClock(int cpu_hz)
+{
+    _raster_acc += RASTER_LINES * RASTER_HZ;
+    while (_raster_acc >= cpu_hz)
+    {
+        _raster_acc -= cpu_hz;
+        _raster_next_line();
+    }
+    _hold_interrupts();
+} // END: GPU_EXT::RasterClock()
+
+
+/**
+ * The CPU releases its interrupt lines after every clock, so a source
+ * that is still pending asserts its line again on each clock until the
+ * guest acknowledges it. An interrupt that arrives while CC.I or CC.F
+ * masks it is taken once the mask clears.
+ */
+void GPU_EXT::_hold_interrupts()
+{
+    if ((_vbl_ctrl & (VBL_ENABLE | VBL_PENDING)) == (VBL_ENABLE | VBL_PENDING))
+    {
+        if (_vbl_ctrl & VBL_FIRQ) { Bus::GetC6809()->firq(); }
+        else                      { Bus::GetC6809()->irq(); }
+    }
+    if ((_raster_ctrl & (RASTER_IRQ | RASTER_MATCH)) == (RASTER_IRQ | RASTER_MATCH))
+    {
+        Bus::GetC6809()->irq();
+    }
+    if ((_blt.flags & (BLT_IRQ | BLT_DONE)) == (BLT_IRQ | BLT_DONE))
+    {
+        Bus::GetC6809()->irq();
+    }
+} // END: GPU_EXT::_hold_interrupts()
+
+
+/**
+ * Advances the enabled palette cycling ranges by one vertical blank. A
+ * range due for a step only queues it; ApplyPaletteCycles() rotates the
+ * entries on the thread that composes the display.
+ */
+void GPU_EXT::_cycle_palette()
+{
+    for (int i = 0; i < CYCLE_RANGES; i++)
+    {
+        PAL_CYCLE& cycle = _cycles[i];
+        if ((cycle.flags & CYCLE_ENABLE) == 0 || cycle.end <= cycle.start) { continue; }
+        if (++cycle.count < cycle.rate) { continue; }
+        cycle.count = 0;
+        _cycle_steps[i].fetch_add((cycle.flags & CYCLE_REVERSE) ? -1 : 1, std::memory_order_relaxed);
+    }
+} // END: GPU_EXT::_cycle_palette()
+
+
+/**
+ * Rotates each range by the steps _cycle_palette() queued since the last
+ * call. The pixels keep their color indices, so nothing needs to be
+ * redrawn. The caller holds _compose_mutex: the main thread before it
+ * composes a frame, the CPU thread at the vertical blank while the
+ * scanline renderer composes the rows.
+ */
+void GPU_EXT::ApplyPaletteCycles()
+{
+    for (int i = 0; i < CYCLE_RANGES; i++)
+    {
+        int steps = _cycle_steps[i].exchange(0, std::memory_order_relaxed);
+        const PAL_CYCLE& cycle = _cycles[i];
+        if (steps == 0 || cycle.end <= cycle.start) { continue; }
+        int len = cycle.end - cycle.start + 1;
+        int up = ((steps % len) + len) % len;          // net places to move up
+        auto first = _gpu->_palette.begin() + cycle.start;
+        auto last = _gpu->_palette.begin() + cycle.end + 1;
+        std::rotate(first, last - up, last);
+    }
+} // END: GPU_EXT::ApplyPaletteCycles()
+
+
+void GPU_EXT::_raster_next_line()
+{
+    _raster_line = (_raster_line + 1) % RASTER_LINES;
+
+    if (_raster_ctrl & RASTER_SCANLINE)
+    {
+        if (_raster_line < RASTER_ACTIVE)
+        {
+            // compose a display row the first time the beam reaches it
+            int height = std::min((int)_gpu->_std_height, SCAN_HEIGHT);
+            int row = _raster_line * height / RASTER_ACTIVE;
+            if (row != _scan_row)
+            {
+                _scan_row = row;
+                std::lock_guard<std::mutex> lock(_compose_mutex);
+                _gpu->_render_std_line(&_scan_std[0][row * SCAN_WIDTH], row);
+                _gpu->_render_ext_line(&_scan_ext[0][row * SCAN_WIDTH], row);
+            }
+        }
+        else if (_raster_line == RASTER_ACTIVE)
+        {
+            // the visible frame is complete
+            std::lock_guard<std::mutex> lock(_scan_mutex);
+            std::swap(_scan_std[0], _scan_std[1]);
+            std::swap(_scan_ext[0], _scan_ext[1]);
+            _scan_row = -1;
+        }
+    }
+
+    if (_raster_line == RASTER_ACTIVE)
+    {
+        // start of the vertical blank
+        if (_page_flip)
+        {
+            // the cached tiles were built from the previous page
+            _gpu->_ext_display = _page_request;
+            _page_flip = false;
+            for (auto& layer : _layers) { _invalidate_tiles(layer); }
+        }
+        _cycle_palette();
+        if (_raster_ctrl & RASTER_SCANLINE)
+        {
+            // the rows of the next frame are composed on this thread
+            std::lock_guard<std::mutex> lock(_compose_mutex);
+            ApplyPaletteCycles();
+        }
+        _vbl_frame++;
+        _vbl_ctrl |= VBL_PENDING;
+    }
+
+    if (_raster_line == _raster_cmp)
+    {
+        _raster_ctrl |= RASTER_MATCH;
+    }
+} // END: GPU_EXT::_raster_next_line()
+
+
+void GPU_EXT::CopyScanlines(void* std_pixels, int std_pitch, void* ext_pixels, int ext_pitch)
+{
+    int width = std::min((int)_gpu->_std_width, SCAN_WIDTH);
+    int height = std::min((int)_gpu->_std_height, SCAN_HEIGHT);
+    std::lock_guard<std::mutex> lock(_scan_mutex);
+    for (int y = 0; y < height; y++)
+    {
+        std::copy_n(&_scan_std[1][y * SCAN_WIDTH], width, (Uint16*)((Uint8*)std_pixels + (y * std_pitch)));
+        std::copy_n(&_scan_ext[1][y * SCAN_WIDTH], width, (Uint16*)((Uint8*)ext_pixels + (y * ext_pitch)));
+    }
+} // END: GPU_EXT::CopyScanlines()
+
+
+
+/*************
+* Unit Tests *
+*************/
+
+
+bool GPU_EXT::_test_tilemap()
+{
+    bool test_results = true;
+    Byte old_layer = Memory::Read(MAP(GPU_TMAP_LAYER));
+    TILE_LAYER saved = _layers[0];
+    std::vector<Byte> saved_vram(_gpu->_ext_video_buffer.begin(), _gpu->_ext_video_buffer.begin() + 0x0200);
+
+    // 16 color 8x8 tiles at $0100, a 2x1 map at $0000
+    Memory::Write(MAP(GPU_TMAP_LAYER), (Byte)0);
+    Memory::Write(MAP(GPU_TMAP_FLAGS), (Byte)(TMAP_ENABLE | 0x02));
+    Memory::Write(MAP(GPU_TMAP_WIDTH), (Byte)2);
+    Memory::Write(MAP(GPU_TMAP_HEIGHT), (Byte)1);
+    Memory::Write_Word(MAP(GPU_TMAP_XPOS), (Word)4);
+    Memory::Write_Word(MAP(GPU_TMAP_YPOS), (Word)0);
+    Memory::Write_Word(MAP(GPU_TMAP_ADDR), (Word)0x0000);
+    Memory::Write_Word(MAP(GPU_TILE_ADDR), (Word)0x0100);
+
+    // upload the map and two solid tiles through the data port
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0000);
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0);
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)1);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0100);
+    for (int i = 0; i < 64; i++) {
+        Memory::Write(MAP(GPU_DYN_DATA), (Byte)(i < 32 ? 0x11 : 0x22));
+    }
+    ASSERT(Memory::Read_Word(MAP(GPU_DYN_ADDR)) == 0x0140, "GPU_DYN_ADDR did not auto-increment");
+
+    // render a 16x8 strip: scrolled 4 pixels into tile 0, then tile 1, then wrap to tile 0
+    std::vector<Uint16> bfr(16 * 8, 0xDEAD);
+    RenderTilemap(bfr.data(), 16 * sizeof(Uint16), 16, 8);
+    Word c1 = 0xF000 | (_gpu->_palette[1].color & 0x0FFF);
+    Word c2 = 0xF000 | (_gpu->_palette[2].color & 0x0FFF);
+    if (!ASSERT_TRUE(bfr[0] == c1 && bfr[3] == c1 && bfr[4] == c2 && bfr[11] == c2 && bfr[12] == c1)) {
+        UnitTest::Log(this, clr::RED + "tilemap scroll or wrap-around rendered incorrectly");
+        test_results = false;
+    }
+
+    // rewriting tile graphics must invalidate the cached tile
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0120);
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x33);
+    RenderTilemap(bfr.data(), 16 * sizeof(Uint16), 16, 8);
+    Word c3 = 0xF000 | (_gpu->_palette[3].color & 0x0FFF);
+    if (!ASSERT_TRUE(bfr[4] == c3 && bfr[6] == c2)) {
+        UnitTest::Log(this, clr::RED + "tile cache was not invalidated by a write");
+        test_results = false;
+    }
+
+    // restore the previous state
+    std::copy(saved_vram.begin(), saved_vram.end(), _gpu->_ext_video_buffer.begin());
+    _layers[0] = saved;
+    _invalidate_tiles(_layers[0]);
+    Memory::Write(MAP(GPU_TMAP_LAYER), old_layer);
+    return test_results;
+} // END: GPU_EXT::_test_tilemap()
+
+
+bool GPU_EXT::_test_dyn_port()
+{
+    bool test_results = true;
+    TILE_LAYER saved = _layers[0];
+    std::vector<Byte> saved_vram(_gpu->_ext_video_buffer.begin(), _gpu->_ext_video_buffer.begin() + 0x0400);
+
+    // 2 byte and pitch steps
+    Memory::Write(MAP(GPU_DYN_CTRL), (Byte)DYN_STEP_2);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0000);
+    for (Byte i = 1; i <= 3; i++) { Memory::Write(MAP(GPU_DYN_DATA), i); }
+    Word after_step2 = Memory::Read_Word(MAP(GPU_DYN_ADDR));
+    Memory::Write(MAP(GPU_DYN_CTRL), (Byte)DYN_STEP_PITCH);
+    Memory::Write_Word(MAP(GPU_DYN_PITCH), (Word)40);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0100);
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x44);
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x55);
+    const std::vector<Byte>& vram = _gpu->_ext_video_buffer;
+    if (!ASSERT_TRUE(vram[0] == 1 && vram[2] == 2 && vram[4] == 3 && after_step2 == 0x0006 &&
+                     vram[0x0100] == 0x44 && vram[0x0128] == 0x55)) {
+        UnitTest::Log(this, clr::RED + "GPU_DYN_CTRL address step is incorrect");
+        test_results = false;
+    }
+
+    // 16-bit port: one store per word, big endian, advancing one word
+    Memory::Write(MAP(GPU_DYN_CTRL), (Byte)DYN_STEP_1);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0200);
+    Memory::Write_Word(MAP(GPU_DYN_DATA16), (Word)0xABCD);
+    Memory::Write_Word(MAP(GPU_DYN_DATA16), (Word)0x1234);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0200);
+    Word peeked = (Word)((Memory::Peek(MAP(GPU_DYN_DATA16)) << 8) | Memory::Peek(MAP(GPU_DYN_DATA16) + 1));
+    Byte peeked8 = Memory::Peek(MAP(GPU_DYN_DATA));
+    Word first = Memory::Read_Word(MAP(GPU_DYN_DATA16));
+    Word second = Memory::Read_Word(MAP(GPU_DYN_DATA16));
+    if (!ASSERT_TRUE(vram[0x0200] == 0xAB && vram[0x0201] == 0xCD && vram[0x0203] == 0x34 &&
+                     peeked == 0xABCD && peeked8 == 0xAB &&     // the debugger's peeks do not advance
+                     first == 0xABCD && second == 0x1234 && Memory::Read_Word(MAP(GPU_DYN_ADDR)) == 0x0204)) {
+        UnitTest::Log(this, clr::RED + "GPU_DYN_DATA16 transferred the wrong words");
+        test_results = false;
+    }
+
+    // port writes drop only the cached tiles they touched (16 color 8x8
+    // tiles of 32 bytes at $0000), once, when the tiles are next drawn
+    _layers[0].flags = TMAP_ENABLE | 0x02;
+    _layers[0].tile_addr = 0x0000;
+    _dyn_flush();                                               // drop the span of the tests above
+    _layers[0].valid.set();
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x003E);
+    Memory::Write_Word(MAP(GPU_DYN_DATA16), (Word)0x0000);     // end of tile 1
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x00);               // start of tile 2
+    bool deferred = _layers[0].valid.all();
+    _dyn_flush();
+    if (!ASSERT_TRUE(deferred && _layers[0].valid.test(0) && !_layers[0].valid.test(1) &&
+                     !_layers[0].valid.test(2) && _layers[0].valid.test(3))) {
+        UnitTest::Log(this, clr::RED + "GPU_DYN_DATA writes did not invalidate the right tiles");
+        test_results = false;
+    }
+
+    // restore the previous state
+    std::copy(saved_vram.begin(), saved_vram.end(), _gpu->_ext_video_buffer.begin());
+    _layers[0] = saved;
+    _invalidate_tiles(_layers[0]);
+    _dyn_ctrl = DYN_STEP_1;
+    _dyn_pitch = 0;
+    return test_results;
+} // END: GPU_EXT::_test_dyn_port()
+
+
+bool GPU_EXT::_test_sprites()
+{
+    bool test_results = true;
+    auto saved = _sprites;
+    std::vector<Byte> saved_vram(_gpu->_ext_video_buffer.begin(), _gpu->_ext_video_buffer.begin() + 0x0100);
+
+    // a 2-color image at $0000: left half of each row opaque
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0000);
+    for (int row = 0; row < 16; row++) {
+        Memory::Write(MAP(GPU_DYN_DATA), (Byte)0xFF);
+        Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x00);
+    }
+    // sprite 0 at (0,0) and sprite 1 at (12,4), both drawing color 1 + palette offset
+    for (Byte i = 0; i < 2; i++) {
+        Memory::Write(MAP(GPU_SPR_IDX), i);
+        Memory::Write_Word(MAP(GPU_SPR_XPOS), (Word)(i ? 12 : 0));
+        Memory::Write_Word(MAP(GPU_SPR_YPOS), (Word)(i ? 4 : 0));
+        Memory::Write_Word(MAP(GPU_SPR_ADDR), (Word)0x0000);
+        Memory::Write(MAP(GPU_SPR_PAL), (Byte)(i ? 1 : 0));
+        Memory::Write(MAP(GPU_SPR_PRIORITY), (Byte)0);
+        Memory::Write(MAP(GPU_SPR_FLAGS), (Byte)(SPR_ENABLE | SPR_COLLIDE | (i ? SPR_FLIP_H : 0)));
+    }
+
+    // sprite 1 is flipped, so its opaque half spans x=20..27; no overlap with x=0..7
+    std::vector<Uint16> bfr(32 * 24, 0);
+    UpdateSprites();
+    RenderSprites(bfr.data(), 32 * sizeof(Uint16), 32, 24);
+    Word c1 = 0xF000 | (_gpu->_palette[1].color & 0x0FFF);
+    Word c2 = 0xF000 | (_gpu->_palette[2].color & 0x0FFF);
+    if (!ASSERT_TRUE(bfr[0] == c1 && bfr[8] == 0 && bfr[4 * 32 + 20] == c2 && bfr[4 * 32 + 19] == 0)) {
+        UnitTest::Log(this, clr::RED + "sprite pixels, flip or palette offset rendered incorrectly");
+        test_results = false;
+    }
+    Memory::Write(MAP(GPU_SPR_IDX), (Byte)0);
+    if (!ASSERT_TRUE(Memory::Read_DWord(MAP(GPU_COLL_MAP) + 4) == 0)) {
+        UnitTest::Log(this, clr::RED + "false sprite collision reported");
+        test_results = false;
+    }
+
+    // move sprite 1 so that its opaque half overlaps sprite 0 (bounding boxes alone overlapped before);
+    // the hit is reported without drawing, as on a skipped frame
+    Memory::Write(MAP(GPU_SPR_IDX), (Byte)1);
+    Memory::Write_Word(MAP(GPU_SPR_XPOS), (Word)(-4 & 0xFFFF));
+    UpdateSprites();
+    Memory::Write(MAP(GPU_SPR_IDX), (Byte)0);
+    if (!ASSERT_TRUE(Memory::Read_DWord(MAP(GPU_SPR_HITS) + 4) == 0x02 && Memory::Read_DWord(MAP(GPU_COLL_MAP) + 4) == 0x03)) {
+        UnitTest::Log(this, clr::RED + "sprite collision was not reported");
+        test_results = false;
+    }
+
+    // restore the previous state
+    std::copy(saved_vram.begin(), saved_vram.end(), _gpu->_ext_video_buffer.begin());
+    _sprites = saved;
+    _spr_hits.fill(0);
+    _coll_map = 0;
+    Memory::Write(MAP(GPU_SPR_IDX), (Byte)0);
+    return test_results;
+} // END: GPU_EXT::_test_sprites()
+
+
+bool GPU_EXT::_test_blitter()
+{
+    bool test_results = true;
+    BLITTER saved = _blt;
+    std::vector<Byte>& vram = _gpu->_ext_video_buffer;
+    std::vector<Byte> saved_vram(vram.begin(), vram.begin() + 0x0100);
+    std::vector<Byte> saved_video;
+    for (int a = _video_start; a < _video_start + 0x40; a++) { saved_video.push_back(memory(a)); }
+
+    // FILL_RECT a 4x3 block of $AA into a 16 byte wide surface at $0000
+    std::fill(vram.begin(), vram.begin() + 0x0100, 0);
+    Memory::Write(MAP(GPU_BLT_FLAGS), (Byte)0);
+    Memory::Write(MAP(GPU_BLT_ROP), (Byte)ROP_COPY);
+    Memory::Write_Word(MAP(GPU_BLT_DST), (Word)0x0011);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)4);
+    Memory::Write_Word(MAP(GPU_BLT_HEIGHT), (Word)3);
+    Memory::Write_Word(MAP(GPU_BLT_DPITCH), (Word)16);
+    Memory::Write(MAP(GPU_BLT_COLOR), (Byte)0xAA);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_FILL_RECT));
+    if (!ASSERT_TRUE(vram[0x11] == 0xAA && vram[0x14] == 0xAA && vram[0x15] == 0 && vram[0x31] == 0xAA && vram[0x41] == 0
+            && Memory::Read(MAP(GPU_ERROR)) == MAP(GPU_ERR_NONE))) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_FILL_RECT filled the wrong bytes");
+        test_results = false;
+    }
+
+    // BLIT the block to the video buffer, XOR'd with $FF, with $00 keyed out
+    for (int a = _video_start; a < _video_start + 0x40; a++) { memory(a, 0x0F); }
+    Memory::Write(MAP(GPU_BLT_FLAGS), (Byte)(BLT_DST_CPU | BLT_KEY));
+    Memory::Write(MAP(GPU_BLT_ROP), (Byte)ROP_XOR);
+    Memory::Write(MAP(GPU_BLT_KEY), (Byte)0x00);
+    Memory::Write_Word(MAP(GPU_BLT_SRC), (Word)0x0010);
+    Memory::Write_Word(MAP(GPU_BLT_SPITCH), (Word)16);
+    Memory::Write_Word(MAP(GPU_BLT_DST), _video_start);
+    Memory::Write_Word(MAP(GPU_BLT_DPITCH), (Word)8);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)2);
+    Memory::Write_Word(MAP(GPU_BLT_HEIGHT), (Word)2);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_BLIT));
+    if (!ASSERT_TRUE(memory(_video_start) == 0x0F && memory(_video_start + 1) == 0xA5 && memory(_video_start + 9) == 0xA5)) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_BLIT color key or raster operation failed");
+        test_results = false;
+    }
+
+    // SCROLL the 16x4 ext surface up one row and left one byte, filling with $55
+    Memory::Write(MAP(GPU_BLT_FLAGS), (Byte)0);
+    Memory::Write_Word(MAP(GPU_BLT_DST), (Word)0x0000);
+    Memory::Write_Word(MAP(GPU_BLT_DPITCH), (Word)16);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)16);
+    Memory::Write_Word(MAP(GPU_BLT_HEIGHT), (Word)4);
+    Memory::Write_Word(MAP(GPU_BLT_SRC), (Word)0xFFFF);
+    Memory::Write(MAP(GPU_BLT_COLOR), (Byte)0x55);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_SCROLL));
+    if (!ASSERT_TRUE(vram[0x00] == 0xAA && vram[0x03] == 0xAA && vram[0x04] == 0 && vram[0x0F] == 0x55 && vram[0x30] == 0x55)) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_SCROLL shifted the wrong bytes");
+        test_results = false;
+    }
+
+    // DRAW_LINE a diagonal at 2 colors per pixel: (0,0) to (9,9)
+    std::fill(vram.begin(), vram.begin() + 0x0100, 0);
+    Memory::Write(MAP(GPU_BLT_FLAGS), (Byte)0x00);
+    Memory::Write(MAP(GPU_BLT_COLOR), (Byte)1);
+    Memory::Write_Word(MAP(GPU_BLT_SRC), (Word)0);
+    Memory::Write_Word(MAP(GPU_BLT_SPITCH), (Word)0);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)9);
+    Memory::Write_Word(MAP(GPU_BLT_HEIGHT), (Word)9);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_DRAW_LINE));
+    if (!ASSERT_TRUE(vram[0x00] == 0x80 && vram[0x10] == 0x40 && vram[0x70] == 0x01 && vram[0x81] == 0x80 && vram[0x91] == 0x40)) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_DRAW_LINE plotted the wrong pixels");
+        test_results = false;
+    }
+
+    // COPY out of the video buffer and invalid requests
+    Memory::Write(MAP(GPU_BLT_FLAGS), (Byte)BLT_SRC_CPU);
+    Memory::Write_Word(MAP(GPU_BLT_SRC), _video_end);
+    Memory::Write_Word(MAP(GPU_BLT_DST), (Word)0x0000);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)2);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_COPY));
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_ERROR)) == MAP(GPU_ERR_ADDRESS))) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_COPY past VIDEO_END was not rejected");
+        test_results = false;
+    }
+
+    // TEXT_SCROLL columns 1-3 of rows 0-2 up one row; column 0 stays put
+    int cols = _gpu->_gpu_tcols;
+    std::vector<Byte> saved_text;
+    for (int a = 0; a < cols * 2 * 3; a++) { saved_text.push_back(memory(_video_start + a)); }
+    auto cell = [&](int col, int row) { return (Word)(_video_start + (row * cols + col) * 2); };
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 4; c++) {
+            memory(cell(c, r) + 0, (Byte)(0x10 + r));
+            memory(cell(c, r) + 1, (Byte)('A' + r * 4 + c));
+        }
+    }
+    Memory::Write_Word(MAP(GPU_BLT_DST), (Word)0x0100);
+    Memory::Write_Word(MAP(GPU_BLT_WIDTH), (Word)3);
+    Memory::Write_Word(MAP(GPU_BLT_HEIGHT), (Word)3);
+    Memory::Write_Word(MAP(GPU_BLT_SRC), (Word)0x00FF);
+    Memory::Write(MAP(GPU_BLT_COLOR), (Byte)0x4F);
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_TEXT_SCROLL));
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_ERROR)) == MAP(GPU_ERR_NONE) &&
+                     memory(cell(0, 0) + 1) == 'A' && memory(cell(1, 0) + 0) == 0x11 && memory(cell(1, 0) + 1) == 'F' &&
+                     memory(cell(3, 1) + 1) == 'L' && memory(cell(2, 2) + 0) == 0x4F && memory(cell(2, 2) + 1) == ' ' &&
+                     memory(cell(0, 2) + 1) == 'I')) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_TEXT_SCROLL moved the wrong cells");
+        test_results = false;
+    }
+    Memory::Write_Word(MAP(GPU_BLT_DST), (Word)((cols - 1) << 8));
+    Memory::Write(MAP(GPU_COMMAND), (Byte)MAP(GPU_CMD_TEXT_SCROLL));
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_ERROR)) == MAP(GPU_ERR_ADDRESS))) {
+        UnitTest::Log(this, clr::RED + "GPU_CMD_TEXT_SCROLL past the last column was not rejected");
+        test_results = false;
+    }
+    for (int a = 0; a < cols * 2 * 3; a++) { memory(_video_start + a, saved_text[a]); }
+
+    Memory::Write(MAP(GPU_COMMAND), (Byte)(MAP(GPU_CMD_SIZE) + 1));
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_ERROR)) == MAP(GPU_ERR_COMMAND))) {
+        UnitTest::Log(this, clr::RED + "invalid GPU_COMMAND was not rejected");
+        test_results = false;
+    }
+
+    // restore the previous state
+    std::copy(saved_vram.begin(), saved_vram.end(), vram.begin());
+    for (int i = 0; i < 0x40; i++) { memory(_video_start + i, saved_video[i]); }
+    _blt = saved;
+    _gpu_error = 0;
+    _gpu_command = 0;
+    for (auto& layer : _layers) { _invalidate_tiles(layer); }
+    return test_results;
+} // END: GPU_EXT::_test_blitter()
+
+
+bool GPU_EXT::_test_raster()
+{
+    bool test_results = true;
+    Word saved_line = _raster_line;
+    Word saved_cmp = _raster_cmp;
+    Byte saved_ctrl = _raster_ctrl;
+    const int one_line = RASTER_LINES * RASTER_HZ;     // a clock rate of one line per cycle
+
+    // the compare match flag is set on the compare line and acknowledged by writing 1
+    _raster_line = 0;
+    _raster_acc = 0;
+    Memory::Write(MAP(GPU_RASTER_CTRL), (Byte)RASTER_MATCH);
+    Memory::Write_Word(MAP(GPU_RASTER_CMP), (Word)10);
+    for (int i = 0; i < 9; i++) { RasterClock(one_line); }
+    if (!ASSERT_TRUE((Memory::Read(MAP(GPU_RASTER_CTRL)) & RASTER_MATCH) == 0)) {
+        UnitTest::Log(this, clr::RED + "raster compare matched early");
+        test_results = false;
+    }
+    RasterClock(one_line);
+    if (!ASSERT_TRUE(Memory::Read_Word(MAP(GPU_RASTER_LINE)) == 10 && (Memory::Read(MAP(GPU_RASTER_CTRL)) & RASTER_MATCH))) {
+        UnitTest::Log(this, clr::RED + "raster compare did not match on line 10");
+        test_results = false;
+    }
+    Memory::Write(MAP(GPU_RASTER_CTRL), (Byte)RASTER_MATCH);
+    for (int i = 0; i < RASTER_LINES - 10; i++) { RasterClock(one_line); }
+    if (!ASSERT_TRUE(Memory::Read_Word(MAP(GPU_RASTER_LINE)) == 0 && Memory::Read(MAP(GPU_RASTER_CTRL)) == 0)) {
+        UnitTest::Log(this, clr::RED + "raster did not wrap after " + std::to_string(RASTER_LINES) + " lines");
+        test_results = false;
+    }
+
+    // a palette change half way down the frame shows up on the lower rows only
+    if ((_gpu->_gpu_mode & 0b1000'1000'0000'0000) == 0b1000'1000'0000'0000)
+    {
+        std::vector<Byte> saved_vram = _gpu->_ext_video_buffer;
+        int bpp = 1 << (((_gpu->_gpu_mode >> 12) & 0x03));
+        Byte index = (1 << bpp) - 1;
+        Word saved_color = _gpu->_palette[index].color;
+        int height = (int)_gpu->_std_height;
+        std::fill(_gpu->_ext_video_buffer.begin(), _gpu->_ext_video_buffer.end(), 0xFF);
+
+        Memory::Write(MAP(GPU_RASTER_CTRL), (Byte)RASTER_SCANLINE);
+        _gpu->_palette[index].color = 0xFF00;
+        for (int i = 0; i < RASTER_ACTIVE / 2; i++) { RasterClock(one_line); }
+        _gpu->_palette[index].color = 0xF0F0;
+        for (int i = RASTER_ACTIVE / 2; i < RASTER_ACTIVE; i++) { RasterClock(one_line); }
+        std::vector<Uint16> std_bfr(SCAN_WIDTH * SCAN_HEIGHT), ext_bfr(SCAN_WIDTH * SCAN_HEIGHT);
+        CopyScanlines(std_bfr.data(), SCAN_WIDTH * sizeof(Uint16), ext_bfr.data(), SCAN_WIDTH * sizeof(Uint16));
+        if (!ASSERT_TRUE(ext_bfr[0] == 0xFF00 && ext_bfr[(height - 1) * SCAN_WIDTH] == 0xF0F0)) {
+            UnitTest::Log(this, clr::RED + "scanline renderer missed a mid-frame palette change");
+            test_results = false;
+        }
+
+        _gpu->_palette[index].color = saved_color;
+        _gpu->_ext_video_buffer = saved_vram;
+        for (int i = RASTER_ACTIVE; i < RASTER_LINES; i++) { RasterClock(one_line); }
+    }
+
+    // restore the previous state
+    _raster_line = saved_line;
+    _raster_cmp = saved_cmp;
+    _raster_ctrl = saved_ctrl;
+    _raster_acc = 0;
+    return test_results;
+} // END: GPU_EXT::_test_raster()
+
+
+bool GPU_EXT::_test_vblank()
+{
+    bool test_results = true;
+    Word saved_line = _raster_line;
+    Byte saved_ctrl = _vbl_ctrl;
+    Word saved_frame = _vbl_frame;
+    const int one_line = RASTER_LINES * RASTER_HZ;     // a clock rate of one line per cycle
+
+    // the interrupt itself is left disabled; the CPU is not running yet
+    _raster_line = 0;
+    _raster_acc = 0;
+    Memory::Write(MAP(GPU_VBL_CTRL), (Byte)VBL_PENDING);
+    Word frame = Memory::Read_Word(MAP(GPU_VBL_FRAME));
+    for (int i = 0; i < RASTER_ACTIVE - 1; i++) { RasterClock(one_line); }
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_VBL_CTRL)) == 0 && Memory::Read_Word(MAP(GPU_VBL_FRAME)) == frame)) {
+        UnitTest::Log(this, clr::RED + "vertical blank reported during the visible lines");
+        test_results = false;
+    }
+    RasterClock(one_line);
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_VBL_CTRL)) == (VBL_VSYNC | VBL_PENDING) && Memory::Read_Word(MAP(GPU_VBL_FRAME)) == (Word)(frame + 1))) {
+        UnitTest::Log(this, clr::RED + "vertical blank was not reported on line " + std::to_string(RASTER_ACTIVE));
+        test_results = false;
+    }
+    Memory::Write(MAP(GPU_VBL_CTRL), (Byte)VBL_PENDING);
+    for (int i = RASTER_ACTIVE; i < RASTER_LINES; i++) { RasterClock(one_line); }
+    if (!ASSERT_TRUE(Memory::Read(MAP(GPU_VBL_CTRL)) == 0)) {
+        UnitTest::Log(this, clr::RED + "vertical blank was not acknowledged or VSYNC did not end");
+        test_results = false;
+    }
+
+    // restore the previous state
+    _raster_line = saved_line;
+    _vbl_ctrl = saved_ctrl;
+    _vbl_frame = saved_frame;
+    _raster_acc = 0;
+    return test_results;
+} // END: GPU_EXT::_test_vblank()
+
+
+bool GPU_EXT::_test_pages()
+{
+    bool test_results = true;
+    Word saved_line = _raster_line;
+    Byte saved_ctrl = _vbl_ctrl;
+    Word saved_frame = _vbl_frame;
+    std::vector<Byte>& vram = _gpu->_ext_video_buffer;
+    Byte saved_bytes[2] = { vram[0x00000], vram[0x10000] };
+    const int one_line = RASTER_LINES * RASTER_HZ;     // a clock rate of one line per cycle
+
+    // the data port writes the draw page only
+    Memory::Write(MAP(GPU_PAGE_DRAW), (Byte)1);
+    Memory::Write(MAP(GPU_DYN_CTRL), (Byte)DYN_STEP_1);
+    Memory::Write_Word(MAP(GPU_DYN_ADDR), (Word)0x0000);
+    vram[0x00000] = 0x00;
+    Memory::Write(MAP(GPU_DYN_DATA), (Byte)0x5A);
+    if (!ASSERT_TRUE(vram[0x00000] == 0x00 && vram[0x10000] == 0x5A && Memory::Read(MAP(GPU_PAGE_DRAW)) == 1)) {
+        UnitTest::Log(this, clr::RED + "GPU_PAGE_DRAW did not select the written page");
+        test_results = false;
+    }
+
+    // a display flip waits for the vertical blank
+    _raster_line = 0;
+    _raster_acc = 0;
+    Memory::Write(MAP(GPU_PAGE_DISPLAY), (Byte)1);
+    for (int i = 0; i < RASTER_ACTIVE - 1; i++) { RasterClock(one_line); }
+    Byte before = Memory::Read(MAP(GPU_PAGE_DISPLAY));
+    RasterClock(one_line);
+    Byte after = Memory::Read(MAP(GPU_PAGE_DISPLAY));
+    if (!ASSERT_TRUE(before == PAGE_PENDING && after == 1 && _gpu->_ext_display_page() == &vram[0x10000])) {
+        UnitTest::Log(this, clr::RED + "GPU_PAGE_DISPLAY did not flip at the vertical blank");
+        test_results = false;
+    }
+
+    // restore the previous state
+    for (int i = RASTER_ACTIVE; i < RASTER_LINES; i++) { RasterClock(one_line); }
+    Memory::Write(MAP(GPU_PAGE_DISPLAY), (Byte)0);
+    Memory::Write(MAP(GPU_PAGE_DRAW), (Byte)0);
+    _gpu->_ext_display = 0;
+    _page_flip = false;
+    vram[0x00000] = saved_bytes[0];
+    vram[0x10000] = saved_bytes[1];
+    for (auto& layer : _layers) { _invalidate_tiles(layer); }
+    _raster_line = saved_line;
+    _vbl_ctrl = saved_ctrl;
+    _vbl_frame = saved_frame;
+    _raster_acc = 0;
+    return test_results;
+} // END: GPU_EXT::_test_pages()
+
+
+bool GPU_EXT::_test_cycle()
+{
+    bool test_results = true;
+    Word saved_line = _raster_line;
+    Byte saved_ctrl = _vbl_ctrl;
+    Word saved_frame = _vbl_frame;
+    auto saved_palette = _gpu->_palette;
+    const int one_line = RASTER_LINES * RASTER_HZ;     // a clock rate of one line per cycle
+    auto vblank = [&]() {
+        _raster_line = RASTER_ACTIVE - 1;
+        _raster_acc = 0;
+        RasterClock(one_line);
+        ApplyPaletteCycles();       // as GPU::OnUpdate() does
+    };
+    auto color = [&](int index) { return _gpu->_palette[index].color; };
+    Word c40 = color(0x40), c41 = color(0x41), c42 = color(0x42);
+
+    // range 3 moves $40-$42 up one place every second vertical blank
+    Memory::Write(MAP(GPU_CYCLE_IDX), (Byte)3);
+    Memory::Write(MAP(GPU_CYCLE_START), (Byte)0x40);
+    Memory::Write(MAP(GPU_CYCLE_END), (Byte)0x42);
+    Memory::Write(MAP(GPU_CYCLE_RATE), (Byte)2);
+    Memory::Write(MAP(GPU_CYCLE_FLAGS), (Byte)CYCLE_ENABLE);
+    vblank();
+    bool waited = color(0x40) == c40 && color(0x41) == c41 && color(0x42) == c42;
+    vblank();
+    if (!ASSERT_TRUE(waited && color(0x40) == c42 && color(0x41) == c40 && color(0x42) == c41 && color(0x3F) == saved_palette[0x3F].color)) {
+        UnitTest::Log(this, clr::RED + "palette range did not rotate up at its rate");
+        test_results = false;
+    }
+
+    // the raster only queues the step; the palette changes when it is applied
+    Memory::Write(MAP(GPU_CYCLE_FLAGS), (Byte)(CYCLE_ENABLE | CYCLE_REVERSE));
+    vblank();
+    _raster_line = RASTER_ACTIVE - 1;
+    RasterClock(one_line);
+    if (!ASSERT_TRUE(color(0x40) == c42 && _cycle_steps[3] == -1)) {
+        UnitTest::Log(this, clr::RED + "palette rotated outside ApplyPaletteCycles()");
+        test_results = false;
+    }
+
+    // and back down again
+    ApplyPaletteCycles();
+    if (!ASSERT_TRUE(color(0x40) == c40 && color(0x41) == c41 && color(0x42) == c42)) {
+        UnitTest::Log(this, clr::RED + "palette range did not rotate down");
+        test_results = false;
+    }
+
+    // the scanline renderer rotates the palette at the vertical blank itself
+    Byte saved_raster = _raster_ctrl;
+    _raster_ctrl |= RASTER_SCANLINE;
+    for (int i = 0; i < 2; i++) {
+        _raster_line = RASTER_ACTIVE - 1;
+        RasterClock(one_line);
+    }
+    _raster_ctrl = saved_raster;
+    _scan_row = -1;
+    if (!ASSERT_TRUE(color(0x40) == c41 && _cycle_steps[3] == 0)) {
+        UnitTest::Log(this, clr::RED + "palette was not rotated at the vertical blank in scanline mode");
+        test_results = false;
+    }
+
+    // restore the previous state
+    Memory::Write(MAP(GPU_CYCLE_FLAGS), (Byte)0);
+    Memory::Write(MAP(GPU_CYCLE_IDX), (Byte)0);
+    _cycles[3] = PAL_CYCLE{};
+    _gpu->_palette = saved_palette;
+    _raster_line = saved_line;
+    _vbl_ctrl = saved_ctrl;
+    _vbl_frame = saved_frame;
+    _raster_acc = 0;
+    return test_results;
+} // END: GPU_EXT::_test_cycle()
+
+
+// END: GPU_EXT.cpp
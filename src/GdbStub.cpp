@@ -0,0 +1,468 @@
+/*** GdbStub.cpp ****************************
+ *     _____     _ _      _____ _         _
+ *    / ____|   | | |    / ____| |       | |
+ *   | |  __  __| | |__ | (___ | |_ _   _| |__       ___ _ __  _ __
+ *   | | |_ |/ _` | '_ \ \___ \| __| | | | '_ \     / __| '_ \| '_ \
+ *   | |__| | (_| | |_) |____) | |_| |_| | |_) |  _| (__| |_) | |_) |
+ *    \_____|\__,_|_.__/|_____/ \__|\__,_|_.__/  (_)\___| .__/| .__/
+ *                                                      | |   | |
+ *                                                      |_|   |_|
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if !defined(_WIN32)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#include "GdbStub.hpp"
+#include "Bus.hpp"
+#include "C6809.hpp"
+#include "Debug.hpp"
+#include "Memory.hpp"
+
+
+namespace {
+
+    std::string to_hex(Uint32 value, int digits)
+    {
+        std::string s(digits, '0');
+        for (int i = digits - 1; i >= 0; i--, value >>= 4) { s[i] = "0123456789abcdef"[value & 0xF]; }
+        return s;
+    }
+
+    // parses hex digits at pos, stopping at the first other character
+    Uint32 from_hex(const std::string& s, size_t& pos)
+    {
+        Uint32 value = 0;
+        while (pos < s.size() && std::isxdigit((unsigned char)s[pos])) {
+            char c = s[pos++];
+            value = (value << 4) | (Uint32)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        return value;
+    }
+
+    // register number -> size in bytes, as listed in GdbStub.hpp
+    constexpr int REG_SIZE[GdbStub::REG_COUNT] = { 1, 1, 1, 2, 2, 2, 2, 2, 1 };
+
+    // the live registers while the CPU thread is held; otherwise the
+    // snapshot it publishes, since the live ones change under the reader
+    C6809::CPU_STATE read_regs(C6809* cpu, bool halted)
+    {
+        if (!halted) { return cpu->GetState(); }
+        C6809::CPU_STATE regs;
+        regs.cc = cpu->getCC();
+        regs.a = cpu->getA();
+        regs.b = cpu->getB();
+        regs.x = cpu->getX();
+        regs.y = cpu->getY();
+        regs.u = cpu->getU();
+        regs.pc = cpu->getPC();
+        regs.s = cpu->getS();
+        regs.dp = cpu->getDP();
+        return regs;
+    }
+
+    Word get_reg(const C6809::CPU_STATE& regs, int reg)
+    {
+        switch (reg)
+        {
+            case 0:  return regs.cc;
+            case 1:  return regs.a;
+            case 2:  return regs.b;
+            case 3:  return regs.x;
+            case 4:  return regs.y;
+            case 5:  return regs.u;
+            case 6:  return regs.pc;
+            case 7:  return regs.s;
+            default: return regs.dp;
+        }
+    }
+
+    void set_reg(C6809* cpu, int reg, Word value)
+    {
+        switch (reg)
+        {
+            case 0:  cpu->setCC((Byte)value); break;
+            case 1:  cpu->setA((Byte)value);  break;
+            case 2:  cpu->setB((Byte)value);  break;
+            case 3:  cpu->setX(value);        break;
+            case 4:  cpu->setY(value);        break;
+            case 5:  cpu->setU(value);        break;
+            case 6:  cpu->setPC(value);       break;
+            case 7:  cpu->setS(value);        break;
+            default: cpu->setDP((Byte)value); break;
+        }
+    }
+
+    // "monitor" commands, for the kernel symbols gdb itself knows nothing of:
+    //      break <where>       set a breakpoint ($F000, KRNL_START or KRNL_START+3)
+    //      delete <where>      clear it
+    //      sym <where>         show the address and the symbol covering it
+    std::string monitor(Debug* debug, const std::string& command)
+    {
+        size_t split = command.find(' ');
+        std::string verb = command.substr(0, split);
+        std::string where = (split == std::string::npos) ? "" : command.substr(split + 1);
+        Word addr;
+        if (verb != "break" && verb != "delete" && verb != "sym") {
+            return "usage: monitor break|delete|sym <address or symbol>\n";
+        }
+        if (!debug->GetSymbols().Parse(where, addr)) { return "unknown address \"" + where + "\"\n"; }
+        if (verb != "sym") { debug->GetBreakpoints().Set(addr, verb == "break"); }
+        std::string name = debug->GetSymbols().Name(addr);
+        std::string text = (verb == "break") ? "breakpoint at $" : (verb == "delete") ? "deleted $" : "$";
+        text += clr::hex(addr, 4);
+        return text + (name.empty() ? "" : " <" + name + ">") + "\n";
+    }
+
+} // END: namespace
+
+
+std::string GdbStub::Frame(const std::string& body)
+{
+    Byte sum = 0;
+    for (char c : body) { sum += (Byte)c; }
+    return "$" + body + "#" + to_hex(sum, 2);
+} // END: GdbStub::Frame()
+
+
+
+/*******************
+* Packet Handling *
+*******************/
+
+
+bool GdbStub::Process(const std::string& packet, std::string& reply)
+{
+    C6809* cpu = Bus::GetC6809();
+    Debug* debug = Bus::GetDebug();
+    reply.clear();
+    if (packet.empty() || !cpu || !debug) { return true; }
+    // registers and memory are only written, and the registers only read
+    // live, while the CPU thread is held
+    bool halted = debug->IsStopped();
+
+    size_t pos = 1;
+    switch (packet[0])
+    {
+        case '?':
+            reply = _stop_reply();
+            return true;
+
+        case 'g':
+        {
+            C6809::CPU_STATE regs = read_regs(cpu, halted);
+            for (int r = 0; r < REG_COUNT; r++) { reply += to_hex(get_reg(regs, r), REG_SIZE[r] * 2); }
+            return true;
+        }
+
+        case 'G':
+        {
+            if (!halted || packet.size() != 1 + REG_BYTES * 2) { reply = "E01"; return true; }
+            for (int r = 0; r < REG_COUNT; r++)
+            {
+                std::string field = packet.substr(pos, REG_SIZE[r] * 2);
+                size_t p = 0;
+                set_reg(cpu, r, (Word)from_hex(field, p));
+                pos += REG_SIZE[r] * 2;
+            }
+            reply = "OK";
+            return true;
+        }
+
+        case 'p':
+        {
+            Uint32 reg = from_hex(packet, pos);
+            reply = (reg < REG_COUNT) ? to_hex(get_reg(read_regs(cpu, halted), reg), REG_SIZE[reg] * 2) : "E01";
+            return true;
+        }
+
+        case 'P':
+        {
+            Uint32 reg = from_hex(packet, pos);
+            if (!halted || reg >= REG_COUNT || pos >= packet.size() || packet[pos] != '=') { reply = "E01"; return true; }
+            pos++;
+            set_reg(cpu, reg, (Word)from_hex(packet, pos));
+            reply = "OK";
+            return true;
+        }
+
+        case 'm':
+        {
+            Uint32 addr = from_hex(packet, pos);
+            if (pos >= packet.size() || packet[pos++] != ',') { reply = "E01"; return true; }
+            Uint32 len = std::min<Uint32>(from_hex(packet, pos), 0x800);
+            for (Uint32 i = 0; i < len; i++) { reply += to_hex(Memory::Peek((Word)(addr + i)), 2); }
+            return true;
+        }
+
+        case 'M':
+        {
+            Uint32 addr = from_hex(packet, pos);
+            if (pos >= packet.size() || packet[pos++] != ',') { reply = "E01"; return true; }
+            Uint32 len = from_hex(packet, pos);
+            if (!halted || pos >= packet.size() || packet[pos++] != ':' || packet.size() - pos < len * 2) { reply = "E01"; return true; }
+            for (Uint32 i = 0; i < len; i++, pos += 2)
+            {
+                size_t p = 0;
+                Memory::Poke((Word)(addr + i), (Byte)from_hex(packet.substr(pos, 2), p));
+            }
+            reply = "OK";
+            return true;
+        }
+
+        case 'Z':
+        case 'z':
+        {
+            // Z<type>,<addr>,<kind>  (kind is the length for watchpoints)
+            bool insert = packet[0] == 'Z';
+            Uint32 type = from_hex(packet, pos);
+            if (pos >= packet.size() || packet[pos++] != ',') { reply = "E01"; return true; }
+            Word addr = (Word)from_hex(packet, pos);
+            Uint32 len = 1;
+            if (pos < packet.size() && packet[pos] == ',') { pos++; len = std::max<Uint32>(from_hex(packet, pos), 1); }
+            Word last = (Word)std::min<Uint32>(addr + len - 1, 0xFFFF);
+            Byte flags = 0;
+            switch (type)
+            {
+                case 0: case 1:
+                    debug->GetBreakpoints().Set(addr, insert);
+                    reply = "OK";
+                    return true;
+                case 2:  flags = Memory::WATCH_WRITE; break;
+                case 3:  flags = Memory::WATCH_READ; break;
+                case 4:  flags = Memory::WATCH_READ | Memory::WATCH_WRITE; break;
+                default: return true;           // unsupported: empty reply
+            }
+            insert ? debug->AddWatch(addr, last, flags) : debug->RemoveWatch(addr, last, flags);
+            reply = "OK";
+            return true;
+        }
+
+        case 'c':
+        case 's':
+            if (pos < packet.size())
+            {
+                if (!halted) { reply = "E01"; return true; }
+                cpu->setPC((Word)from_hex(packet, pos));
+            }
+            _resume(packet[0] == 's');
+            return false;
+
+        case 'D':
+            debug->Resume();
+            reply = "OK";
+            return true;
+
+        case 'H':
+            reply = "OK";
+            return true;
+
+        case 'q':
+            if (packet.rfind("qSupported", 0) == 0) { reply = "PacketSize=1000"; }
+            else if (packet == "qAttached") { reply = "1"; }
+            else if (packet == "qC") { reply = "QC1"; }
+            else if (packet == "qfThreadInfo") { reply = "m1"; }
+            else if (packet == "qsThreadInfo") { reply = "l"; }
+            else if (packet.rfind("qRcmd,", 0) == 0)
+            {
+                // hex encoded both ways; console output is the whole reply
+                std::string command;
+                for (pos = 6; pos + 1 < packet.size(); pos += 2) {
+                    size_t at = 0;
+                    command += (char)from_hex(packet.substr(pos, 2), at);
+                }
+                for (unsigned char c : monitor(debug, command)) { reply += to_hex(c, 2); }
+            }
+            return true;
+    }
+    return true;                                    // unsupported: empty reply
+} // END: GdbStub::Process()
+
+
+std::string GdbStub::_stop_reply()
+{
+    if (_interrupted) { return "S02"; }             // SIGINT
+    Debug::WATCH_HIT hit;
+    if (Bus::GetDebug()->LastWatchHit(hit) && hit.count != _watch_count)
+    {
+        const char* kind = (hit.kind == Memory::WATCH_READ) ? "rwatch" : "watch";
+        return "T05" + std::string(kind) + ":" + to_hex(hit.address, 4) + ";";
+    }
+    return "S05";                                   // SIGTRAP
+} // END: GdbStub::_stop_reply()
+
+
+void GdbStub::_resume(bool step)
+{
+    Debug* debug = Bus::GetDebug();
+    Debug::WATCH_HIT hit;
+    _watch_count = debug->LastWatchHit(hit) ? hit.count : 0;
+    _interrupted = false;
+    _running = true;
+    step ? debug->Step() : debug->Resume();
+} // END: GdbStub::_resume()
+
+
+
+/*************
+* Transport *
+*************/
+
+
+#if defined(_WIN32)
+
+bool GdbStub::Start(int port, const std::string& socket_path)
+{
+    (void)port; (void)socket_path;
+    std::cout << clr::indent() << clr::ORANGE << "The gdb stub is not available on this platform" << clr::RETURN;
+    return false;
+}
+void GdbStub::Stop() {}
+void GdbStub::_server_proc() {}
+void GdbStub::_serve(int fd) { (void)fd; }
+
+#else
+
+bool GdbStub::Start(int port, const std::string& socket_path)
+{
+    if (_active) { return true; }
+    _socket_path = socket_path;
+    bool bound = false;
+    if (!socket_path.empty())
+    {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(socket_path.c_str());
+        _listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bound = _listen_fd >= 0 && ::bind(_listen_fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    else
+    {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);     // never reachable from other hosts
+        int yes = 1;
+        _listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        bound = _listen_fd >= 0 &&
+                ::setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) == 0 &&
+                ::bind(_listen_fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    if (!bound || ::listen(_listen_fd, 1) < 0)
+    {
+        if (_listen_fd >= 0) { ::close(_listen_fd); _listen_fd = -1; }
+        std::cout << clr::indent() << clr::ORANGE << "Unable to start the gdb stub" << clr::RETURN;
+        return false;
+    }
+    _active = true;
+    _server = std::thread(&GdbStub::_server_proc, this);
+    std::cout << clr::indent() << clr::CYAN << "gdb stub listening on "
+              << (socket_path.empty() ? "localhost:" + std::to_string(port) : socket_path) << clr::RETURN;
+    return true;
+} // END: GdbStub::Start()
+
+
+void GdbStub::Stop()
+{
+    if (!_active) { return; }
+    _active = false;                                // the server thread checks this between polls
+    if (_server.joinable()) { _server.join(); }
+    ::close(_listen_fd);
+    _listen_fd = -1;
+    if (!_socket_path.empty()) { ::unlink(_socket_path.c_str()); }
+} // END: GdbStub::Stop()
+
+
+void GdbStub::_server_proc()
+{
+    while (_active)
+    {
+        pollfd p = { _listen_fd, POLLIN, 0 };
+        if (::poll(&p, 1, 100) <= 0) { continue; }
+        int fd = ::accept(_listen_fd, nullptr, nullptr);
+        if (fd < 0) { continue; }
+        _serve(fd);
+        ::close(fd);
+    }
+} // END: GdbStub::_server_proc()
+
+
+/**
+ * Serves one client until it detaches or disconnects. The CPU is halted
+ * on attach and resumed when the client goes away. While a 'c' or 's'
+ * is outstanding the stop reply is sent as soon as the debugger reports
+ * the CPU halted, whether by a breakpoint, a watchpoint, a finished
+ * step, the client's ^C or the debugger window.
+ */
+void GdbStub::_serve(int fd)
+{
+    Debug* debug = Bus::GetDebug();
+    auto send = [fd](const std::string& s) { return ::send(fd, s.data(), s.size(), MSG_NOSIGNAL) == (ssize_t)s.size(); };
+
+    debug->Break();
+    _running = false;
+    _interrupted = false;
+    std::string buffer;
+    bool attached = true;
+    while (_active && attached)
+    {
+        if (_running && debug->IsStopped())
+        {
+            _running = false;
+            if (!send(Frame(_stop_reply()))) { break; }
+        }
+
+        pollfd p = { fd, POLLIN, 0 };
+        int ready = ::poll(&p, 1, 10);
+        if (ready < 0) { break; }
+        if (ready == 0) { continue; }
+        char chunk[1024];
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) { break; }
+        buffer.append(chunk, n);
+
+        // consume every complete packet in the buffer
+        while (!buffer.empty())
+        {
+            if (buffer[0] == '\x03')                // ^C
+            {
+                buffer.erase(0, 1);
+                _interrupted = true;
+                debug->Break();
+                continue;
+            }
+            if (buffer[0] != '$') { buffer.erase(0, 1); continue; }     // acks and noise
+            size_t hash = buffer.find('#');
+            if (hash == std::string::npos || buffer.size() < hash + 3) { break; }
+            std::string body = buffer.substr(1, hash - 1);
+            buffer.erase(0, hash + 3);
+            send("+");
+            if (body.empty()) { continue; }
+            if (body[0] == 'k') { attached = false; break; }
+            std::string reply;
+            if (Process(body, reply) && !send(Frame(reply))) { attached = false; break; }
+            if (body[0] == 'D') { attached = false; break; }
+        }
+    }
+    debug->Resume();
+    _running = false;
+} // END: GdbStub::_serve()
+
+#endif // _WIN32
+
+
+// END: GdbStub.cpp
@@ -97,7 +97,8 @@ int  Keyboard::OnAttach(int nextAddr)
         [this](Word nextAddr) { (void)nextAddr; if (charQueueLen() > 0) { return charPopQueue(); } return (Byte)0;	 }, 
         nullptr, {   
             "(Byte) Read Next Character in Queue     (Popped When Read)"
-        }}); nextAddr+=1;   
+        },
+        [this](Word) { return (charQueueLen() > 0) ? charScanQueue() : (Byte)0; } }); nextAddr+=1;   
 
 
     ////////////////////////////////////////////////
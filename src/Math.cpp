@@ -84,7 +84,8 @@ int  Math::OnAttach(int nextAddr)
         [this](Word nextAddr, Byte data) { 
             _process_write_data(nextAddr, data, aca_string, aca_pos, aca_float, aca_raw, aca_int); 
         },
-        { "(Byte) ACA Float String Character Port"} });
+        { "(Byte) ACA Float String Character Port"},
+        [this](Word) { return _peek_data(aca_string, aca_pos); } });
     nextAddr++;
 
 
@@ -174,7 +175,8 @@ int  Math::OnAttach(int nextAddr)
         [this](Word nextAddr, Byte data) { 
             _process_write_data(nextAddr, data, acb_string, acb_pos, acb_float, acb_raw, acb_int);         
         },
-        { "(Byte) ACB Float String Character Port"} });
+        { "(Byte) ACB Float String Character Port"},
+        [this](Word) { return _peek_data(acb_string, acb_pos); } });
     nextAddr++;
 
 
@@ -262,7 +264,8 @@ int  Math::OnAttach(int nextAddr)
         [this](Word nextAddr, Byte data) { 
             _process_write_data(nextAddr, data, acr_string, acr_pos, acr_float, acr_raw, acr_int);         
         },
-        { "(Byte) ACR Float String Character Port"} });
+        { "(Byte) ACR Float String Character Port"},
+        [this](Word) { return _peek_data(acr_string, acr_pos); } });
     nextAddr++;
 
 
@@ -23,6 +23,7 @@
 
 
 #include "Bus.hpp"
+#include "Debug.hpp"
 #include "clr.hpp"
 #include "Memory.hpp"
 
@@ -145,6 +146,55 @@ Byte Memory::Read(Word address, bool debug)
     // debug mode just returns raw data
     if (debug) { return memory(address); }
 
+    Byte flags = _watch[address].load(std::memory_order_relaxed);
+    if (flags) { return _read_watched(address, flags); }
+
+    return _read_device(address);
+}
+
+
+
+
+void Memory::Write(Word address, Byte data, bool debug)
+{
+    // debug mode just writes the raw data
+    if (debug) { memory(address, data); return; }
+
+    Byte flags = _watch[address].load(std::memory_order_relaxed);
+    if (flags) { _write_watched(address, data, flags); return; }
+
+    _write_device(address, data);
+}
+
+
+Byte Memory::Peek(Word address)
+{
+    auto itr = _device_map.find(address);
+    if (itr != _device_map.end())
+    {
+        if (itr->second.peek != nullptr) { return itr->second.peek(address); }
+        if (itr->second.read != nullptr) { return itr->second.read(address); }
+    }
+    return memory(address);
+}
+
+void Memory::Poke(Word address, Byte data)
+{
+    auto itr = _device_map.find(address);
+    if (itr != _device_map.end())
+    {
+        if (itr->second.write != nullptr) { itr->second.write(address, data); }
+        return;
+    }
+    memory(address, data);
+}
+
+
+/**
+ * The device dispatch shared by Read()/Write() and the watched paths.
+ */
+Byte Memory::_read_device(Word address)
+{
     // find the device that is responsible for this address
     auto itr = _device_map.find(address);
     // device was found?
@@ -159,14 +209,8 @@ Byte Memory::Read(Word address, bool debug)
     return memory(address);  
 }
 
-
-
-
-void Memory::Write(Word address, Byte data, bool debug)
+void Memory::_write_device(Word address, Byte data)
 {
-    // debug mode just writes the raw data
-    if (debug) { memory(address, data); return; }
-
     // find the device that is responsible for this address
     auto itr = _device_map.find(address);
     // device was found?
@@ -190,14 +234,46 @@ void Memory::Write(Word address, Byte data, bool debug)
     }
     // write to the fallback memory (for debug)
     memory(address, data);
-    return;
+}
+
+
+/**
+ * The watched access paths. The access itself goes straight to the
+ * device dispatch, leaving the shared flag table untouched, then the hit
+ * is reported to the debugger, which stops the CPU once the current
+ * instruction completes. Value changes compare the stored (backing)
+ * byte before and after.
+ */
+Byte Memory::_read_watched(Word address, Byte flags)
+{
+    Byte data = _read_device(address);
+    if ((flags & WATCH_READ) && Bus::GetDebug()) {
+        Bus::GetDebug()->WatchHit(address, WATCH_READ, data, data);
+    }
+    return data;
+}
+
+void Memory::_write_watched(Word address, Byte data, Byte flags)
+{
+    Byte old_data = memory(address);
+    _write_device(address, data);
+    Debug* debug = Bus::GetDebug();
+    if (!debug) { return; }
+    if (flags & WATCH_WRITE) {
+        debug->WatchHit(address, WATCH_WRITE, old_data, data);
+    } else if ((flags & WATCH_CHANGE) && memory(address) != old_data) {
+        debug->WatchHit(address, WATCH_CHANGE, old_data, memory(address));
+    }
 }
 
 
 Word Memory::Read_Word(Word address, bool debug)
 {
 
-    Word ret = (Memory::Read(address, debug) << 8) | Memory::Read(address + 1, debug);
+    // the MSB is read first, as on the 6809 bus (some ports latch on it)
+    Byte msb = Memory::Read(address, debug);
+    Byte lsb = Memory::Read(address + 1, debug);
+    Word ret = (msb << 8) | lsb;
     return ret;
 }
 
@@ -61,11 +61,11 @@ int  Mouse::OnAttach(int nextAddr)
     /////
     mapped_register.push_back( { "CSR_XPOS", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_x >> 8; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_x = (mouse_x & 0x00ff) | (data << 8); }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_x = (mouse_x & 0x00ff) | (data << 8); }, 
         { "(Word) Horizontal Mouse Cursor Coordinate" }}); nextAddr+=1;
     mapped_register.push_back( { "", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_x & 0xFF; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_x = (mouse_x & 0xff00) | (data << 0); }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_x = (mouse_x & 0xff00) | (data << 0); }, 
         {{""}}}); nextAddr+=1;    
 
 
@@ -75,11 +75,11 @@ int  Mouse::OnAttach(int nextAddr)
     /////
     mapped_register.push_back( { "CSR_YPOS", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_y >> 8; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_y = (mouse_y & 0x00ff) | (data << 8); }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_y = (mouse_y & 0x00ff) | (data << 8); }, 
         {"(Word) Vertical Mouse Cursor Coordinate"}}); nextAddr+=1;
     mapped_register.push_back( { "", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_y & 0xFF; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_y = (mouse_y & 0xff00) | (data << 0); }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_y = (mouse_y & 0xff00) | (data << 0); }, 
         {""}}); nextAddr+=1;    
 
 
@@ -89,7 +89,7 @@ int  Mouse::OnAttach(int nextAddr)
     /////
     mapped_register.push_back( { "CSR_XOFS", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_x_offset; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_x_offset = data; }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_x_offset = data; }, 
         { "(Byte) Horizontal Mouse Cursor Offset" }}); nextAddr+=1;
 
 
@@ -99,7 +99,7 @@ int  Mouse::OnAttach(int nextAddr)
     /////
     mapped_register.push_back( { "CSR_YOFS", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return mouse_y_offset; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; _bCsrIsDirty = true; mouse_y_offset = data; }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; mouse_y_offset = data; }, 
         { "(Byte) Vertical Mouse Cursor Offset" }}); nextAddr+=1;
 
 
@@ -148,7 +148,7 @@ int  Mouse::OnAttach(int nextAddr)
     /////
     mapped_register.push_back( { "CSR_BMP_DATA", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return csr_data[bmp_offset]; }, 
-        [this](Word nextAddr, Byte data) { (void)nextAddr; csr_data[bmp_offset] = data; }, 
+        [this](Word nextAddr, Byte data) { (void)nextAddr; csr_data[bmp_offset] = data; _bCsrIsDirty = true; }, 
         { "(Byte) Mouse Cursor Bitmap Pixel Color Data ($0-$F)" }}); nextAddr+=1;
 
 
@@ -171,12 +171,14 @@ int  Mouse::OnAttach(int nextAddr)
         [this](Word nextAddr, Byte data) { 
             (void)nextAddr; 
             _csr_palette[m_palette_index].color = (_csr_palette[m_palette_index].color & 0x00FF) | (data << 8); 
+            _bCsrIsDirty = true;
         }, { "(Word) Mouse Cursor Color Palette Data A4R4G4B4" }}); nextAddr+=1;
     mapped_register.push_back( { "", nextAddr,
         [this](Word nextAddr) { (void)nextAddr; return(_csr_palette[m_palette_index].color) & 0xFF; }, 
         [this](Word nextAddr, Byte data) { 
             (void)nextAddr; 
             _csr_palette[m_palette_index].color = (_csr_palette[m_palette_index].color & 0xFF00) | (data << 0); 
+            _bCsrIsDirty = true;
         }, {""}}); nextAddr+=1;    
 
 
@@ -225,6 +227,17 @@ void Mouse::OnInit()
         _csr_palette.push_back(clr);
     }
 
+    // the cursor is drawn over the composed display as its own small texture
+    if (gpu->GetRenderer())
+    {
+        _cursor_texture = SDL_CreateTexture(gpu->GetRenderer(), 
+                SDL_PIXELFORMAT_ARGB4444, 
+                SDL_TEXTUREACCESS_STREAMING, 16, 16);
+        SDL_SetTextureScaleMode(_cursor_texture, SDL_SCALEMODE_NEAREST);
+        SDL_SetTextureBlendMode(_cursor_texture, SDL_BLENDMODE_BLEND);
+    }
+    _bCsrIsDirty = true;
+
     std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnInit() Exit" << clr::RETURN;
 }
 
@@ -233,6 +246,10 @@ void Mouse::OnInit()
 void Mouse::OnQuit()
 {
     std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnQuit() Entry" << clr::RETURN;
+    if (_cursor_texture) {
+        SDL_DestroyTexture(_cursor_texture);
+        _cursor_texture = nullptr;
+    }
     std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnQuit() Exit" << clr::RETURN;
 }
 
@@ -363,8 +380,6 @@ void Mouse::OnUpdate(float fElapsedTime)
     // GPU *gpu = Bus::GetGPU();
     // gpu->ClearMainTexture();
 
-    _display_SDL_cursor();
-
 
     //std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnUpdate() Exit" << clr::RETURN;
 }
@@ -374,7 +389,8 @@ void Mouse::OnRender()
 {
     //std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnRender() Entry" << clr::RETURN;
 
-    // renders to the standard display texture
+    // drawn over the composed display (not into the foreground layer)
+    _display_SDL_cursor();
 
     //std::cout << clr::indent() << clr::LT_BLUE << "Mouse::OnRender() Exit" << clr::RETURN;
 }
@@ -394,47 +410,22 @@ void Mouse::_show_SDL_cursor(bool b)
 
 void Mouse::_display_SDL_cursor()
 {
-    GPU* gpu = Bus::GetGPU();
-    void *pixels;
-    int pitch;
-    if (!SDL_LockTexture(gpu->GetTexture(), NULL, &pixels, &pitch)) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't lock texture: %s\n", SDL_GetError());
-        // Bus::Error("");
-
-            // std::cout << clr::indent_pop() << clr::ORANGE << "Bus::_onInit() Error" << clr::RETURN;
-        Bus::Error(SDL_GetError(), __FILE__, __LINE__);
-    }
-    else
+    if (_cursor_texture == nullptr || (button_flags & 0x80) == 0) { return; }
+
+    // rebuild the cursor image only after CSR_BMP_DATA or CSR_PAL_DATA change
+    if (_bCsrIsDirty)
     {
-        // static bool b_wasCleared = false;
-        // if (b_wasCleared == false)
-        // {
-        //     start with a clear texture (pixel streaming version)
-        //     for (int ty=0; ty < Memory::Read_Word(MAP(GPU_VRES)); ty++)
-        //         for (int tx=0; tx < Memory::Read_Word(MAP(GPU_HRES)); tx++)
-        //             _setPixel_cursor(pixels, pitch, tx, ty, 255);    
-        //     b_wasCleared = true;
-        // }
-        if (button_flags & 0x80)
-        {
-            // b_wasCleared = false;
-            
-            // render the cursor
-            int x = mouse_x + mouse_x_offset;
-            int y = mouse_y + mouse_y_offset;   
-
-            int id = 0;
-            for (int v=0; v<16; v++)
-            {
-                for (int h=0; h<16; h++)
-                {
-                    Byte c = csr_data[id++];
-                    _setPixel_cursor(pixels, pitch, h+x, v+y, c);
-                }
-            }
+        Uint16 image[16*16];
+        for (int i = 0; i < 16*16; i++) {
+            image[i] = _csr_palette[csr_data[i]].color;     // 0xARGB
         }
-        SDL_UnlockTexture(gpu->GetTexture()); 
-    }   
+        SDL_UpdateTexture(_cursor_texture, NULL, image, 16 * sizeof(Uint16));
+        _bCsrIsDirty = false;
+    }
+
+    GPU* gpu = Bus::GetGPU();
+    SDL_FRect dst{ (float)(mouse_x + mouse_x_offset), (float)(mouse_y + mouse_y_offset), 16.0f, 16.0f };
+    SDL_RenderTexture(gpu->GetRenderer(), _cursor_texture, NULL, &dst);
 }
 
 void Mouse::_render_csr_buffer()
@@ -460,61 +451,6 @@ void Mouse::_render_csr_buffer()
     }
 }
 
-void Mouse::_setPixel_cursor(void* pixels, int pitch, int x, int y, Byte color_index)
-{
-    // strict bounds checking
-    if (x<0 || y<0)         return;
-    if (x >= Memory::Read_Word(MAP(GPU_HRES)) )  return;
-    if (y >= Memory::Read_Word(MAP(GPU_VRES)) ) return;
-
-    Uint16 *dst = (Uint16*)((Uint8*)pixels + (y * pitch) + (x*sizeof(Uint16)));
-    Uint16 pixel = *dst;	// 0xARGB
-
-    constexpr bool use_alpha = true;    // testing:  this flag does work as expected.
-                                        //      Update the _setPixel_unlocked() method in Gfx.
-
-    if (use_alpha)
-    {
-        Byte r1 = (pixel & 0x0f00) >> 8;
-        Byte g1 = (pixel & 0x00f0) >> 4;
-        Byte b1 = (pixel & 0x000f) >> 0;
-        
-        Byte a2 = this->alf(color_index);
-        Byte r2 = this->red(color_index);
-        Byte g2 = this->grn(color_index);
-        Byte b2 = this->blu(color_index);
-
-        Byte r = (((r1 * (16-a2))) + (r2 * (a2+1))) >> 4;
-        Byte g = (((g1 * (16-a2))) + (g2 * (a2+1))) >> 4;
-        Byte b = (((b1 * (16-a2))) + (b2 * (a2+1))) >> 4;
-
-        // if (color_index == 255)
-        // {
-        //     *dst = 0x00000000;
-        // }
-        // else 
-        if (alf(color_index) != 0)
-        {
-            *dst = (
-                (a2<<12) | 
-                (r<<8) | 
-                (g<<4) | 
-                (b)
-            );          
-        }	
-    }
-    else
-    {
-        *dst = 
-        (
-            0xF000 |                    // full alpha, no color mixing
-            (red(color_index)<<8) |
-            (grn(color_index)<<4) |
-            blu(color_index)
-        );    
-       
-    }}
-
 
 
 // END: Mouse.cpp
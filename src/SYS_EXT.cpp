@@ -0,0 +1,431 @@
+/*** SYS_EXT.cpp *******************************************
+ *     _______     _______     ________   _________
+ *    / ____\ \   / / ____|   |  ____\ \ / /__   __|
+ *   | (___  \ \_/ / (___     | |__   \ V /   | |        ___ _ __  _ __
+ *    \___ \  \   / \___ \    |  __|   > <    | |       / __| '_ \| '_ \
+ *    ____) |  | |  ____) |   | |____ / . \   | |   _  | (__| |_) | |_) |
+ *   |_____/   |_| |_____/    |______/_/ \_\  |_|  (_)  \___| .__/| .__/
+ *                        ______                            | |   | |
+ *                       |______|                           |_|   |_|
+ *
+ * Extended System Registers. Frame pacing and frame time statistics
+ * for the host side main loop.
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+#include <thread>
+
+#include "Bus.hpp"
+#include "GPU.hpp"
+#include "SYS_EXT.hpp"
+#include "Memory.hpp"
+
+
+/***************************
+* Constructor / Destructor *
+***************************/
+
+SYS_EXT::SYS_EXT()
+{
+    std::cout << clr::indent_push() << clr::CYAN << "SYS_EXT Created" << clr::RETURN;
+    _device_name = "SYS_EXT_DEVICE";
+} // END: SYS_EXT()
+
+SYS_EXT::~SYS_EXT()
+{
+    std::cout << clr::indent_pop() << clr::CYAN << "SYS_EXT Destroyed" << clr::RETURN;
+} // END: ~SYS_EXT()
+
+
+
+/******************
+* Virtual Methods *
+******************/
+
+
+int  SYS_EXT::OnAttach(int nextAddr)
+{
+    SetBaseAddress(nextAddr);
+    Word old_address=nextAddr;
+    this->heading = "Extended System Hardware Registers";
+
+
+    ////////////////////////////////////////////////
+    // (Byte) SYS_PACE_CTRL
+    //      Frame Pacing Control / Status
+    /////
+    mapped_register.push_back({ "SYS_PACE_CTRL", nextAddr,
+        [this](Word) {
+            GPU* gpu = Bus::GetGPU();
+            return (Byte)(_pace_ctrl | ((gpu && gpu->IsVsync()) ? PACE_VSYNC : 0));
+        },
+        [this](Word, Byte data) {
+            if (data & PACE_RESET) {
+                _hist.fill(0);
+            }
+            _pace_ctrl = data & PACE_ENABLE;
+            _pacing = false;        // restart from a fresh deadline
+        },
+        {
+            "(Byte) Frame Pacing Control / Status",
+            "- bit  7   = Pace Frames to 70 Hz",
+            "              (0: run as fast as possible)",
+            "- bit  6   = Presentation Waits for VSYNC",
+            "              (GPU_MODE VSync, Read Only)",
+            "- bits 1-5 = (reserved)",
+            "- bit  0   = Clear Frame Time Histogram",
+            "              (write 1)",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) SYS_FRAME_TIME
+    //      Last Host Frame Time (Read Only)
+    /////
+    mapped_register.push_back({ "SYS_FRAME_TIME", nextAddr,
+        [this](Word) { return (_frame_time >> 8) & 0xFF; },
+        nullptr,
+        {
+            "(Word) Last Host Frame Time (Read Only)",
+            "  Note: In 1/100 milliseconds. A paced",
+            "       frame is 1428 (14.28 ms).",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _frame_time & 0xFF; },
+        nullptr, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) SYS_FRAME_HIST_SEL
+    //      Frame Time Histogram Bucket Select
+    /////
+    mapped_register.push_back({ "SYS_FRAME_HIST_SEL", nextAddr,
+        [this](Word) { return _hist_sel; },
+        [this](Word, Byte data) { _hist_sel = data % HIST_BUCKETS; },
+        {
+            "(Byte) Frame Time Histogram Bucket (0-15)",
+            "  Note: Bucket N counts frames that took",
+            "       N*2 to N*2+2 ms. Bucket 15 also counts",
+            "       every longer frame.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) SYS_FRAME_HIST
+    //      Frame Time Histogram Count (Read Only)
+    /////
+    mapped_register.push_back({ "SYS_FRAME_HIST", nextAddr,
+        [this](Word) { return (_hist[_hist_sel] >> 8) & 0xFF; },
+        nullptr,
+        {
+            "(Word) Frames in the Selected Bucket (Read Only)",
+            "  Note: Counts stop at $FFFF.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _hist[_hist_sel] & 0xFF; },
+        nullptr, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Word) SYS_RENDER_TIME
+    //      Average Composed Frame Cost (Read Only)
+    /////
+    mapped_register.push_back({ "SYS_RENDER_TIME", nextAddr,
+        [this](Word) { return (_render_time >> 8) & 0xFF; },
+        nullptr,
+        {
+            "(Word) Average Composed Frame Cost (Read Only)",
+            "  Note: In 1/100 milliseconds. Covers the",
+            "       device updates and rendering of the",
+            "       frames that are not skipped.",
+            ""
+        }
+    }); nextAddr+=1;
+    mapped_register.push_back( { "", nextAddr,
+        [this](Word) { return _render_time & 0xFF; },
+        nullptr, {""}}); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) SYS_SKIP_LEVEL
+    //      Current Frame Skip Level (Read Only)
+    /////
+    mapped_register.push_back({ "SYS_SKIP_LEVEL", nextAddr,
+        [this](Word) { return _skip_level; },
+        nullptr,
+        {
+            "(Byte) Current Frame Skip Level (Read Only)",
+            "  Note: N skipped frames follow each composed",
+            "       frame. Input, device updates and the",
+            "       vertical blank continue every frame.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Byte) SYS_SKIP_MAX
+    //      Frame Skip Level Limit
+    /////
+    mapped_register.push_back({ "SYS_SKIP_MAX", nextAddr,
+        [this](Word) { return _skip_max; },
+        [this](Word, Byte data) { 
+            _skip_max = std::min<Byte>(data, SKIP_LIMIT); 
+            _skip_level = std::min(_skip_level, _skip_max);
+        },
+        {
+            "(Byte) Frame Skip Level Limit (0-7)",
+            "  Note: 0 composes every frame.",
+            ""
+        }
+    }); nextAddr+=1;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) SYS_EXT_END
+    //      End of Extended System Register Space
+    /////
+    nextAddr--;
+    mapped_register.push_back({ "SYS_EXT_END", nextAddr,
+        nullptr, nullptr,  { "End of Extended System Register Space"} });
+    nextAddr++;
+
+
+    ////////////////////////////////////////////////
+    // (Constant) SYS_EXT_TOP
+    //      Top of Extended System Register Space
+    //      (start of the next device)
+    /////
+    mapped_register.push_back({ "SYS_EXT_TOP", nextAddr,
+    nullptr, nullptr,  { "Top of Extended System Register Space", "---"}});
+
+    _size = nextAddr - old_address;
+    return _size;
+} // END: SYS_EXT::OnAttach()
+
+
+bool SYS_EXT::OnTest()
+{
+    bool test_results = true;
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Frame Pacing" + clr::RESET);
+
+    std::array<Word, HIST_BUCKETS> saved = _hist;
+    Word saved_time = _frame_time;
+    Byte saved_ctrl = _pace_ctrl;
+
+    // a paced frame, a long frame and a 4 ms frame
+    Memory::Write(MAP(SYS_PACE_CTRL), (Byte)(PACE_ENABLE | PACE_RESET));
+    _record_frame(std::chrono::microseconds(14286));
+    _record_frame(std::chrono::milliseconds(250));
+    _record_frame(std::chrono::microseconds(4500));
+    Memory::Write(MAP(SYS_FRAME_HIST_SEL), (Byte)7);
+    Word paced = Memory::Read_Word(MAP(SYS_FRAME_HIST));
+    Memory::Write(MAP(SYS_FRAME_HIST_SEL), (Byte)(HIST_BUCKETS - 1));
+    Word slow = Memory::Read_Word(MAP(SYS_FRAME_HIST));
+    Memory::Write(MAP(SYS_FRAME_HIST_SEL), (Byte)2);
+    Word fast = Memory::Read_Word(MAP(SYS_FRAME_HIST));
+    if (!ASSERT_TRUE(paced == 1 && slow == 1 && fast == 1 && Memory::Read_Word(MAP(SYS_FRAME_TIME)) == 450)) {
+        UnitTest::Log(this, clr::RED + "frame times were not recorded in the expected buckets");
+        test_results = false;
+    }
+    Memory::Write(MAP(SYS_PACE_CTRL), (Byte)(PACE_ENABLE | PACE_RESET));
+    if (!ASSERT_TRUE(Memory::Read_Word(MAP(SYS_FRAME_HIST)) == 0 &&
+                     (Memory::Read(MAP(SYS_PACE_CTRL)) & ~PACE_VSYNC) == PACE_ENABLE)) {
+        UnitTest::Log(this, clr::RED + "histogram reset failed");
+        test_results = false;
+    }
+
+    // three paced frames take at least two frame periods
+    GPU* gpu = Bus::GetGPU();
+    if (!(gpu && gpu->IsVsync()))
+    {
+        auto start = clock::now();
+        PaceFrame();
+        PaceFrame();
+        PaceFrame();
+        auto elapsed = clock::now() - start;
+        if (!ASSERT_TRUE(elapsed >= 2 * std::chrono::nanoseconds(1'000'000'000 / FRAME_HZ) - std::chrono::microseconds(500))) {
+            UnitTest::Log(this, clr::RED + "frames were not paced to 70 Hz");
+            test_results = false;
+        }
+    }
+
+    // expensive frames raise the skip level up to SYS_SKIP_MAX, cheap
+    // frames lower it again; a skipped frame follows each composed one
+    UnitTest::TestInit(this, "Testing " + clr::YELLOW + "Adaptive Frame Skip" + clr::RESET);
+    Byte saved_max = _skip_max;
+    Memory::Write(MAP(SYS_SKIP_MAX), (Byte)1);
+    for (int i = 0; i < SKIP_WINDOW * 3; i++) {
+        _record_render(std::chrono::milliseconds(20));
+    }
+    bool raised = Memory::Read(MAP(SYS_SKIP_LEVEL)) == 1 && Memory::Read_Word(MAP(SYS_RENDER_TIME)) == 2000;
+    BeginFrame();
+    bool first = IsSkipping();
+    BeginFrame();
+    bool second = IsSkipping();
+    for (int i = 0; i < SKIP_WINDOW; i++) {
+        _record_render(std::chrono::milliseconds(2));
+    }
+    bool lowered = Memory::Read(MAP(SYS_SKIP_LEVEL)) == 0;
+    // a cost just above one period settles at one skipped frame
+    Memory::Write(MAP(SYS_SKIP_MAX), (Byte)3);
+    for (int i = 0; i < SKIP_WINDOW * 6; i++) {
+        _record_render(std::chrono::microseconds(1'000'000 / FRAME_HZ + 1000));
+    }
+    bool settled = Memory::Read(MAP(SYS_SKIP_LEVEL)) == 1;
+    if (!ASSERT_TRUE(raised && first != second && lowered && settled)) {
+        UnitTest::Log(this, clr::RED + "frame skip level did not follow the render cost");
+        test_results = false;
+    }
+    _skip_max = saved_max;
+    _skip_level = 0;
+    _skip_count = 0;
+    _skipping = false;
+    _render_time = 0;
+
+    _hist = saved;
+    _frame_time = saved_time;
+    _pace_ctrl = saved_ctrl;
+    _hist_sel = 0;
+    _pacing = false;
+    _last_frame = clock::time_point();
+
+    if (test_results)
+        UnitTest::Log(this, "Unit Tests PASSED");
+    else
+        UnitTest::Log(this, clr::RED + "Unit Tests FAILED");
+    return test_results;
+} // END: SYS_EXT::OnTest()
+
+
+
+/****************
+* Frame Pacing *
+****************/
+
+
+/**
+ * Waits until the current frame's deadline. Most of the wait is spent
+ * asleep; the last stretch spins, because a sleep can overshoot by a
+ * scheduler tick. When the GPU presents with VSYNC the present call has
+ * already waited for the display, so only the frame time is recorded.
+ * A frame that runs more than a whole period late restarts the deadline
+ * rather than rushing to catch up.
+ */
+void SYS_EXT::PaceFrame()
+{
+    const clock::duration period = std::chrono::nanoseconds(1'000'000'000 / FRAME_HZ);
+    const clock::duration spin = std::chrono::microseconds(2000);
+
+    GPU* gpu = Bus::GetGPU();
+    bool vsync = gpu && gpu->IsVsync();
+    clock::time_point now = clock::now();
+
+    if (!(_pace_ctrl & PACE_ENABLE))
+    {
+        SDL_Delay(1);
+        now = clock::now();
+    }
+    else if (!vsync)
+    {
+        if (!_pacing) {
+            _deadline = now + period;
+            _pacing = true;
+        }
+        if (_deadline - now > spin) {
+            std::this_thread::sleep_for(_deadline - now - spin);
+        }
+        while ((now = clock::now()) < _deadline) {
+            std::this_thread::yield();
+        }
+        _deadline += period;
+        if (now > _deadline) {
+            _deadline = now + period;
+        }
+    }
+
+    if (_last_frame != clock::time_point()) {
+        _record_frame(now - _last_frame);
+    }
+    _last_frame = now;
+} // END: SYS_EXT::PaceFrame()
+
+
+
+/**
+ * Composes one frame, then skips _skip_level frames. A skipped frame
+ * still updates the devices and dispatches events; only the GPU layer
+ * composition, rendering and presentation are left out.
+ */
+void SYS_EXT::BeginFrame()
+{
+    _frame_start = clock::now();
+    if (_skip_count < _skip_level) {
+        _skipping = true;
+        _skip_count++;
+    } else {
+        _skipping = false;
+        _skip_count = 0;
+    }
+} // END: SYS_EXT::BeginFrame()
+
+
+void SYS_EXT::EndRender()
+{
+    if (!_skipping) {
+        _record_render(clock::now() - _frame_start);
+    }
+} // END: SYS_EXT::EndRender()
+
+
+/**
+ * Averages the cost of the composed frames over about SKIP_WINDOW frames
+ * and moves the skip level one step. A composed frame may use the
+ * periods of the frames skipped after it, so the level goes up when it
+ * uses most of its _skip_level + 1 periods, and down once it would fit
+ * comfortably in one period fewer. The gap between the two thresholds
+ * keeps the level from flickering.
+ */
+void SYS_EXT::_record_render(clock::duration cost)
+{
+    const long long budget = 1'000'000 / FRAME_HZ;         // microseconds
+    _render_acc += std::chrono::duration_cast<std::chrono::microseconds>(cost).count();
+    _render_frames++;
+    if (_render_frames * (_skip_level + 1) < SKIP_WINDOW) { return; }
+
+    long long average = _render_acc / _render_frames;
+    _render_time = (Word)std::min<long long>(average / 10, 0xFFFF);
+    if (average > budget * (_skip_level + 1) * 9 / 10 && _skip_level < _skip_max) {
+        _skip_level++;
+    } else if (average < budget * _skip_level * 6 / 10 && _skip_level > 0) {
+        _skip_level--;
+    }
+    _render_acc = 0;
+    _render_frames = 0;
+} // END: SYS_EXT::_record_render()
+
+
+void SYS_EXT::_record_frame(clock::duration frame)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(frame).count();
+    _frame_time = (Word)std::min<long long>(us / 10, 0xFFFF);
+    int bucket = std::min<long long>(us / (HIST_MS * 1000), HIST_BUCKETS - 1);
+    if (_hist[bucket] < 0xFFFF) {
+        _hist[bucket]++;
+    }
+} // END: SYS_EXT::_record_frame()
+
+
+// END: SYS_EXT.cpp
@@ -0,0 +1,247 @@
+/*** Symbols.cpp ****************************
+ *     _____                 _           _
+ *    / ____|               | |         | |
+ *   | (___  _   _ _ __ ___ | |__   ___ | |___    ___ _ __  _ __
+ *    \___ \| | | | '_ ` _ \| '_ \ / _ \| / __|  / __| '_ \| '_ \
+ *    ____) | |_| | | | | | | |_) | (_) | \__ \_| (__| |_) | |_) |
+ *   |_____/ \__, |_| |_| |_|_.__/ \___/|_|___(_)\___| .__/| .__/
+ *            __/ |                                  | |   | |
+ *           |___/                                   |_|   |_|
+ *
+ * Released under the GPL v3.0 License.
+ * Original Author: Jay Faries (warte67)
+ *
+ ************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include "Symbols.hpp"
+
+
+namespace {
+
+    // "$hex", "0xhex" or decimal; false if not a number or out of range
+    bool parse_number(const std::string& text, Word& value)
+    {
+        size_t pos = 0;
+        int base = 10;
+        if (text.compare(0, 1, "$") == 0) { base = 16; pos = 1; }
+        else if (text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0) { base = 16; pos = 2; }
+        if (pos >= text.size() || text.size() - pos > 5) { return false; }
+        for (size_t i = pos; i < text.size(); i++) {
+            if (base == 16 ? !std::isxdigit((unsigned char)text[i]) : !std::isdigit((unsigned char)text[i])) { return false; }
+        }
+        unsigned long v = std::stoul(text.substr(pos), nullptr, base);
+        if (v > 0xFFFF) { return false; }
+        value = (Word)v;
+        return true;
+    }
+
+    bool is_name_start(char c) { return std::isalpha((unsigned char)c) || c == '_' || c == '.'; }
+
+    bool is_equate(std::string word)
+    {
+        for (auto& c : word) { c = (char)std::tolower((unsigned char)c); }
+        return word == "equ" || word == "set" || word == "=";
+    }
+
+} // END: namespace
+
+
+/**
+ * Reads "name equ value" lines. Only names that LoadListing() or
+ * LoadMap() have not already classified are added, as labels.
+ */
+bool Symbols::LoadSym(const std::string& filename)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open()) { return false; }
+    std::string line;
+    while (std::getline(fin, line))
+    {
+        std::istringstream ss(line);
+        std::string name, op, text;
+        if (!(ss >> name >> op >> text) || !is_name_start(name[0]) || !is_equate(op)) { continue; }
+        Word value;
+        if (!parse_number(text, value) || _by_name.count(name)) { continue; }
+        _add(name, value, SYM_LABEL);
+    }
+    _sort();
+    return true;
+} // END: Symbols::LoadSym()
+
+
+/**
+ * Reads an asm6809 listing. Each line starts with the address (or the
+ * equated value), then the object bytes, with the label field at column
+ * 22 and the statement at column 38:
+ *
+ *      F000  7EF1E2          KRNL_START      jmp     KRNL_BEGIN
+ *      FE11                  GPU_VRES              equ    $FE11
+ *
+ * Long fcc/fcn data pushes the label right, one space past the bytes.
+ * The label field is then still padded to 16 columns while a bare
+ * mnemonic is padded to 8, which is how the two are told apart.
+ */
+bool Symbols::LoadListing(const std::string& filename)
+{
+    constexpr size_t LABEL_COLUMN = 22;
+    std::ifstream fin(filename);
+    if (!fin.is_open()) { return false; }
+    std::string line;
+    while (std::getline(fin, line))
+    {
+        if (line.size() <= LABEL_COLUMN || line[4] != ' ') { continue; }
+        Word value;
+        if (!parse_number("$" + line.substr(0, 4), value)) { continue; }
+
+        size_t bytes_end = 6;
+        while (bytes_end < line.size() && std::isxdigit((unsigned char)line[bytes_end])) { bytes_end++; }
+        size_t start = std::max(bytes_end + 1, LABEL_COLUMN);
+        if (start >= line.size() || !is_name_start(line[start]) || line[start - 1] != ' ') { continue; }
+        size_t end = line.find_first_of(" \t", start);
+        if (end == std::string::npos) { end = line.size(); }
+        size_t next = line.find_first_not_of(" \t", end);
+        if (next == std::string::npos) { continue; }       // a lone mnemonic (rts) or a label with no address
+        if (start > LABEL_COLUMN && next - start == 8) { continue; }
+
+        std::string name = line.substr(start, end - start);
+        std::string op = line.substr(next, line.find_first_of(" \t", next) - next);
+        if (is_equate(op))
+        {
+            auto it = _by_name.find(name);
+            if (it != _by_name.end() && it->second.kind == SYM_ADDRESS) { continue; }
+            _add(name, value, SYM_CONST);
+        }
+        else
+        {
+            _add(name, value, SYM_LABEL);
+        }
+    }
+    _sort();
+    return true;
+} // END: Symbols::LoadListing()
+
+
+/**
+ * Reads the generated Memory_Map.asm. The devices are written in address
+ * order, so an equate below the running address is one of the enumerations
+ * listed with a device (FE_EOF, MMU_CMD_...) rather than a register.
+ */
+bool Symbols::LoadMap(const std::string& filename)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open()) { return false; }
+    std::string line;
+    Word last_address = 0;
+    while (std::getline(fin, line))
+    {
+        std::istringstream ss(line);
+        std::string name, op, text;
+        if (line.empty() || !is_name_start(line[0]) || !(ss >> name >> op >> text) || !is_equate(op)) { continue; }
+        Word value;
+        if (!parse_number(text, value)) { continue; }
+        if (value < last_address) {
+            _add(name, value, SYM_CONST);
+        } else {
+            _add(name, value, SYM_ADDRESS);
+            last_address = value;
+        }
+    }
+    _sort();
+    return true;
+} // END: Symbols::LoadMap()
+
+
+void Symbols::Add(const std::string& name, Word value, KIND kind)
+{
+    _add(name, value, kind);
+    _sort();
+} // END: Symbols::Add()
+
+
+void Symbols::Clear()
+{
+    _by_address.clear();
+    _by_name.clear();
+} // END: Symbols::Clear()
+
+
+const Symbols::SYMBOL* Symbols::Find(Word address) const
+{
+    // upper_bound lands past every entry at this address; the one before
+    // it is the last defined there (VIDEO_START rather than SSTACK_TOP)
+    auto it = std::upper_bound(_by_address.begin(), _by_address.end(), address,
+        [](Word a, const SYMBOL& s) { return a < s.address; });
+    if (it == _by_address.begin()) { return nullptr; }
+    return &*(--it);
+} // END: Symbols::Find()
+
+
+std::string Symbols::Name(Word address) const
+{
+    const SYMBOL* sym = Find(address);
+    if (!sym) { return ""; }
+    Word ofs = address - sym->address;
+    if (ofs == 0) { return sym->name; }
+    return sym->name + "+$" + clr::hex(ofs, ofs > 0xFF ? 4 : 2);
+} // END: Symbols::Name()
+
+
+bool Symbols::Value(const std::string& name, Word& value) const
+{
+    auto it = _by_name.find(name);
+    if (it == _by_name.end()) { return false; }
+    value = it->second.address;
+    return true;
+} // END: Symbols::Value()
+
+
+bool Symbols::Parse(const std::string& text, Word& value) const
+{
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) { return false; }
+    std::string s = text.substr(first, text.find_last_not_of(" \t") - first + 1);
+    if (!is_name_start(s[0])) { return parse_number(s, value); }
+
+    size_t end = 0;
+    while (end < s.size() && (is_name_start(s[end]) || std::isdigit((unsigned char)s[end]))) { end++; }
+    Word base, ofs = 0;
+    if (!Value(s.substr(0, end), base)) { return false; }
+    size_t pos = s.find_first_not_of(" \t", end);
+    if (pos != std::string::npos)
+    {
+        size_t num = s.find_first_not_of(" \t", pos + 1);
+        if (s[pos] != '+' || num == std::string::npos || !parse_number(s.substr(num), ofs)) { return false; }
+    }
+    value = base + ofs;
+    return true;
+} // END: Symbols::Parse()
+
+
+void Symbols::_add(const std::string& name, Word value, KIND kind)
+{
+    auto it = _by_name.find(name);
+    if (it != _by_name.end())
+    {
+        auto old = std::find_if(_by_address.begin(), _by_address.end(),
+            [&name](const SYMBOL& s) { return s.name == name; });
+        if (old != _by_address.end()) { _by_address.erase(old); }
+    }
+    SYMBOL sym{ value, kind, name };
+    _by_name[name] = sym;
+    if (kind != SYM_CONST) { _by_address.push_back(sym); }
+} // END: Symbols::_add()
+
+
+void Symbols::_sort()
+{
+    // stable, so entries sharing an address keep their definition order
+    std::stable_sort(_by_address.begin(), _by_address.end(),
+        [](const SYMBOL& a, const SYMBOL& b) { return a.address < b.address; });
+} // END: Symbols::_sort()
+
+
+// END: Symbols.cpp